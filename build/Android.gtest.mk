@@ -41,6 +41,8 @@ TEST_COMMON_SRC_FILES := \
 	runtime/dex_method_iterator_test.cc \
 	runtime/entrypoints/math_entrypoints_test.cc \
 	runtime/exception_test.cc \
+	runtime/gc/accounting/card_bitmap_test.cc \
+	runtime/gc/accounting/card_table_test.cc \
 	runtime/gc/accounting/space_bitmap_test.cc \
 	runtime/gc/heap_test.cc \
 	runtime/gc/space/space_test.cc \
@@ -48,10 +50,12 @@ TEST_COMMON_SRC_FILES := \
 	runtime/indenter_test.cc \
 	runtime/indirect_reference_table_test.cc \
 	runtime/intern_table_test.cc \
+	runtime/interpreter/inline_cache_test.cc \
 	runtime/jni_internal_test.cc \
 	runtime/mem_map_test.cc \
 	runtime/mirror/dex_cache_test.cc \
 	runtime/mirror/object_test.cc \
+	runtime/open_addressing_table_test.cc \
 	runtime/reference_table_test.cc \
 	runtime/runtime_test.cc \
 	runtime/thread_pool_test.cc \
@@ -83,6 +83,12 @@ static uint32_t kCompilerOptimizerDisableFlags = 0 |  // Disable specific optimi
   // (1 << kBBOpt) |
   // (1 << kMatch) |
   // (1 << kPromoteCompilerTemps) |
+  // (1 << kRangeCheckElimination) |
+  // (1 << kGlobalValueNumbering) |
+  // (1 << kLoopInvariantCodeMotion) |
+  // (1 << kLinearScanRegAlloc) |
+  // (1 << kInlineCalls) |
+  // (1 << kSuspendCheckElimination) |
   0;
 
 static uint32_t kCompilerDebugFlags = 0 |     // Enable debug/testing modes
@@ -153,6 +159,8 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
   if (compiler_backend == kPortable) {
     // Fused long branches not currently usseful in bitcode.
     cu.disable_opt |= (1 << kBranchFusing);
+    // Bitcode conversion doesn't handle the null checks left by inlining.
+    cu.disable_opt |= (1 << kInlineCalls);
   }
 
   if (cu.instruction_set == kMips) {
@@ -187,6 +195,9 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
   }
 #endif
 
+  /* Replace calls of trivial methods by their bodies */
+  cu.mir_graph->InlineCalls();
+
   /* Do a code layout pass */
   cu.mir_graph->CodeLayout();
 
@@ -202,6 +213,18 @@ static CompiledMethod* CompileMethod(CompilerDriver& compiler,
   /* Perform null check elimination */
   cu.mir_graph->NullCheckElimination();
 
+  /* Eliminate checks made redundant in dominating blocks */
+  cu.mir_graph->GlobalValueNumbering();
+
+  /* Move loop invariant computations to loop preheaders */
+  cu.mir_graph->LoopInvariantCodeMotion();
+
+  /* Remove range checks made redundant by counted loop tests */
+  cu.mir_graph->LoopRangeCheckElimination();
+
+  /* Drop suspend checks of loops known to finish quickly */
+  cu.mir_graph->SuspendCheckElimination();
+
   /* Combine basic blocks where possible */
   cu.mir_graph->BasicBlockCombine();
 
@@ -56,6 +56,12 @@ enum opt_control_vector {
   kMatch,
   kPromoteCompilerTemps,
   kBranchFusing,
+  kRangeCheckElimination,
+  kGlobalValueNumbering,
+  kLoopInvariantCodeMotion,
+  kLinearScanRegAlloc,
+  kInlineCalls,
+  kSuspendCheckElimination,
 };
 
 // Force code generation paths for testing.
@@ -18,6 +18,10 @@
 
 namespace art {
 
+bool LocalValueNumbering::MayInitializeClass(uint32_t field_idx) const {
+  const DexFile::ClassDef& class_def = cu_->dex_file->GetClassDef(cu_->class_def_idx);
+  return cu_->dex_file->GetFieldId(field_idx).class_idx_ != class_def.class_idx_;
+}
 
 uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
   uint16_t res = NO_VALUE;
@@ -28,14 +32,11 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::RETURN:
     case Instruction::RETURN_OBJECT:
     case Instruction::RETURN_WIDE:
-    case Instruction::MONITOR_ENTER:
-    case Instruction::MONITOR_EXIT:
     case Instruction::GOTO:
     case Instruction::GOTO_16:
     case Instruction::GOTO_32:
     case Instruction::CHECK_CAST:
     case Instruction::THROW:
-    case Instruction::FILL_ARRAY_DATA:
     case Instruction::FILLED_NEW_ARRAY:
     case Instruction::FILLED_NEW_ARRAY_RANGE:
     case Instruction::PACKED_SWITCH:
@@ -52,6 +53,14 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::IF_GEZ:
     case Instruction::IF_GTZ:
     case Instruction::IF_LEZ:
+    case kMirOpFusedCmplFloat:
+    case kMirOpFusedCmpgFloat:
+    case kMirOpFusedCmplDouble:
+    case kMirOpFusedCmpgDouble:
+    case kMirOpFusedCmpLong:
+      // Nothing defined - take no action.
+      break;
+
     case Instruction::INVOKE_STATIC_RANGE:
     case Instruction::INVOKE_STATIC:
     case Instruction::INVOKE_DIRECT:
@@ -62,19 +71,20 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::INVOKE_SUPER_RANGE:
     case Instruction::INVOKE_INTERFACE:
     case Instruction::INVOKE_INTERFACE_RANGE:
-    case kMirOpFusedCmplFloat:
-    case kMirOpFusedCmpgFloat:
-    case kMirOpFusedCmplDouble:
-    case kMirOpFusedCmpgDouble:
-    case kMirOpFusedCmpLong:
-      // Nothing defined - take no action.
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
+      // Nothing defined, but the callee or another thread may have stored anywhere.
+      ClobberMemory();
+      break;
+
+    case Instruction::FILL_ARRAY_DATA:
+      AdvanceMemoryVersion(kArrayMemory, 0);
       break;
 
     case Instruction::MOVE_EXCEPTION:
     case Instruction::MOVE_RESULT:
     case Instruction::MOVE_RESULT_OBJECT:
     case Instruction::INSTANCE_OF:
-    case Instruction::NEW_INSTANCE:
     case Instruction::CONST_STRING:
     case Instruction::CONST_STRING_JUMBO:
     case Instruction::CONST_CLASS:
@@ -84,6 +94,13 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
         SetOperandValue(mir->ssa_rep->defs[0], res);
       }
       break;
+    case Instruction::NEW_INSTANCE: {
+        // Unique result, and the class initializer may have run.
+        ClobberMemory();
+        uint16_t res = GetOperandValue(mir->ssa_rep->defs[0]);
+        SetOperandValue(mir->ssa_rep->defs[0], res);
+      }
+      break;
     case Instruction::MOVE_RESULT_WIDE: {
         // 1 wide result, treat as unique each time, use result s_reg - will be unique.
         uint16_t res = GetOperandValueWide(mir->ssa_rep->defs[0]);
@@ -93,8 +110,8 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
 
     case kMirOpPhi:
       /*
-       * Because we'll only see phi nodes at the beginning of an extended basic block,
-       * we can ignore them.  Revisit if we shift to global value numbering.
+       * A phi merges different values along different paths, leave its result with the
+       * unique value of an s_reg seen for the first time.
        */
       break;
 
@@ -384,7 +401,7 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
         // Use side effect to note range check completed.
         (void)LookupValue(ARRAY_REF, array, index, NO_VALUE);
         // Establish value number for loaded register. Note use of memory version.
-        uint16_t memory_version = GetMemoryVersion(array, NO_VALUE);
+        uint16_t memory_version = GetMemoryVersion(kArrayMemory, 0);
         uint16_t res = LookupValue(ARRAY_REF, array, index, memory_version);
         if (opcode == Instruction::AGET_WIDE) {
           SetOperandValueWide(mir->ssa_rep->defs[0], res);
@@ -423,7 +440,7 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
         // Use side effect to note range check completed.
         (void)LookupValue(ARRAY_REF, array, index, NO_VALUE);
         // Rev the memory version
-        AdvanceMemoryVersion(array, NO_VALUE);
+        AdvanceMemoryVersion(kArrayMemory, 0);
       }
       break;
 
@@ -445,7 +462,20 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
         }
         mir->meta.throw_insn->optimization_flags |= mir->optimization_flags;
         uint16_t field_ref = mir->dalvikInsn.vC;
-        uint16_t memory_version = GetMemoryVersion(base, field_ref);
+        if (cu_->mir_graph->IsFieldVolatile(field_ref, false)) {
+          // Each load may see a different value, and later loads must not be older.
+          if (opcode == Instruction::IGET_WIDE) {
+            uint16_t res = GetOperandValueWide(mir->ssa_rep->defs[0]);
+            SetOperandValueWide(mir->ssa_rep->defs[0], res);
+          } else {
+            uint16_t res = GetOperandValue(mir->ssa_rep->defs[0]);
+            SetOperandValue(mir->ssa_rep->defs[0], res);
+          }
+          ClobberMemory();
+          break;
+        }
+        uint16_t memory_version =
+            GetMemoryVersion(kInstanceFieldMemory, cu_->dex_file->GetFieldId(field_ref).name_idx_);
         if (opcode == Instruction::IGET_WIDE) {
           uint16_t res = LookupValue(Instruction::IGET_WIDE, base, field_ref, memory_version);
           SetOperandValueWide(mir->ssa_rep->defs[0], res);
@@ -475,7 +505,7 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
         }
         mir->meta.throw_insn->optimization_flags |= mir->optimization_flags;
         uint16_t field_ref = mir->dalvikInsn.vC;
-        AdvanceMemoryVersion(base, field_ref);
+        AdvanceMemoryVersion(kInstanceFieldMemory, cu_->dex_file->GetFieldId(field_ref).name_idx_);
       }
       break;
 
@@ -487,7 +517,23 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::SGET_SHORT:
     case Instruction::SGET_WIDE: {
         uint16_t field_ref = mir->dalvikInsn.vB;
-        uint16_t memory_version = GetMemoryVersion(NO_VALUE, field_ref);
+        if (MayInitializeClass(field_ref)) {
+          ClobberMemory();
+        }
+        if (cu_->mir_graph->IsFieldVolatile(field_ref, true)) {
+          // Each load may see a different value, and later loads must not be older.
+          if (opcode == Instruction::SGET_WIDE) {
+            uint16_t res = GetOperandValueWide(mir->ssa_rep->defs[0]);
+            SetOperandValueWide(mir->ssa_rep->defs[0], res);
+          } else {
+            uint16_t res = GetOperandValue(mir->ssa_rep->defs[0]);
+            SetOperandValue(mir->ssa_rep->defs[0], res);
+          }
+          ClobberMemory();
+          break;
+        }
+        uint16_t memory_version =
+            GetMemoryVersion(kStaticFieldMemory, cu_->dex_file->GetFieldId(field_ref).name_idx_);
         if (opcode == Instruction::SGET_WIDE) {
           uint16_t res = LookupValue(Instruction::SGET_WIDE, NO_VALUE, field_ref, memory_version);
           SetOperandValueWide(mir->ssa_rep->defs[0], res);
@@ -506,7 +552,10 @@ uint16_t LocalValueNumbering::GetValueNumber(MIR* mir) {
     case Instruction::SPUT_SHORT:
     case Instruction::SPUT_WIDE: {
         uint16_t field_ref = mir->dalvikInsn.vB;
-        AdvanceMemoryVersion(NO_VALUE, field_ref);
+        if (MayInitializeClass(field_ref)) {
+          ClobberMemory();
+        }
+        AdvanceMemoryVersion(kStaticFieldMemory, cu_->dex_file->GetFieldId(field_ref).name_idx_);
       }
       break;
   }
@@ -28,12 +28,28 @@ namespace art {
 typedef SafeMap<uint16_t, uint16_t> SregValueMap;
 // Key is concatenation of quad, value is value name.
 typedef SafeMap<uint64_t, uint16_t> ValueMap;
-// Key represents a memory address, value is generation.
-typedef SafeMap<uint32_t, uint16_t> MemoryVersionMap;
+// Key represents a memory location, value is generation.
+typedef SafeMap<uint64_t, uint16_t> MemoryVersionMap;
 
 class LocalValueNumbering {
  public:
-  explicit LocalValueNumbering(CompilationUnit* cu) : cu_(cu) {}
+  explicit LocalValueNumbering(CompilationUnit* cu)
+      : cu_(cu), last_memory_version_(0), clobber_version_(0) {}
+
+  /*
+   * Memory locations are tracked by kind and id: instance and static fields by field name, as
+   * different field ids and differently numbered base references may name the same memory, and
+   * all array elements as one location.
+   */
+  enum MemoryKind {
+    kInstanceFieldMemory,
+    kStaticFieldMemory,
+    kArrayMemory,
+  };
+
+  static uint64_t BuildMemoryKey(MemoryKind kind, uint32_t id) {
+    return (static_cast<uint64_t>(kind) << 32 | static_cast<uint64_t>(id));
+  };
 
   static uint64_t BuildKey(uint16_t op, uint16_t operand1, uint16_t operand2, uint16_t modifier) {
     return (static_cast<uint64_t>(op) << 48 | static_cast<uint64_t>(operand1) << 32 |
@@ -59,27 +75,27 @@ class LocalValueNumbering {
     return (it != value_map_.end());
   };
 
-  uint16_t GetMemoryVersion(uint16_t base, uint16_t field) {
-    uint32_t key = (base << 16) | field;
-    uint16_t res;
+  uint16_t GetMemoryVersion(MemoryKind kind, uint32_t id) {
+    uint64_t key = BuildMemoryKey(kind, id);
     MemoryVersionMap::iterator it = memory_version_map_.find(key);
-    if (it == memory_version_map_.end()) {
-      res = 0;
-      memory_version_map_.Put(key, res);
-    } else {
-      res = it->second;
+    if ((it == memory_version_map_.end()) || (it->second < clobber_version_)) {
+      return clobber_version_;
     }
-    return res;
+    return it->second;
   };
 
-  void AdvanceMemoryVersion(uint16_t base, uint16_t field) {
-    uint32_t key = (base << 16) | field;
-    MemoryVersionMap::iterator it = memory_version_map_.find(key);
-    if (it == memory_version_map_.end()) {
-      memory_version_map_.Put(key, 0);
-    } else {
-      it->second++;
-    }
+  void AdvanceMemoryVersion(MemoryKind kind, uint32_t id) {
+    memory_version_map_.Overwrite(BuildMemoryKey(kind, id), ++last_memory_version_);
+  };
+
+  // Forget what is known about memory, after code that may have stored anywhere.
+  void ClobberMemory() {
+    clobber_version_ = ++last_memory_version_;
+  };
+
+  // Have so many values or memory versions been created that new ones may not be unique?
+  bool IsFull() const {
+    return (value_map_.size() >= kMaxValues) || (last_memory_version_ >= kMaxValues);
   };
 
   void SetOperandValue(uint16_t s_reg, uint16_t value) {
@@ -129,11 +145,19 @@ class LocalValueNumbering {
   uint16_t GetValueNumber(MIR* mir);
 
  private:
+  // Leave room below ARRAY_REF and NO_VALUE, which are not value names.
+  static const size_t kMaxValues = 0xf000;
+
+  // Could the load or store of the field run a class initializer?
+  bool MayInitializeClass(uint32_t field_idx) const;
+
   CompilationUnit* const cu_;
   SregValueMap sreg_value_map_;
   SregValueMap sreg_wide_value_map_;
   ValueMap value_map_;
   MemoryVersionMap memory_version_map_;
+  uint16_t last_memory_version_;
+  uint16_t clobber_version_;  // No memory location is older than this.
   std::set<uint16_t> null_checked_;
 };
 
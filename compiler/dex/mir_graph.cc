@@ -81,6 +81,7 @@ MIRGraph::MIRGraph(CompilationUnit* cu, ArenaAllocator* arena)
       ssa_last_defs_(NULL),
       is_constant_v_(NULL),
       constant_values_(NULL),
+      ssa_defs_(NULL),
       use_counts_(arena, 256, kGrowableArrayMisc),
       raw_use_counts_(arena, 256, kGrowableArrayMisc),
       num_reachable_blocks_(0),
@@ -877,6 +878,23 @@ void MIRGraph::InsertMIRAfter(BasicBlock* bb, MIR* current_mir, MIR* new_mir) {
   }
 }
 
+/* Unlink a MIR instruction from its basic block */
+void MIRGraph::RemoveMIR(BasicBlock* bb, MIR* mir) {
+  if (mir->prev) {
+    mir->prev->next = mir->next;
+  } else {
+    DCHECK_EQ(bb->first_mir_insn, mir);
+    bb->first_mir_insn = mir->next;
+  }
+  if (mir->next) {
+    mir->next->prev = mir->prev;
+  } else {
+    DCHECK_EQ(bb->last_mir_insn, mir);
+    bb->last_mir_insn = mir->prev;
+  }
+  mir->prev = mir->next = NULL;
+}
+
 char* MIRGraph::GetDalvikDisassembly(const MIR* mir) {
   DecodedInstruction insn = mir->dalvikInsn;
   std::string str;
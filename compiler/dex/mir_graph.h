@@ -291,6 +291,13 @@ struct SuccessorBlockInfo {
   int key;
 };
 
+// Where an SSA name is defined. Names without a defining MIR, such as incoming arguments, have a
+// NULL mir.
+struct SSADefinition {
+  MIR* mir;
+  BasicBlock* bb;
+};
+
 /*
  * Whereas a SSA name describes a definition of a Dalvik vreg, the RegLocation describes
  * the type of an SSA name (and, can also be used by code generators to record where the
@@ -436,6 +443,10 @@ class MIRGraph {
     return m_units_[current_method_];
   }
 
+  DexCompilationUnit* GetDexCompilationUnit(int m_unit_index) const {
+    return m_units_[m_unit_index];
+  }
+
   void DumpCFG(const char* dir_prefix, bool all_blocks);
 
   void BuildRegLocations();
@@ -571,6 +582,7 @@ class MIRGraph {
 
   void BasicBlockCombine();
   void CodeLayout();
+  void InlineCalls();
   void DumpCheckStats();
   void PropagateConstants();
   MIR* FindMoveResult(BasicBlock* bb, MIR* mir);
@@ -580,6 +592,10 @@ class MIRGraph {
   void SSATransformation();
   void CheckForDominanceFrontier(BasicBlock* dom_bb, const BasicBlock* succ_bb);
   void NullCheckElimination();
+  void GlobalValueNumbering();
+  void LoopInvariantCodeMotion();
+  void LoopRangeCheckElimination();
+  void SuspendCheckElimination();
   bool SetFp(int index, bool is_fp);
   bool SetCore(int index, bool is_core);
   bool SetRef(int index, bool is_ref);
@@ -588,8 +604,15 @@ class MIRGraph {
   void AppendMIR(BasicBlock* bb, MIR* mir);
   void PrependMIR(BasicBlock* bb, MIR* mir);
   void InsertMIRAfter(BasicBlock* bb, MIR* current_mir, MIR* new_mir);
+  void RemoveMIR(BasicBlock* bb, MIR* mir);
   char* GetDalvikDisassembly(const MIR* mir);
   void ReplaceSpecialChars(std::string& str);
+
+  /*
+   * May the field be volatile?  Unresolved fields are assumed to be.  Results are cached for
+   * the method being compiled.
+   */
+  bool IsFieldVolatile(uint32_t field_idx, bool is_static);
   std::string GetSSAName(int ssa_reg);
   std::string GetSSANameWithConst(int ssa_reg, bool singles_only);
   void GetBlockName(BasicBlock* bb, char* name);
@@ -662,6 +685,19 @@ class MIRGraph {
   bool BasicBlockOpt(BasicBlock* bb);
   bool EliminateNullChecks(BasicBlock* bb);
   void NullCheckEliminationInit(BasicBlock* bb);
+  void FindSSADefinitions();
+  bool IsLoopHeader(BasicBlock* bb);
+  ArenaBitVector* FindLoopBlocks(BasicBlock* header);
+  int64_t LoopIterationBound(BasicBlock* header, ArenaBitVector* loop_blocks);
+  bool OwnsDexPcRange(ArenaBitVector* loop_blocks);
+  bool IsNonNegativeInductionVariable(int s_reg, BasicBlock* in_bounds_bb);
+  bool EliminateLoopRangeChecks(BasicBlock* bb);
+  bool CanHoistLoad(MIR* mir, BasicBlock* preheader);
+  bool CanHoistOutOfLoop(MIR* mir, BasicBlock* header, BasicBlock* preheader,
+                         const std::vector<int>& loop_def_counts, bool loop_writes_fields);
+  bool HoistLoopInvariants(BasicBlock* header);
+  void AddCalleeUnit(MIR* mir, DexCompilationUnit* callee_unit);
+  bool InlineInvoke(BasicBlock* bb, MIR* mir);
   bool BuildExtendedBBList(struct BasicBlock* bb);
   bool FillDefBlockMatrix(BasicBlock* bb);
   void InitializeDominationInfo(BasicBlock* bb);
@@ -685,6 +721,8 @@ class MIRGraph {
   int* ssa_last_defs_;              // length == method->registers_size
   ArenaBitVector* is_constant_v_;   // length == num_ssa_reg
   int* constant_values_;            // length == num_ssa_reg
+  SSADefinition* ssa_defs_;         // length == num_ssa_reg
+  SafeMap<uint32_t, bool> field_volatility_;  // Keyed by field_idx << 1 | is_static.
   // Use counts of ssa names.
   GrowableArray<uint32_t> use_counts_;      // Weighted by nesting depth
   GrowableArray<uint32_t> raw_use_counts_;  // Not weighted
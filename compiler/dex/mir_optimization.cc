@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "base/stl_util.h"
 #include "compiler_internals.h"
 #include "local_value_numbering.h"
 #include "dataflow_iterator-inl.h"
@@ -777,6 +778,844 @@ void MIRGraph::NullCheckElimination() {
   }
 }
 
+void MIRGraph::FindSSADefinitions() {
+  ssa_defs_ = static_cast<SSADefinition*>(arena_->Alloc(sizeof(SSADefinition) * GetNumSSARegs(),
+                                                        ArenaAllocator::kAllocDFInfo));
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        ssa_defs_[mir->ssa_rep->defs[i]].mir = mir;
+        ssa_defs_[mir->ssa_rep->defs[i]].bb = bb;
+      }
+    }
+  }
+}
+
+static bool Dominates(BasicBlock* dom_bb, BasicBlock* bb) {
+  return (bb->dominators != NULL) && bb->dominators->IsBitSet(dom_bb->id);
+}
+
+/* A loop header is the target of a back edge, i.e. it dominates one of its predecessors */
+bool MIRGraph::IsLoopHeader(BasicBlock* bb) {
+  GrowableArray<BasicBlock*>::Iterator iter(bb->predecessors);
+  for (BasicBlock* pred_bb = iter.Next(); pred_bb != NULL; pred_bb = iter.Next()) {
+    if (Dominates(bb, pred_bb)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Find the loop body by walking backwards from the back edges to the header */
+ArenaBitVector* MIRGraph::FindLoopBlocks(BasicBlock* header) {
+  ArenaBitVector* loop_blocks =
+      new (arena_) ArenaBitVector(arena_, GetNumBlocks(), false, kBitMapTmpBlocks);
+  std::vector<BasicBlock*> work_list;
+  loop_blocks->SetBit(header->id);
+  GrowableArray<BasicBlock*>::Iterator pred_iter(header->predecessors);
+  for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+    if (Dominates(header, pred_bb) && !loop_blocks->IsBitSet(pred_bb->id)) {
+      loop_blocks->SetBit(pred_bb->id);
+      work_list.push_back(pred_bb);
+    }
+  }
+  while (!work_list.empty()) {
+    BasicBlock* bb = work_list.back();
+    work_list.pop_back();
+    GrowableArray<BasicBlock*>::Iterator iter(bb->predecessors);
+    for (BasicBlock* pred_bb = iter.Next(); pred_bb != NULL; pred_bb = iter.Next()) {
+      if (!loop_blocks->IsBitSet(pred_bb->id)) {
+        loop_blocks->SetBit(pred_bb->id);
+        work_list.push_back(pred_bb);
+      }
+    }
+  }
+  return loop_blocks;
+}
+
+/*
+ * Is s_reg a Phi of a loop header merging only non-negative constants and increments of itself
+ * by one made after reaching in_bounds_bb?  As the value incremented was below an array length,
+ * the increment can't overflow and s_reg is never negative.
+ */
+bool MIRGraph::IsNonNegativeInductionVariable(int s_reg, BasicBlock* in_bounds_bb) {
+  MIR* phi = ssa_defs_[s_reg].mir;
+  if ((phi == NULL) || (static_cast<int>(phi->dalvikInsn.opcode) != kMirOpPhi) ||
+      !IsLoopHeader(ssa_defs_[s_reg].bb)) {
+    return false;
+  }
+  for (int i = 0; i < phi->ssa_rep->num_uses; i++) {
+    int input = phi->ssa_rep->uses[i];
+    if (IsConst(input)) {
+      if (ConstantValue(input) < 0) {
+        return false;
+      }
+      continue;
+    }
+    MIR* inc = ssa_defs_[input].mir;
+    if ((inc == NULL) ||
+        ((inc->dalvikInsn.opcode != Instruction::ADD_INT_LIT8) &&
+         (inc->dalvikInsn.opcode != Instruction::ADD_INT_LIT16)) ||
+        (inc->ssa_rep->uses[0] != s_reg) || (static_cast<int32_t>(inc->dalvikInsn.vC) != 1) ||
+        !Dominates(in_bounds_bb, ssa_defs_[input].bb)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * If bb ends with a loop test of the form "index < array.length", with index a counted induction
+ * variable, drop the range checks of array[index] in the blocks reached only through the in
+ * bounds edge.  SSA names can't change value without their definitions being reached again, and
+ * getting from these to the checks passes the test again, so the array doesn't need to be loop
+ * invariant: the checks use the very same array and index values that were tested.
+ */
+bool MIRGraph::EliminateLoopRangeChecks(BasicBlock* bb) {
+  MIR* branch = bb->last_mir_insn;
+  if ((branch == NULL) || (branch->ssa_rep == NULL) || (bb->taken == bb->fall_through)) {
+    return false;
+  }
+  int index_sreg;
+  int length_sreg;
+  BasicBlock* in_bounds_bb;
+  switch (branch->dalvikInsn.opcode) {
+    case Instruction::IF_GE:
+      index_sreg = branch->ssa_rep->uses[0];
+      length_sreg = branch->ssa_rep->uses[1];
+      in_bounds_bb = bb->fall_through;
+      break;
+    case Instruction::IF_LT:
+      index_sreg = branch->ssa_rep->uses[0];
+      length_sreg = branch->ssa_rep->uses[1];
+      in_bounds_bb = bb->taken;
+      break;
+    case Instruction::IF_LE:
+      index_sreg = branch->ssa_rep->uses[1];
+      length_sreg = branch->ssa_rep->uses[0];
+      in_bounds_bb = bb->fall_through;
+      break;
+    case Instruction::IF_GT:
+      index_sreg = branch->ssa_rep->uses[1];
+      length_sreg = branch->ssa_rep->uses[0];
+      in_bounds_bb = bb->taken;
+      break;
+    default:
+      return false;
+  }
+  // Blocks dominated by in_bounds_bb must only be reachable through the in bounds edge.
+  if ((in_bounds_bb == NULL) || (in_bounds_bb->block_type != kDalvikByteCode) ||
+      (Predecessors(in_bounds_bb) != 1)) {
+    return false;
+  }
+  MIR* length_mir = ssa_defs_[length_sreg].mir;
+  if ((length_mir == NULL) || (length_mir->dalvikInsn.opcode != Instruction::ARRAY_LENGTH) ||
+      !IsNonNegativeInductionVariable(index_sreg, in_bounds_bb)) {
+    return false;
+  }
+  int array_sreg = length_mir->ssa_rep->uses[0];
+  GrowableArray<BasicBlock*>::Iterator iter(&block_list_);
+  for (BasicBlock* check_bb = iter.Next(); check_bb != NULL; check_bb = iter.Next()) {
+    if ((check_bb->block_type == kDead) || !Dominates(in_bounds_bb, check_bb)) {
+      continue;
+    }
+    for (MIR* mir = check_bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      int df_attributes = oat_data_flow_attributes_[mir->dalvikInsn.opcode];
+      if (!(df_attributes & DF_HAS_RANGE_CHKS)) {
+        continue;
+      }
+      // The array reference is the use just before the index.
+      int index_idx;
+      if (df_attributes & DF_RANGE_CHK_1) {
+        index_idx = 1;
+      } else if (df_attributes & DF_RANGE_CHK_2) {
+        index_idx = 2;
+      } else {
+        index_idx = 3;
+      }
+      if ((mir->ssa_rep->uses[index_idx] == index_sreg) &&
+          (mir->ssa_rep->uses[index_idx - 1] == array_sreg)) {
+        mir->optimization_flags |= MIR_IGNORE_RANGE_CHECK;
+        if (cu_->verbose) {
+          LOG(INFO) << "Eliminated loop range check at 0x" << std::hex << mir->offset;
+        }
+      }
+    }
+  }
+  return false;  // Not iterative - return value will be ignored
+}
+
+void MIRGraph::LoopRangeCheckElimination() {
+  if (!(cu_->disable_opt & (1 << kRangeCheckElimination))) {
+    FindSSADefinitions();
+    AllNodesIterator iter(this, false /* not iterative */);
+    for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+      if ((bb->block_type == kDalvikByteCode) && (bb->data_flow_info != NULL)) {
+        EliminateLoopRangeChecks(bb);
+      }
+    }
+  }
+}
+
+bool MIRGraph::IsFieldVolatile(uint32_t field_idx, bool is_static) {
+  uint32_t key = (field_idx << 1) | (is_static ? 1 : 0);
+  SafeMap<uint32_t, bool>::iterator it = field_volatility_.find(key);
+  if (it != field_volatility_.end()) {
+    return it->second;
+  }
+  int field_offset;
+  bool is_volatile;
+  bool fast_path;
+  if (is_static) {
+    int ssb_index;
+    bool is_referrers_class;
+    fast_path = cu_->compiler_driver->ComputeStaticFieldInfo(
+        field_idx, GetCurrentDexCompilationUnit(), field_offset, ssb_index,
+        is_referrers_class, is_volatile, false);
+  } else {
+    fast_path = cu_->compiler_driver->ComputeInstanceFieldInfo(
+        field_idx, GetCurrentDexCompilationUnit(), field_offset, is_volatile, false);
+  }
+  bool res = !fast_path || is_volatile;
+  field_volatility_.Put(key, res);
+  return res;
+}
+
+// Numbering copies the tables of a block for each block it dominates, cap the cost.
+static const int kMaxGlobalValueNumberingBlocks = 1000;
+
+static bool NumberBlockValues(BasicBlock* bb, LocalValueNumbering* lvn) {
+  for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+    if (lvn->IsFull()) {
+      return false;
+    }
+    lvn->GetValueNumber(mir);
+  }
+  return true;
+}
+
+/*
+ * Number values over the dominator tree rather than extended basic blocks: a block starts with
+ * what is known at the end of its immediate dominator, which always runs to its end before the
+ * block is entered.  Memory is forgotten where other paths join in, and catch blocks start
+ * afresh.  For now only null and range check elimination make use of the value numbers.
+ */
+void MIRGraph::GlobalValueNumbering() {
+  if ((cu_->disable_opt & (1 << kGlobalValueNumbering)) ||
+      (GetNumBlocks() > kMaxGlobalValueNumberingBlocks)) {
+    return;
+  }
+  std::vector<std::pair<BasicBlock*, ArenaBitVector::Iterator*> > work_stack;
+  std::vector<LocalValueNumbering*> lvn_stack;
+  BasicBlock* bb = GetEntryBlock();
+  LocalValueNumbering* lvn = new LocalValueNumbering(cu_);
+  while (bb != NULL) {
+    lvn_stack.push_back(lvn);
+    if (!NumberBlockValues(bb, lvn)) {
+      // Value names would no longer be unique, keep what was found so far.
+      break;
+    }
+    work_stack.push_back(
+        std::make_pair(bb, new (arena_) ArenaBitVector::Iterator(bb->i_dominated)));
+    // Move on to the next dominated block still to be numbered.
+    bb = NULL;
+    while ((bb == NULL) && !work_stack.empty()) {
+      int bb_idx = work_stack.back().second->Next();
+      if (bb_idx == -1) {
+        work_stack.pop_back();
+        delete lvn_stack.back();
+        lvn_stack.pop_back();
+      } else {
+        bb = GetBasicBlock(bb_idx);
+      }
+    }
+    if (bb == NULL) {
+      break;
+    }
+    if (bb->catch_entry) {
+      lvn = new LocalValueNumbering(cu_);
+    } else {
+      lvn = new LocalValueNumbering(*lvn_stack.back());
+      if (Predecessors(bb) > 1) {
+        lvn->ClobberMemory();
+      }
+    }
+  }
+  STLDeleteElements(&lvn_stack);
+}
+
+/* Can the opcode neither throw nor read memory? */
+static bool IsPureOperation(int opcode) {
+  switch (opcode) {
+    case Instruction::NEG_INT:
+    case Instruction::NOT_INT:
+    case Instruction::NEG_LONG:
+    case Instruction::NOT_LONG:
+    case Instruction::NEG_FLOAT:
+    case Instruction::NEG_DOUBLE:
+    case Instruction::INT_TO_LONG:
+    case Instruction::INT_TO_FLOAT:
+    case Instruction::INT_TO_DOUBLE:
+    case Instruction::LONG_TO_INT:
+    case Instruction::LONG_TO_FLOAT:
+    case Instruction::LONG_TO_DOUBLE:
+    case Instruction::FLOAT_TO_INT:
+    case Instruction::FLOAT_TO_LONG:
+    case Instruction::FLOAT_TO_DOUBLE:
+    case Instruction::DOUBLE_TO_INT:
+    case Instruction::DOUBLE_TO_LONG:
+    case Instruction::DOUBLE_TO_FLOAT:
+    case Instruction::INT_TO_BYTE:
+    case Instruction::INT_TO_CHAR:
+    case Instruction::INT_TO_SHORT:
+    case Instruction::ADD_INT:
+    case Instruction::SUB_INT:
+    case Instruction::MUL_INT:
+    case Instruction::AND_INT:
+    case Instruction::OR_INT:
+    case Instruction::XOR_INT:
+    case Instruction::SHL_INT:
+    case Instruction::SHR_INT:
+    case Instruction::USHR_INT:
+    case Instruction::ADD_LONG:
+    case Instruction::SUB_LONG:
+    case Instruction::MUL_LONG:
+    case Instruction::AND_LONG:
+    case Instruction::OR_LONG:
+    case Instruction::XOR_LONG:
+    case Instruction::SHL_LONG:
+    case Instruction::SHR_LONG:
+    case Instruction::USHR_LONG:
+    case Instruction::ADD_FLOAT:
+    case Instruction::SUB_FLOAT:
+    case Instruction::MUL_FLOAT:
+    case Instruction::DIV_FLOAT:
+    case Instruction::ADD_DOUBLE:
+    case Instruction::SUB_DOUBLE:
+    case Instruction::MUL_DOUBLE:
+    case Instruction::DIV_DOUBLE:
+    case Instruction::ADD_INT_LIT16:
+    case Instruction::RSUB_INT:
+    case Instruction::MUL_INT_LIT16:
+    case Instruction::AND_INT_LIT16:
+    case Instruction::OR_INT_LIT16:
+    case Instruction::XOR_INT_LIT16:
+    case Instruction::ADD_INT_LIT8:
+    case Instruction::RSUB_INT_LIT8:
+    case Instruction::MUL_INT_LIT8:
+    case Instruction::AND_INT_LIT8:
+    case Instruction::OR_INT_LIT8:
+    case Instruction::XOR_INT_LIT8:
+    case Instruction::SHL_INT_LIT8:
+    case Instruction::SHR_INT_LIT8:
+    case Instruction::USHR_INT_LIT8:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Can the mir write a field, or run code that might, such as a class initializer? */
+static bool MayWriteFields(MIR* mir) {
+  int opcode = mir->dalvikInsn.opcode;
+  if (opcode >= kMirOpFirst) {
+    return false;
+  }
+  if (Instruction::FlagsOf(mir->dalvikInsn.opcode) & Instruction::kInvoke) {
+    return true;
+  }
+  switch (opcode) {
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
+    case Instruction::NEW_INSTANCE:
+      return true;
+    default:
+      return ((opcode >= Instruction::IPUT) && (opcode <= Instruction::IPUT_SHORT)) ||
+          ((opcode >= Instruction::SGET) && (opcode <= Instruction::SPUT_SHORT));
+  }
+}
+
+/*
+ * Can the work half of a split instance field load be moved out of a loop writing no fields?
+ * Only loads of primitive fields qualify, a reference would be missing from the GC maps of the
+ * safepoints before its original dex pc, and only from objects known non-null on leaving the
+ * preheader, so the load can't throw there.
+ */
+bool MIRGraph::CanHoistLoad(MIR* mir, BasicBlock* preheader) {
+  Instruction::Code opcode = mir->dalvikInsn.opcode;
+  if ((opcode < Instruction::IGET) || (opcode > Instruction::IGET_SHORT) ||
+      (opcode == Instruction::IGET_OBJECT)) {
+    return false;
+  }
+  MIR* check_half = mir->meta.throw_insn;
+  if ((check_half == NULL) ||
+      (static_cast<int>(check_half->dalvikInsn.opcode) != kMirOpCheck)) {
+    return false;
+  }
+  ArenaBitVector* non_null = preheader->data_flow_info->ending_null_check_v;
+  return (non_null != NULL) && non_null->IsBitSet(mir->ssa_rep->uses[0]) &&
+      !IsFieldVolatile(mir->dalvikInsn.vC, false);
+}
+
+/*
+ * Code is vreg based, so an invariant mir may only be moved to the end of the preheader if its
+ * operands already hold the same SSA names there, and if nothing else in the loop writes its
+ * result vregs or reads them before it is reached.  It then computes the same value once.
+ */
+bool MIRGraph::CanHoistOutOfLoop(MIR* mir, BasicBlock* header, BasicBlock* preheader,
+                                 const std::vector<int>& loop_def_counts,
+                                 bool loop_writes_fields) {
+  if ((mir->ssa_rep == NULL) || (mir->optimization_flags & MIR_INLINED)) {
+    return false;
+  }
+  if (!IsPureOperation(mir->dalvikInsn.opcode) &&
+      (loop_writes_fields || !CanHoistLoad(mir, preheader))) {
+    return false;
+  }
+  for (int i = 0; i < mir->ssa_rep->num_uses; i++) {
+    int s_reg = mir->ssa_rep->uses[i];
+    BasicBlock* def_bb = ssa_defs_[s_reg].bb;
+    if ((def_bb != NULL) && ((def_bb == header) || !Dominates(def_bb, header))) {
+      return false;
+    }
+    int v_reg = SRegToVReg(s_reg);
+    if ((v_reg < 0) || (preheader->data_flow_info->vreg_to_ssa_map[v_reg] != s_reg)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+    int v_reg = SRegToVReg(mir->ssa_rep->defs[i]);
+    if ((v_reg < 0) || (loop_def_counts[v_reg] != 1) ||
+        header->data_flow_info->live_in_v->IsBitSet(v_reg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Move the invariant computations and field loads of the loop headed by header to the end of its
+ * preheader, the single block entering the loop from outside.  Loops without one are left alone,
+ * creating a preheader would need dominators and phi operands to be recomputed.
+ */
+bool MIRGraph::HoistLoopInvariants(BasicBlock* header) {
+  if (header->catch_entry || !IsLoopHeader(header)) {
+    return false;
+  }
+  BasicBlock* preheader = NULL;
+  GrowableArray<BasicBlock*>::Iterator pred_iter(header->predecessors);
+  for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+    if (!Dominates(header, pred_bb)) {
+      if (preheader != NULL) {
+        return false;
+      }
+      preheader = pred_bb;
+    }
+  }
+  if ((preheader == NULL) || (preheader->block_type != kDalvikByteCode) ||
+      (preheader->data_flow_info == NULL) ||
+      (preheader->successor_block_list.block_list_type != kNotUsed)) {
+    return false;
+  }
+  // Hoisted mirs go before the goto to the header, or after the last mir falling through to it.
+  MIR* last_mir = preheader->last_mir_insn;
+  MIR* insert_after = last_mir;
+  if ((preheader->taken == header) && (preheader->fall_through == NULL)) {
+    if ((last_mir == NULL) || ((last_mir->dalvikInsn.opcode != Instruction::GOTO) &&
+                               (last_mir->dalvikInsn.opcode != Instruction::GOTO_16) &&
+                               (last_mir->dalvikInsn.opcode != Instruction::GOTO_32))) {
+      return false;
+    }
+    // A backward goto checks for suspension, and its GC map still gives the vregs of hoisted
+    // defs their old types, which may be references.
+    if (IsBackedge(preheader, header)) {
+      return false;
+    }
+    insert_after = last_mir->prev;
+  } else if ((preheader->taken != NULL) || (preheader->fall_through != header)) {
+    return false;
+  } else if ((last_mir != NULL) &&
+             ((static_cast<int>(last_mir->dalvikInsn.opcode) >= kMirOpFirst) ||
+              (Instruction::FlagsOf(last_mir->dalvikInsn.opcode) &
+               (Instruction::kBranch | Instruction::kSwitch | Instruction::kThrow |
+                Instruction::kReturn | Instruction::kInvoke)))) {
+    return false;
+  }
+
+  ArenaBitVector* loop_blocks = FindLoopBlocks(header);
+
+  // Count how often each vreg is written in the loop, phis included, and look for field writes.
+  std::vector<int> loop_def_counts(cu_->num_dalvik_registers, 0);
+  bool loop_writes_fields = false;
+  ArenaBitVector::Iterator bit_iter(loop_blocks);
+  for (int bb_idx = bit_iter.Next(); bb_idx != -1; bb_idx = bit_iter.Next()) {
+    for (MIR* mir = GetBasicBlock(bb_idx)->first_mir_insn; mir != NULL; mir = mir->next) {
+      loop_writes_fields |= MayWriteFields(mir);
+      if (mir->ssa_rep == NULL) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        int v_reg = SRegToVReg(mir->ssa_rep->defs[i]);
+        if (v_reg >= 0) {
+          loop_def_counts[v_reg]++;
+        }
+      }
+    }
+  }
+
+  // Visit blocks in dfs order so that computations depending on hoisted ones follow them out.
+  for (size_t i = 0; i < dfs_order_->Size(); i++) {
+    BasicBlock* bb = GetBasicBlock(dfs_order_->Get(i));
+    if (!loop_blocks->IsBitSet(bb->id)) {
+      continue;
+    }
+    MIR* next_mir;
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = next_mir) {
+      next_mir = mir->next;
+      if (!CanHoistOutOfLoop(mir, header, preheader, loop_def_counts, loop_writes_fields)) {
+        continue;
+      }
+      if (cu_->verbose) {
+        LOG(INFO) << "Hoisting loop invariant at 0x" << std::hex << mir->offset;
+      }
+      if (!IsPureOperation(mir->dalvikInsn.opcode)) {
+        // The load can't throw in the preheader, leave its check half behind as a nop.
+        MIR* check_half = mir->meta.throw_insn;
+        check_half->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+        check_half->meta.original_opcode = mir->dalvikInsn.opcode;
+        mir->meta.throw_insn = NULL;
+        mir->optimization_flags |= MIR_IGNORE_NULL_CHECK;
+      }
+      RemoveMIR(bb, mir);
+      if (insert_after == NULL) {
+        PrependMIR(preheader, mir);
+      } else {
+        InsertMIRAfter(preheader, insert_after, mir);
+      }
+      insert_after = mir;
+      for (int j = 0; j < mir->ssa_rep->num_defs; j++) {
+        int s_reg = mir->ssa_rep->defs[j];
+        ssa_defs_[s_reg].bb = preheader;
+        preheader->data_flow_info->vreg_to_ssa_map[SRegToVReg(s_reg)] = s_reg;
+      }
+    }
+  }
+  return false;  // Not iterative - return value will be ignored
+}
+
+/*
+ * Hoist loop invariants, inner loops first so that what leaves an inner loop may then leave
+ * the loops around it.
+ */
+void MIRGraph::LoopInvariantCodeMotion() {
+  if (!(cu_->disable_opt & (1 << kLoopInvariantCodeMotion))) {
+    FindSSADefinitions();
+    PostOrderDOMIterator iter(this, false /* not iterative */);
+    for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+      if ((bb->block_type == kDalvikByteCode) && (bb->data_flow_info != NULL)) {
+        HoistLoopInvariants(bb);
+      }
+    }
+  }
+}
+
+// Loops may run without suspend checks for this many iterations, those of nested loops included.
+static const int64_t kMaxUncheckedLoopIterations = 256;
+// Bounds and starting values of counted loops must stay this far from overflow.
+static const int64_t kMaxInductionMagnitude = 1 << 30;
+
+// Returns the condition under which a conditional branch is taken, kCondAl if not one.
+static ConditionCode BranchCondition(Instruction::Code opcode) {
+  switch (opcode) {
+    case Instruction::IF_EQ:
+    case Instruction::IF_EQZ:
+      return kCondEq;
+    case Instruction::IF_NE:
+    case Instruction::IF_NEZ:
+      return kCondNe;
+    case Instruction::IF_LT:
+    case Instruction::IF_LTZ:
+      return kCondLt;
+    case Instruction::IF_GE:
+    case Instruction::IF_GEZ:
+      return kCondGe;
+    case Instruction::IF_GT:
+    case Instruction::IF_GTZ:
+      return kCondGt;
+    case Instruction::IF_LE:
+    case Instruction::IF_LEZ:
+      return kCondLe;
+    default:
+      return kCondAl;
+  }
+}
+
+// Returns the condition holding when cond fails.
+static ConditionCode NegateCondition(ConditionCode cond) {
+  switch (cond) {
+    case kCondEq: return kCondNe;
+    case kCondNe: return kCondEq;
+    case kCondLt: return kCondGe;
+    case kCondGe: return kCondLt;
+    case kCondGt: return kCondLe;
+    case kCondLe: return kCondGt;
+    default: return kCondAl;
+  }
+}
+
+// Returns the condition of "b cond' a" equivalent to "a cond b".
+static ConditionCode SwapConditionOperands(ConditionCode cond) {
+  switch (cond) {
+    case kCondLt: return kCondGt;
+    case kCondGe: return kCondLe;
+    case kCondGt: return kCondLt;
+    case kCondLe: return kCondGe;
+    default: return cond;
+  }
+}
+
+static bool IsConstantIncrement(MIR* mir) {
+  return (mir != NULL) && ((mir->dalvikInsn.opcode == Instruction::ADD_INT_LIT8) ||
+                           (mir->dalvikInsn.opcode == Instruction::ADD_INT_LIT16));
+}
+
+/*
+ * Bound the iterations of the loop of header through an exit test run on every iteration, which
+ * compares a counted induction variable with a constant: a Phi of the header merging constants
+ * from outside the loop with increments of itself by a constant step inside it.  The test may
+ * also be of the Phi plus a constant, such as its increment.  Counting from the smallest
+ * (largest) start value bounds either.
+ * Returns -1 if no such test is found.
+ */
+int64_t MIRGraph::LoopIterationBound(BasicBlock* header, ArenaBitVector* loop_blocks) {
+  std::vector<BasicBlock*> latches;
+  GrowableArray<BasicBlock*>::Iterator pred_iter(header->predecessors);
+  for (BasicBlock* pred_bb = pred_iter.Next(); pred_bb != NULL; pred_bb = pred_iter.Next()) {
+    if (loop_blocks->IsBitSet(pred_bb->id)) {
+      latches.push_back(pred_bb);
+    }
+  }
+  int64_t bound = -1;
+  ArenaBitVector::Iterator bit_iter(loop_blocks);
+  for (int bb_idx = bit_iter.Next(); bb_idx != -1; bb_idx = bit_iter.Next()) {
+    BasicBlock* bb = GetBasicBlock(bb_idx);
+    MIR* branch = bb->last_mir_insn;
+    if ((branch == NULL) || (branch->ssa_rep == NULL) ||
+        (static_cast<int>(branch->dalvikInsn.opcode) >= kMirOpFirst)) {
+      continue;
+    }
+    ConditionCode cond = BranchCondition(branch->dalvikInsn.opcode);
+    if ((cond == kCondAl) || (bb->taken == NULL) || (bb->fall_through == NULL)) {
+      continue;
+    }
+    bool taken_stays = loop_blocks->IsBitSet(bb->taken->id);
+    if (taken_stays == loop_blocks->IsBitSet(bb->fall_through->id)) {
+      continue;
+    }
+    bool on_every_iteration = true;
+    for (size_t i = 0; i < latches.size(); i++) {
+      on_every_iteration &= Dominates(bb, latches[i]);
+    }
+    if (!on_every_iteration) {
+      continue;
+    }
+    int value_sreg = branch->ssa_rep->uses[0];
+    int64_t limit = 0;
+    if (Instruction::FormatOf(branch->dalvikInsn.opcode) == Instruction::k22t) {
+      if (IsConst(branch->ssa_rep->uses[1])) {
+        limit = ConstantValue(branch->ssa_rep->uses[1]);
+      } else if (IsConst(value_sreg)) {
+        limit = ConstantValue(value_sreg);
+        value_sreg = branch->ssa_rep->uses[1];
+        cond = SwapConditionOperands(cond);
+      } else {
+        continue;
+      }
+    }
+    // The condition under which the loop goes on.
+    if (!taken_stays) {
+      cond = NegateCondition(cond);
+    }
+    // Testing the Phi plus a constant is testing the Phi against the limit less that constant.
+    MIR* def = ssa_defs_[value_sreg].mir;
+    if (IsConstantIncrement(def)) {
+      value_sreg = def->ssa_rep->uses[0];
+      limit -= static_cast<int32_t>(def->dalvikInsn.vC);
+    }
+    MIR* phi = ssa_defs_[value_sreg].mir;
+    if ((phi == NULL) || (static_cast<int>(phi->dalvikInsn.opcode) != kMirOpPhi) ||
+        (ssa_defs_[value_sreg].bb != header)) {
+      continue;
+    }
+    int* incoming = reinterpret_cast<int*>(phi->dalvikInsn.vB);
+    int64_t step = 0;
+    int64_t min_start = kMaxInductionMagnitude + 1;
+    int64_t max_start = -kMaxInductionMagnitude - 1;
+    bool counted = true;
+    for (int i = 0; counted && (i < phi->ssa_rep->num_uses); i++) {
+      int input = phi->ssa_rep->uses[i];
+      if (loop_blocks->IsBitSet(incoming[i])) {
+        MIR* inc = ssa_defs_[input].mir;
+        counted = IsConstantIncrement(inc) && (inc->ssa_rep->uses[0] == value_sreg) &&
+            ((step == 0) || (step == static_cast<int32_t>(inc->dalvikInsn.vC)));
+        if (counted) {
+          step = static_cast<int32_t>(inc->dalvikInsn.vC);
+        }
+      } else {
+        counted = IsConst(input);
+        if (counted) {
+          int64_t start = ConstantValue(input);
+          min_start = (start < min_start) ? start : min_start;
+          max_start = (start > max_start) ? start : max_start;
+        }
+      }
+    }
+    if (!counted || (step == 0) || (min_start > max_start) ||
+        (min_start < -kMaxInductionMagnitude) || (max_start > kMaxInductionMagnitude)) {
+      continue;
+    }
+    // Count the values the test can pass from the start, plus the iteration ending in the exit.
+    int64_t distance;
+    if ((step > 0) && ((cond == kCondLt) || (cond == kCondLe))) {
+      limit += (cond == kCondLe) ? 1 : 0;
+      distance = limit - min_start;
+    } else if ((step < 0) && ((cond == kCondGt) || (cond == kCondGe))) {
+      limit -= (cond == kCondGe) ? 1 : 0;
+      distance = max_start - limit;
+      step = -step;
+    } else {
+      continue;
+    }
+    if ((limit < -kMaxInductionMagnitude) || (limit > kMaxInductionMagnitude)) {
+      continue;
+    }
+    int64_t iterations = ((distance > 0) ? (distance + step - 1) / step : 0) + 1;
+    if ((bound < 0) || (iterations < bound)) {
+      bound = iterations;
+    }
+  }
+  return bound;
+}
+
+/*
+ * Does the loop own the range of dex pcs its blocks start at?  Backward branches of a loop
+ * without a suspend check then can't take the place of those of the loops around it: going
+ * around an outer loop, with the inner one collapsed to a point, still needs a backward branch
+ * of the outer loop's own.
+ */
+bool MIRGraph::OwnsDexPcRange(ArenaBitVector* loop_blocks) {
+  unsigned int min_offset = 0xffffffff;
+  unsigned int max_offset = 0;
+  ArenaBitVector::Iterator bit_iter(loop_blocks);
+  for (int bb_idx = bit_iter.Next(); bb_idx != -1; bb_idx = bit_iter.Next()) {
+    BasicBlock* bb = GetBasicBlock(bb_idx);
+    if (bb->block_type == kDalvikByteCode) {
+      min_offset = (bb->start_offset < min_offset) ? bb->start_offset : min_offset;
+      max_offset = (bb->start_offset > max_offset) ? bb->start_offset : max_offset;
+    }
+  }
+  GrowableArray<BasicBlock*>::Iterator iter(&block_list_);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    if ((bb->block_type == kDalvikByteCode) && !loop_blocks->IsBitSet(bb->id) &&
+        (bb->start_offset >= min_offset) && (bb->start_offset <= max_offset)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Drop the suspend checks of backward branches in loops known to finish within
+ * kMaxUncheckedLoopIterations, nested unchecked loops multiplying their bounds and sibling ones
+ * adding them up, so that short inner loops leave the check to the loops around them.  A
+ * backward branch belongs to the innermost loop holding both of its ends and keeps its check
+ * unless that loop goes unchecked.
+ * Loops containing invokes get no special treatment: leaf methods don't check for suspension
+ * on return, so a call is not a safepoint.
+ */
+void MIRGraph::SuspendCheckElimination() {
+  if (cu_->disable_opt & (1 << kSuspendCheckElimination)) {
+    return;
+  }
+  FindSSADefinitions();
+  // Per block, the backward branch edges claimed by a loop, 1 for taken and 2 for fall through,
+  // and those of them claimed by an unchecked loop.
+  std::vector<uint8_t> claimed_edges(GetNumBlocks(), 0);
+  std::vector<uint8_t> unchecked_edges(GetNumBlocks(), 0);
+  // Per loop header, the iterations of the loop if unchecked, nested unchecked loops included,
+  // until an unchecked loop around it takes them over.
+  std::vector<int64_t> unchecked_iterations(GetNumBlocks(), 0);
+  // Visit inner loops before the loops around them.
+  PostOrderDOMIterator iter(this, false /* not iterative */);
+  for (BasicBlock* header = iter.Next(); header != NULL; header = iter.Next()) {
+    if ((header->block_type != kDalvikByteCode) || (header->data_flow_info == NULL) ||
+        header->catch_entry || !IsLoopHeader(header)) {
+      continue;
+    }
+    ArenaBitVector* loop_blocks = FindLoopBlocks(header);
+    int64_t iterations = LoopIterationBound(header, loop_blocks);
+    bool unchecked = false;
+    if (iterations >= 0) {
+      // Sibling loops all run on each iteration, add them up.  Those left to count are the
+      // outermost unchecked loops inside this one.
+      int64_t nested_iterations = 0;
+      ArenaBitVector::Iterator bit_iter(loop_blocks);
+      for (int bb_idx = bit_iter.Next(); bb_idx != -1; bb_idx = bit_iter.Next()) {
+        nested_iterations += unchecked_iterations[bb_idx];
+      }
+      iterations *= (nested_iterations > 1) ? nested_iterations : 1;
+      unchecked = (iterations <= kMaxUncheckedLoopIterations) && OwnsDexPcRange(loop_blocks);
+      if (unchecked) {
+        ArenaBitVector::Iterator clear_iter(loop_blocks);
+        for (int bb_idx = clear_iter.Next(); bb_idx != -1; bb_idx = clear_iter.Next()) {
+          unchecked_iterations[bb_idx] = 0;
+        }
+        unchecked_iterations[header->id] = iterations;
+      }
+    }
+    ArenaBitVector::Iterator bit_iter(loop_blocks);
+    for (int bb_idx = bit_iter.Next(); bb_idx != -1; bb_idx = bit_iter.Next()) {
+      BasicBlock* bb = GetBasicBlock(bb_idx);
+      uint8_t edges = 0;
+      if (IsBackedge(bb, bb->taken) && loop_blocks->IsBitSet(bb->taken->id)) {
+        edges |= 1;
+      }
+      if (IsBackedge(bb, bb->fall_through) && loop_blocks->IsBitSet(bb->fall_through->id)) {
+        edges |= 2;
+      }
+      edges &= ~claimed_edges[bb_idx];
+      claimed_edges[bb_idx] |= edges;
+      if (unchecked) {
+        unchecked_edges[bb_idx] |= edges;
+      }
+    }
+  }
+  AllNodesIterator all_iter(this, false /* not iterative */);
+  for (BasicBlock* bb = all_iter.Next(); bb != NULL; bb = all_iter.Next()) {
+    MIR* branch = bb->last_mir_insn;
+    if ((branch == NULL) || (static_cast<int>(branch->dalvikInsn.opcode) >= kMirOpFirst) ||
+        !(Instruction::FlagsOf(branch->dalvikInsn.opcode) & Instruction::kBranch)) {
+      continue;
+    }
+    uint8_t edges = (IsBackedge(bb, bb->taken) ? 1 : 0) |
+        (IsBackedge(bb, bb->fall_through) ? 2 : 0);
+    if ((edges != 0) && ((unchecked_edges[bb->id] & edges) == edges)) {
+      branch->optimization_flags |= MIR_IGNORE_SUSPEND_CHECK;
+      if (cu_->verbose) {
+        LOG(INFO) << "Suppressed suspend check on short loop branch at 0x" << std::hex
+                  << branch->offset;
+      }
+    }
+  }
+}
+
 void MIRGraph::BasicBlockCombine() {
   PreOrderDfsIterator iter(this, false /* not iterative */);
   for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
@@ -787,6 +1626,171 @@ void MIRGraph::BasicBlockCombine() {
   }
 }
 
+// Returns the caller's register holding argument word arg_idx of an invoke.
+static uint32_t InvokeArgReg(const MIR* mir, uint32_t arg_idx) {
+  if (Instruction::FormatOf(mir->dalvikInsn.opcode) == Instruction::k3rc) {
+    return mir->dalvikInsn.vC + arg_idx;
+  }
+  return mir->dalvikInsn.arg[arg_idx];
+}
+
+/*
+ * Attribute an inlined field access to the callee, so that codegen checks the field's
+ * accessibility from the callee's class rather than the caller's.
+ */
+void MIRGraph::AddCalleeUnit(MIR* mir, DexCompilationUnit* callee_unit) {
+  mir->m_unit_index = m_units_.size();
+  mir->optimization_flags |= MIR_CALLEE;
+  m_units_.push_back(callee_unit);
+}
+
+/*
+ * Replace an invoke whose exact target is a trivial instance method by the callee's body: a
+ * getter becomes an iget into the move-result's register, a setter an iput and an empty method
+ * a null check of the receiver.  The replacements throw nothing but the invoke's own
+ * NullPointerException and never suspend, so the exception edges and mapping tables built for
+ * the invoke stay valid and stack walks need no notion of an inlined frame.
+ */
+bool MIRGraph::InlineInvoke(BasicBlock* bb, MIR* mir) {
+  InvokeType invoke_type;
+  switch (mir->dalvikInsn.opcode) {
+    case Instruction::INVOKE_DIRECT:
+    case Instruction::INVOKE_DIRECT_RANGE:
+      invoke_type = kDirect;
+      break;
+    case Instruction::INVOKE_VIRTUAL:
+    case Instruction::INVOKE_VIRTUAL_RANGE:
+      invoke_type = kVirtual;
+      break;
+    case Instruction::INVOKE_SUPER:
+    case Instruction::INVOKE_SUPER_RANGE:
+      invoke_type = kSuper;
+      break;
+    case Instruction::INVOKE_INTERFACE:
+    case Instruction::INVOKE_INTERFACE_RANGE:
+      invoke_type = kInterface;
+      break;
+    default:
+      return false;
+  }
+  // Only calls sharpened to a single target can be inlined.
+  MethodReference target_method(cu_->dex_file, mir->dalvikInsn.vB);
+  int vtable_idx;
+  uintptr_t direct_code;
+  uintptr_t direct_method;
+  if (!cu_->compiler_driver->ComputeInvokeInfo(GetCurrentDexCompilationUnit(), mir->offset,
+                                               invoke_type, target_method, vtable_idx,
+                                               direct_code, direct_method, false) ||
+      (invoke_type != kDirect)) {
+    return false;
+  }
+  UniquePtr<DexCompilationUnit> callee_unit(
+      cu_->compiler_driver->GetInlineCandidateUnit(GetCurrentDexCompilationUnit(),
+                                                   target_method));
+  if (callee_unit.get() == NULL) {
+    return false;
+  }
+  const DexFile::CodeItem* code_item = callee_unit->GetCodeItem();
+  if ((code_item == NULL) || (code_item->tries_size_ != 0) ||
+      (code_item->ins_size_ != mir->dalvikInsn.vA)) {
+    return false;
+  }
+  const Instruction* inst = Instruction::At(code_item->insns_);
+  DecodedInstruction first(inst);
+  if ((code_item->insns_size_in_code_units_ == 1) && (first.opcode == Instruction::RETURN_VOID)) {
+    // An empty method, such as Object.<init>, leaves only the receiver's null check.
+    mir->dalvikInsn.vA = InvokeArgReg(mir, 0);
+    mir->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNullCheck);
+    return true;
+  }
+  // Field indexes of the callee must be valid in the caller.
+  if ((callee_unit->GetDexFile() != cu_->dex_file) ||
+      (code_item->insns_size_in_code_units_ != inst->SizeInCodeUnits() + 1)) {
+    return false;
+  }
+  DecodedInstruction second(inst->Next());
+  // The callee's ins occupy its last registers, "this" first.
+  uint32_t this_reg = code_item->registers_size_ - code_item->ins_size_;
+  if (first.vB != this_reg) {
+    return false;
+  }
+  int field_offset;
+  bool is_volatile;
+  if ((first.opcode >= Instruction::IGET) && (first.opcode <= Instruction::IGET_SHORT)) {
+    Instruction::Code return_opcode = (first.opcode == Instruction::IGET_WIDE) ?
+        Instruction::RETURN_WIDE : (first.opcode == Instruction::IGET_OBJECT) ?
+        Instruction::RETURN_OBJECT : Instruction::RETURN;
+    if ((second.opcode != return_opcode) || (second.vA != first.vA)) {
+      return false;
+    }
+    MIR* move_result = FindMoveResult(bb, mir);
+    if ((move_result == NULL) ||
+        !cu_->compiler_driver->ComputeInstanceFieldInfo(first.vC, callee_unit.get(),
+                                                        field_offset, is_volatile, false)) {
+      return false;
+    }
+    mir->dalvikInsn.vB = InvokeArgReg(mir, 0);
+    mir->dalvikInsn.vA = move_result->dalvikInsn.vA;
+    mir->dalvikInsn.vC = first.vC;
+    mir->dalvikInsn.opcode = first.opcode;
+    move_result->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpNop);
+    AddCalleeUnit(mir, callee_unit.release());
+    return true;
+  }
+  if ((first.opcode >= Instruction::IPUT) && (first.opcode <= Instruction::IPUT_SHORT)) {
+    if ((second.opcode != Instruction::RETURN_VOID) || (first.vA < this_reg)) {
+      return false;
+    }
+    uint32_t value_idx = first.vA - this_reg;
+    uint32_t value_reg = InvokeArgReg(mir, value_idx);
+    // A wide value must be passed in a register pair.
+    if ((first.opcode == Instruction::IPUT_WIDE) &&
+        ((value_idx + 1 >= code_item->ins_size_) ||
+         (InvokeArgReg(mir, value_idx + 1) != value_reg + 1))) {
+      return false;
+    }
+    if (!cu_->compiler_driver->ComputeInstanceFieldInfo(first.vC, callee_unit.get(),
+                                                        field_offset, is_volatile, true)) {
+      return false;
+    }
+    mir->dalvikInsn.vB = InvokeArgReg(mir, 0);
+    mir->dalvikInsn.vA = value_reg;
+    mir->dalvikInsn.vC = first.vC;
+    mir->dalvikInsn.opcode = first.opcode;
+    AddCalleeUnit(mir, callee_unit.release());
+    return true;
+  }
+  return false;
+}
+
+void MIRGraph::InlineCalls() {
+  if (cu_->disable_opt & (1 << kInlineCalls)) {
+    return;
+  }
+  AllNodesIterator iter(this, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (!InlineInvoke(bb, mir)) {
+        continue;
+      }
+      // Codegen compiles the check half with the work half's opcode but its own operands, so
+      // the check half must see the rewritten operands as well.
+      MIR* check_half = mir->meta.throw_insn;
+      if (check_half != NULL) {
+        DCHECK_EQ(static_cast<int>(check_half->dalvikInsn.opcode), kMirOpCheck);
+        check_half->dalvikInsn = mir->dalvikInsn;
+        check_half->dalvikInsn.opcode = static_cast<Instruction::Code>(kMirOpCheck);
+        check_half->m_unit_index = mir->m_unit_index;
+        check_half->optimization_flags |= (mir->optimization_flags & MIR_CALLEE);
+      }
+      if (cu_->verbose) {
+        LOG(INFO) << "Inlined call at 0x" << std::hex << mir->offset << " of "
+                  << PrettyMethod(cu_->method_idx, *cu_->dex_file);
+      }
+    }
+  }
+}
+
 void MIRGraph::CodeLayout() {
   if (cu_->enable_debug & (1 << kDebugVerifyDataflow)) {
     VerifyDataflow();
@@ -50,9 +50,12 @@ void Mir2Lir::MarkSafepointPC(LIR* inst) {
   DCHECK_EQ(safepoint_pc->def_mask, ENCODE_ALL);
 }
 
-bool Mir2Lir::FastInstance(uint32_t field_idx, int& field_offset, bool& is_volatile, bool is_put) {
+// Accesses inlined from a callee are checked from the callee's class, see MIRGraph::InlineInvoke.
+bool Mir2Lir::FastInstance(uint32_t field_idx, int m_unit_index, int& field_offset,
+                           bool& is_volatile, bool is_put) {
   return cu_->compiler_driver->ComputeInstanceFieldInfo(
-      field_idx, mir_graph_->GetCurrentDexCompilationUnit(), field_offset, is_volatile, is_put);
+      field_idx, mir_graph_->GetDexCompilationUnit(m_unit_index), field_offset, is_volatile,
+      is_put);
 }
 
 /* Convert an instruction to a NOP */
@@ -949,6 +952,7 @@ Mir2Lir::Mir2Lir(CompilationUnit* cu, MIRGraph* mir_graph, ArenaAllocator* arena
       throw_launchpads_(arena, 2048, kGrowableArrayThrowLaunchPads),
       suspend_launchpads_(arena, 4, kGrowableArraySuspendLaunchPads),
       intrinsic_launchpads_(arena, 2048, kGrowableArrayMisc),
+      suspend_stores_(NULL),
       data_offset_(0),
       total_size_(0),
       block_label_list_(NULL),
@@ -508,7 +508,11 @@ void Mir2Lir::HandleSuspendLaunchPads() {
     LIR* lab = suspend_launchpads_.Get(i);
     LIR* resume_lab = reinterpret_cast<LIR*>(lab->operands[0]);
     current_dalvik_offset_ = lab->operands[1];
+    ArenaBitVector* stores = reinterpret_cast<ArenaBitVector*>(lab->operands[2]);
     AppendLIR(lab);
+    if (stores != NULL) {
+      StoreSharedHomes(stores);
+    }
     int r_tgt = CallHelperSetup(helper_offset);
     CallHelper(r_tgt, helper_offset, true /* MarkSafepointPC */);
     OpUnconditionalBranch(resume_lab);
@@ -620,13 +624,13 @@ void Mir2Lir::HandleThrowLaunchPads() {
   }
 }
 
-void Mir2Lir::GenIGet(uint32_t field_idx, int opt_flags, OpSize size,
+void Mir2Lir::GenIGet(uint32_t field_idx, int m_unit_index, int opt_flags, OpSize size,
                       RegLocation rl_dest, RegLocation rl_obj, bool is_long_or_double,
                       bool is_object) {
   int field_offset;
   bool is_volatile;
 
-  bool fast_path = FastInstance(field_idx, field_offset, is_volatile, false);
+  bool fast_path = FastInstance(field_idx, m_unit_index, field_offset, is_volatile, false);
 
   if (fast_path && !SLOW_FIELD_PATH) {
     RegLocation rl_result;
@@ -681,14 +685,13 @@ void Mir2Lir::GenIGet(uint32_t field_idx, int opt_flags, OpSize size,
   }
 }
 
-void Mir2Lir::GenIPut(uint32_t field_idx, int opt_flags, OpSize size,
+void Mir2Lir::GenIPut(uint32_t field_idx, int m_unit_index, int opt_flags, OpSize size,
                       RegLocation rl_src, RegLocation rl_obj, bool is_long_or_double,
                       bool is_object) {
   int field_offset;
   bool is_volatile;
 
-  bool fast_path = FastInstance(field_idx, field_offset, is_volatile,
-                 true);
+  bool fast_path = FastInstance(field_idx, m_unit_index, field_offset, is_volatile, true);
   if (fast_path && !SLOW_FIELD_PATH) {
     RegisterClass reg_class = oat_reg_class_by_size(size);
     DCHECK_GE(field_offset, 0);
@@ -1745,7 +1748,8 @@ void Mir2Lir::GenSuspendTest(int opt_flags) {
   LIR* branch = OpTestSuspend(NULL);
   LIR* ret_lab = NewLIR0(kPseudoTargetLabel);
   LIR* target = RawLIR(current_dalvik_offset_, kPseudoSuspendTarget,
-                       reinterpret_cast<uintptr_t>(ret_lab), current_dalvik_offset_);
+                       reinterpret_cast<uintptr_t>(ret_lab), current_dalvik_offset_,
+                       reinterpret_cast<uintptr_t>(suspend_stores_));
   branch->target = target;
   suspend_launchpads_.Insert(target);
 }
@@ -1759,7 +1763,8 @@ void Mir2Lir::GenSuspendTestAndBranch(int opt_flags, LIR* target) {
   OpTestSuspend(target);
   LIR* launch_pad =
       RawLIR(current_dalvik_offset_, kPseudoSuspendTarget,
-             reinterpret_cast<uintptr_t>(target), current_dalvik_offset_);
+             reinterpret_cast<uintptr_t>(target), current_dalvik_offset_,
+             reinterpret_cast<uintptr_t>(suspend_stores_));
   FlushAllRegs();
   OpUnconditionalBranch(launch_pad);
   suspend_launchpads_.Insert(launch_pad);
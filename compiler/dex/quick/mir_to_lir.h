@@ -91,6 +91,7 @@ namespace art {
 #define REG_USE12            (REG_USE1 | REG_USE2)
 #define REG_USE23            (REG_USE2 | REG_USE3)
 
+class ArenaBitVector;
 struct BasicBlock;
 struct CallInfo;
 struct CompilationUnit;
@@ -190,6 +191,12 @@ class Mir2Lir : public Backend {
       bool double_start;   // Starting v_reg for a double
     };
 
+    // Positions, in dfs order of blocks and mirs, between which a register is live or written.
+    struct LiveInterval {
+      int start;           // -1 if the register is never live.
+      int end;
+    };
+
     /*
      * Data structure tracking the mapping between a Dalvik register (pair) and a
      * native register (pair). The idea is to reuse the previously loaded value
@@ -250,7 +257,8 @@ class Mir2Lir : public Backend {
     virtual void Materialize();
     virtual CompiledMethod* GetCompiledMethod();
     void MarkSafepointPC(LIR* inst);
-    bool FastInstance(uint32_t field_idx, int& field_offset, bool& is_volatile, bool is_put);
+    bool FastInstance(uint32_t field_idx, int m_unit_index, int& field_offset, bool& is_volatile,
+                      bool is_put);
     void SetupResourceMasks(LIR* lir);
     void AssembleLIR();
     void SetMemRefType(LIR* lir, bool is_load, int mem_type);
@@ -369,7 +377,12 @@ class Mir2Lir : public Backend {
     RegLocation EvalLoc(RegLocation loc, int reg_class, bool update);
     void CountRefs(RefCounts* core_counts, RefCounts* fp_counts);
     void DumpCounts(const RefCounts* arr, int size, const char* msg);
+    bool IsSafepoint(BasicBlock* bb, MIR* mir);
+    int ComputeLiveIntervals(LiveInterval* intervals,
+                             std::vector<std::pair<MIR*, int> >* safepoints);
+    void LinearScanPromoteCoreRegs(RefCounts* counts, int num_regs);
     void DoPromotion();
+    void StoreSharedHomes(ArenaBitVector* v_regs);
     int VRegOffset(int v_reg);
     int SRegOffset(int s_reg);
     RegLocation GetReturnWide(bool is_double);
@@ -403,9 +416,9 @@ class Mir2Lir : public Backend {
                  bool is_long_or_double, bool is_object);
     void GenSget(uint32_t field_idx, RegLocation rl_dest,
                  bool is_long_or_double, bool is_object);
-    void GenIGet(uint32_t field_idx, int opt_flags, OpSize size,
+    void GenIGet(uint32_t field_idx, int m_unit_index, int opt_flags, OpSize size,
                  RegLocation rl_dest, RegLocation rl_obj, bool is_long_or_double, bool is_object);
-    void GenIPut(uint32_t field_idx, int opt_flags, OpSize size,
+    void GenIPut(uint32_t field_idx, int m_unit_index, int opt_flags, OpSize size,
                  RegLocation rl_src, RegLocation rl_obj, bool is_long_or_double, bool is_object);
     void GenConstClass(uint32_t type_idx, RegLocation rl_dest);
     void GenConstString(uint32_t string_idx, RegLocation rl_dest);
@@ -727,6 +740,13 @@ class Mir2Lir : public Backend {
     GrowableArray<LIR*> throw_launchpads_;
     GrowableArray<LIR*> suspend_launchpads_;
     GrowableArray<LIR*> intrinsic_launchpads_;
+    /*
+     * The Dalvik registers sharing a promoted home that are live at each safepoint MIR, which
+     * are stored to their frame slots there, see LinearScanPromoteCoreRegs.  Backward branches
+     * leave theirs in suspend_stores_ for the slow path of their suspend check.
+     */
+    SafeMap<MIR*, ArenaBitVector*> safepoint_stores_;
+    ArenaBitVector* suspend_stores_;
     SafeMap<unsigned int, LIR*> boundary_map_;  // boundary lookup cache.
     /*
      * Holds mapping from native PC to dex PC for safepoints where we may deoptimize.
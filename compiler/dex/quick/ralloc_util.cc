@@ -16,8 +16,13 @@
 
 /* This file contains register alloction support. */
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 #include "dex/compiler_ir.h"
 #include "dex/compiler_internals.h"
+#include "dex/dataflow_iterator-inl.h"
 #include "mir_to_lir-inl.h"
 
 namespace art {
@@ -946,6 +951,391 @@ void Mir2Lir::DumpCounts(const RefCounts* arr, int size, const char* msg) {
   }
 }
 
+static void ExtendInterval(Mir2Lir::LiveInterval* interval, int pos) {
+  if (interval->start == -1) {
+    interval->start = pos;
+    interval->end = pos;
+  } else {
+    interval->start = std::min(interval->start, pos);
+    interval->end = std::max(interval->end, pos);
+  }
+}
+
+static void ExtendIntervals(Mir2Lir::LiveInterval* intervals, ArenaBitVector* regs, int pos) {
+  ArenaBitVector::Iterator iter(regs);
+  for (int v_reg = iter.Next(); v_reg != -1; v_reg = iter.Next()) {
+    ExtendInterval(&intervals[v_reg], pos);
+  }
+}
+
+/* live_out = union of the live-in sets of bb's successors, exception handlers included */
+static void ComputeLiveOut(BasicBlock* bb, ArenaBitVector** live_ins, ArenaBitVector* live_out) {
+  live_out->ClearAllBits();
+  if ((bb->taken != NULL) && (live_ins[bb->taken->id] != NULL)) {
+    live_out->Union(live_ins[bb->taken->id]);
+  }
+  if ((bb->fall_through != NULL) && (live_ins[bb->fall_through->id] != NULL)) {
+    live_out->Union(live_ins[bb->fall_through->id]);
+  }
+  if (bb->successor_block_list.block_list_type != kNotUsed) {
+    GrowableArray<SuccessorBlockInfo*>::Iterator iter(bb->successor_block_list.blocks);
+    for (SuccessorBlockInfo* info = iter.Next(); info != NULL; info = iter.Next()) {
+      if (live_ins[info->block->id] != NULL) {
+        live_out->Union(live_ins[info->block->id]);
+      }
+    }
+  }
+}
+
+/*
+ * Can the runtime read the frame at mir, for a debugger or deoptimization?  Both only look at
+ * threads stopped in a call out of compiled code: an invoke, a runtime call that may suspend, or
+ * the suspend check of a backward branch.  Returns are left out as nothing is live after them,
+ * and so are the checks that throw, whose exceptions either unwind the frame or resume in a
+ * handler with the callee-save registers restored.
+ */
+bool Mir2Lir::IsSafepoint(BasicBlock* bb, MIR* mir) {
+  Instruction::Code opcode = mir->dalvikInsn.opcode;
+  if (static_cast<int>(opcode) >= kMirOpFirst) {
+    return false;
+  }
+  int flags = Instruction::FlagsOf(opcode);
+  if ((flags & Instruction::kInvoke) != 0) {
+    return true;
+  }
+  if ((flags & Instruction::kBranch) != 0) {
+    return !(mir->optimization_flags & MIR_IGNORE_SUSPEND_CHECK) &&
+        mir_graph_->IsBackwardsBranch(bb);
+  }
+  switch (opcode) {
+    case Instruction::CONST_STRING:
+    case Instruction::CONST_STRING_JUMBO:
+    case Instruction::CONST_CLASS:
+    case Instruction::MONITOR_ENTER:
+    case Instruction::MONITOR_EXIT:
+    case Instruction::CHECK_CAST:
+    case Instruction::INSTANCE_OF:
+    case Instruction::NEW_INSTANCE:
+    case Instruction::NEW_ARRAY:
+    case Instruction::FILLED_NEW_ARRAY:
+    case Instruction::FILLED_NEW_ARRAY_RANGE:
+    case Instruction::FILL_ARRAY_DATA:
+    case Instruction::APUT_OBJECT:
+      return true;
+    case Instruction::IGET:
+    case Instruction::IGET_WIDE:
+    case Instruction::IGET_OBJECT:
+    case Instruction::IGET_BOOLEAN:
+    case Instruction::IGET_BYTE:
+    case Instruction::IGET_CHAR:
+    case Instruction::IGET_SHORT:
+    case Instruction::IPUT:
+    case Instruction::IPUT_WIDE:
+    case Instruction::IPUT_OBJECT:
+    case Instruction::IPUT_BOOLEAN:
+    case Instruction::IPUT_BYTE:
+    case Instruction::IPUT_CHAR:
+    case Instruction::IPUT_SHORT: {
+      // Only the slow path calls out.
+      int field_offset;
+      bool is_volatile;
+      bool is_put = (opcode >= Instruction::IPUT);
+      return SLOW_FIELD_PATH || !FastInstance(mir->dalvikInsn.vC, mir->m_unit_index,
+                                              field_offset, is_volatile, is_put);
+    }
+    case Instruction::SGET:
+    case Instruction::SGET_WIDE:
+    case Instruction::SGET_OBJECT:
+    case Instruction::SGET_BOOLEAN:
+    case Instruction::SGET_BYTE:
+    case Instruction::SGET_CHAR:
+    case Instruction::SGET_SHORT:
+    case Instruction::SPUT:
+    case Instruction::SPUT_WIDE:
+    case Instruction::SPUT_OBJECT:
+    case Instruction::SPUT_BOOLEAN:
+    case Instruction::SPUT_BYTE:
+    case Instruction::SPUT_CHAR:
+    case Instruction::SPUT_SHORT: {
+      // Statics of other classes may need their class initialized.
+      int field_offset;
+      int ssb_index;
+      bool is_referrers_class;
+      bool is_volatile;
+      bool is_put = (opcode >= Instruction::SPUT);
+      bool fast_path = cu_->compiler_driver->ComputeStaticFieldInfo(
+          mir->dalvikInsn.vB, mir_graph_->GetCurrentDexCompilationUnit(), field_offset,
+          ssb_index, is_referrers_class, is_volatile, is_put);
+      return SLOW_FIELD_PATH || !fast_path || !is_referrers_class;
+    }
+    default:
+      return false;
+  }
+}
+
+/*
+ * Compute the live interval of each Dalvik register, and return the last position.  Liveness
+ * is computed on Dalvik registers rather than SSA names as promotion gives a home to all the
+ * SSA names of a register.  Writes are included even when dead, they still clobber the home.
+ * The safepoints are listed with their positions, in increasing order.
+ */
+int Mir2Lir::ComputeLiveIntervals(LiveInterval* intervals,
+                                  std::vector<std::pair<MIR*, int> >* safepoints) {
+  int num_vregs = cu_->num_dalvik_registers;
+  int num_blocks = mir_graph_->GetNumBlocks();
+  for (int i = 0; i < num_vregs; i++) {
+    intervals[i].start = -1;
+    intervals[i].end = -1;
+  }
+  ArenaBitVector** use_v = static_cast<ArenaBitVector**>(
+      arena_->Alloc(sizeof(ArenaBitVector*) * num_blocks, ArenaAllocator::kAllocRegAlloc));
+  ArenaBitVector** def_v = static_cast<ArenaBitVector**>(
+      arena_->Alloc(sizeof(ArenaBitVector*) * num_blocks, ArenaAllocator::kAllocRegAlloc));
+  ArenaBitVector** live_in_v = static_cast<ArenaBitVector**>(
+      arena_->Alloc(sizeof(ArenaBitVector*) * num_blocks, ArenaAllocator::kAllocRegAlloc));
+
+  // Find the registers read before being written, and the registers written, in each block.
+  PreOrderDfsIterator iter(mir_graph_, false /* not iterative */);
+  for (BasicBlock* bb = iter.Next(); bb != NULL; bb = iter.Next()) {
+    if (bb->block_type == kDead) {
+      continue;
+    }
+    ArenaBitVector* use = new (arena_) ArenaBitVector(arena_, num_vregs, false, kBitMapUse);
+    ArenaBitVector* def = new (arena_) ArenaBitVector(arena_, num_vregs, false, kBitMapDef);
+    use_v[bb->id] = use;
+    def_v[bb->id] = def;
+    live_in_v[bb->id] = new (arena_) ArenaBitVector(arena_, num_vregs, false, kBitMapLiveIn);
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if ((mir->ssa_rep == NULL) || (static_cast<int>(mir->dalvikInsn.opcode) == kMirOpPhi)) {
+        continue;
+      }
+      for (int i = 0; i < mir->ssa_rep->num_uses; i++) {
+        int v_reg = mir_graph_->SRegToVReg(mir->ssa_rep->uses[i]);
+        if ((v_reg >= 0) && !def->IsBitSet(v_reg)) {
+          use->SetBit(v_reg);
+        }
+      }
+      for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+        int v_reg = mir_graph_->SRegToVReg(mir->ssa_rep->defs[i]);
+        if (v_reg >= 0) {
+          def->SetBit(v_reg);
+        }
+      }
+    }
+  }
+
+  // live_in = use | (live_out & ~def), iterated to a fixed point.
+  ArenaBitVector* live_out = new (arena_) ArenaBitVector(arena_, num_vregs, false, kBitMapLiveIn);
+  bool change = true;
+  while (change) {
+    change = false;
+    PostOrderDfsIterator iter2(mir_graph_, false /* not iterative */);
+    for (BasicBlock* bb = iter2.Next(); bb != NULL; bb = iter2.Next()) {
+      ArenaBitVector* live_in = live_in_v[bb->id];
+      if (live_in == NULL) {
+        continue;
+      }
+      ComputeLiveOut(bb, live_in_v, live_out);
+      for (uint32_t i = 0; i < live_in->GetStorageSize(); i++) {
+        uint32_t word = use_v[bb->id]->GetRawStorageWord(i) |
+            (live_out->GetRawStorageWord(i) & ~def_v[bb->id]->GetRawStorageWord(i));
+        if (word != live_in->GetRawStorageWord(i)) {
+          live_in->GetRawStorage()[i] = word;
+          change = true;
+        }
+      }
+    }
+  }
+
+  // Number blocks and mirs in the order used above and extend the intervals over them.  An
+  // instruction split at a throw is compiled at its check half, but only its work half, in a
+  // later block, uses and defines registers, so it stands for the instruction.
+  std::set<MIR*> work_halves;
+  int pos = 0;
+  PreOrderDfsIterator iter3(mir_graph_, false /* not iterative */);
+  for (BasicBlock* bb = iter3.Next(); bb != NULL; bb = iter3.Next()) {
+    if (live_in_v[bb->id] == NULL) {
+      continue;
+    }
+    ExtendIntervals(intervals, live_in_v[bb->id], pos++);
+    for (MIR* mir = bb->first_mir_insn; mir != NULL; mir = mir->next) {
+      if (static_cast<int>(mir->dalvikInsn.opcode) == kMirOpPhi) {
+        continue;
+      }
+      if (mir->ssa_rep != NULL) {
+        for (int i = 0; i < mir->ssa_rep->num_uses; i++) {
+          int v_reg = mir_graph_->SRegToVReg(mir->ssa_rep->uses[i]);
+          if (v_reg >= 0) {
+            ExtendInterval(&intervals[v_reg], pos);
+          }
+        }
+        for (int i = 0; i < mir->ssa_rep->num_defs; i++) {
+          int v_reg = mir_graph_->SRegToVReg(mir->ssa_rep->defs[i]);
+          if (v_reg >= 0) {
+            ExtendInterval(&intervals[v_reg], pos);
+          }
+        }
+      }
+      if (static_cast<int>(mir->dalvikInsn.opcode) == kMirOpCheck) {
+        work_halves.insert(mir->meta.throw_insn);
+      } else if (IsSafepoint(bb, mir)) {
+        MIR* compiled = (work_halves.count(mir) != 0) ? mir->meta.throw_insn : mir;
+        safepoints->push_back(std::make_pair(compiled, pos));
+      }
+      pos++;
+    }
+    ComputeLiveOut(bb, live_in_v, live_out);
+    ExtendIntervals(intervals, live_out, pos++);
+  }
+
+  // All arguments are copied to their homes on entry.
+  for (int i = num_vregs - cu_->num_ins; i < num_vregs; i++) {
+    intervals[i].start = 0;
+    intervals[i].end = std::max(intervals[i].end, 0);
+  }
+  return pos - 1;
+}
+
+struct LinearScanCandidate {
+  int p_map_idx;
+  int s_reg;
+  int count;
+};
+
+struct LinearScanStartLess {
+  const Mir2Lir::LiveInterval* intervals;
+  bool operator()(const LinearScanCandidate& a, const LinearScanCandidate& b) const {
+    return intervals[a.p_map_idx].start < intervals[b.p_map_idx].start;
+  }
+};
+
+/*
+ * Promote core registers by a linear scan over live intervals, so that Dalvik registers never
+ * live at the same time can share a callee-save register.  The vmap table can only name one
+ * Dalvik register per promoted register, so the runtime reads the others from their frame slots,
+ * which promotion leaves stale: those live at a safepoint are stored there before it, see
+ * IsSafepoint.  A debugger write to them is then lost, as is one to the named register while
+ * it is dead, which also clobbers the sharer live at the time.  The GC maps may name a dead
+ * register as a reference, so registers ever holding a reference keep their register for the
+ * whole method, as do Method* and compiler temps.  When registers run out, the interval with the
+ * lowest use count stays in the frame.  Intervals aren't split, that would need moves at the
+ * split points.
+ */
+void Mir2Lir::LinearScanPromoteCoreRegs(RefCounts* counts, int num_regs) {
+  const int promotion_threshold = 1;
+  int dalvik_regs = cu_->num_dalvik_registers;
+  LiveInterval* intervals = static_cast<LiveInterval*>(
+      arena_->Alloc(sizeof(LiveInterval) * num_regs, ArenaAllocator::kAllocRegAlloc));
+  std::vector<std::pair<MIR*, int> > safepoints;
+  int last_pos = ComputeLiveIntervals(intervals, &safepoints);
+  for (int i = dalvik_regs; i < num_regs; i++) {
+    intervals[i].start = 0;
+    intervals[i].end = last_pos;
+  }
+  for (int i = 0; i < mir_graph_->GetNumSSARegs(); i++) {
+    RegLocation loc = mir_graph_->reg_location_[i];
+    int v_reg = mir_graph_->SRegToVReg(loc.s_reg_low);
+    if (loc.ref && (v_reg >= 0)) {
+      intervals[v_reg].start = 0;
+      intervals[v_reg].end = last_pos;
+    }
+  }
+
+  // Counts are sorted, so candidates starting together are taken most used first.
+  std::vector<LinearScanCandidate> candidates;
+  for (int i = 0; i < num_regs; i++) {
+    int p_map_idx = SRegToPMap(counts[i].s_reg);
+    if ((counts[i].count >= promotion_threshold) && (intervals[p_map_idx].start != -1)) {
+      LinearScanCandidate candidate = { p_map_idx, counts[i].s_reg, counts[i].count };
+      candidates.push_back(candidate);
+    }
+  }
+  LinearScanStartLess start_less = { intervals };
+  std::stable_sort(candidates.begin(), candidates.end(), start_less);
+
+  std::vector<int> free_regs;
+  RegisterInfo* core_regs = reg_pool_->core_regs;
+  for (int i = reg_pool_->num_core_regs - 1; i >= 0; i--) {
+    if (!core_regs[i].is_temp && !core_regs[i].in_use) {
+      free_regs.push_back(core_regs[i].reg);
+    }
+  }
+  std::vector<int> assigned(num_regs, INVALID_REG);
+  std::vector<LinearScanCandidate> active;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    int p_map_idx = candidates[i].p_map_idx;
+    int start = intervals[p_map_idx].start;
+    for (size_t j = 0; j < active.size();) {
+      if (intervals[active[j].p_map_idx].end < start) {
+        free_regs.push_back(assigned[active[j].p_map_idx]);
+        active.erase(active.begin() + j);
+      } else {
+        j++;
+      }
+    }
+    if (!free_regs.empty()) {
+      assigned[p_map_idx] = free_regs.back();
+      free_regs.pop_back();
+      active.push_back(candidates[i]);
+      continue;
+    }
+    // Spill whichever of the active intervals and this one is least used.
+    size_t victim = active.size();
+    int victim_count = candidates[i].count;
+    for (size_t j = 0; j < active.size(); j++) {
+      if (active[j].count < victim_count) {
+        victim = j;
+        victim_count = active[j].count;
+      }
+    }
+    if (victim != active.size()) {
+      assigned[p_map_idx] = assigned[active[victim].p_map_idx];
+      assigned[active[victim].p_map_idx] = INVALID_REG;
+      active[victim] = candidates[i];
+    }
+  }
+
+  std::vector<int> shared;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    int p_map_idx = candidates[i].p_map_idx;
+    int reg = assigned[p_map_idx];
+    if (reg == INVALID_REG) {
+      continue;
+    }
+    if (cu_->verbose) {
+      LOG(INFO) << "Linear scan: pmap " << p_map_idx << " [" << intervals[p_map_idx].start
+                << ", " << intervals[p_map_idx].end << "] -> r" << reg;
+    }
+    if (!GetRegInfo(reg)->in_use) {
+      // First user of the register, which the vmap table will name.
+      RecordCorePromotion(reg, candidates[i].s_reg);
+    } else {
+      promotion_map_[p_map_idx].core_location = kLocPhysReg;
+      promotion_map_[p_map_idx].core_reg = reg;
+      shared.push_back(p_map_idx);
+    }
+  }
+
+  // Store the unnamed sharers live at each safepoint.  Sharers' intervals don't overlap, so
+  // the home holds the value of any one whose interval spans the safepoint.
+  for (size_t i = 0; i < safepoints.size(); i++) {
+    int pos = safepoints[i].second;
+    ArenaBitVector* stores = NULL;
+    for (size_t j = 0; j < shared.size(); j++) {
+      int v_reg = shared[j];
+      if ((intervals[v_reg].start <= pos) && (intervals[v_reg].end > pos)) {
+        if (stores == NULL) {
+          stores = new (arena_) ArenaBitVector(arena_, dalvik_regs, false, kBitMapRegisterV);
+        }
+        stores->SetBit(v_reg);
+      }
+    }
+    if (stores != NULL) {
+      safepoint_stores_.Put(safepoints[i].first, stores);
+    }
+  }
+}
+
 /*
  * Note: some portions of this code required even if the kPromoteRegs
  * optimization is disabled.
@@ -1027,14 +1417,18 @@ void Mir2Lir::DoPromotion() {
     }
 
     // Promote core regs
-    for (int i = 0; (i < num_regs) &&
-            (core_regs[i].count >= promotion_threshold); i++) {
-      int p_map_idx = SRegToPMap(core_regs[i].s_reg);
-      if (promotion_map_[p_map_idx].core_location !=
-          kLocPhysReg) {
-        int reg = AllocPreservedCoreReg(core_regs[i].s_reg);
-        if (reg < 0) {
-           break;  // No more left
+    if (!(cu_->disable_opt & (1 << kLinearScanRegAlloc))) {
+      LinearScanPromoteCoreRegs(core_regs, num_regs);
+    } else {
+      for (int i = 0; (i < num_regs) &&
+              (core_regs[i].count >= promotion_threshold); i++) {
+        int p_map_idx = SRegToPMap(core_regs[i].s_reg);
+        if (promotion_map_[p_map_idx].core_location !=
+            kLocPhysReg) {
+          int reg = AllocPreservedCoreReg(core_regs[i].s_reg);
+          if (reg < 0) {
+             break;  // No more left
+          }
         }
       }
     }
@@ -1094,6 +1488,15 @@ void Mir2Lir::DoPromotion() {
   }
 }
 
+/* Store promoted Dalvik registers sharing a home to their frame slots, for a safepoint */
+void Mir2Lir::StoreSharedHomes(ArenaBitVector* v_regs) {
+  ArenaBitVector::Iterator iter(v_regs);
+  for (int v_reg = iter.Next(); v_reg != -1; v_reg = iter.Next()) {
+    DCHECK_EQ(promotion_map_[v_reg].core_location, kLocPhysReg);
+    StoreBaseDisp(TargetReg(kSp), VRegOffset(v_reg), promotion_map_[v_reg].core_reg, kWord);
+  }
+}
+
 /* Returns sp-relative offset in bytes for a VReg */
 int Mir2Lir::VRegOffset(int v_reg) {
   return StackVisitor::GetVRegOffset(cu_->code_item, core_spill_mask_,
@@ -33,6 +33,7 @@
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap.h"
 #include "gc/space/space.h"
+#include "interpreter/inline_cache.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/art_method-inl.h"
 #include "mirror/class_loader.h"
@@ -355,7 +356,11 @@ CompilerDriver::CompilerDriver(CompilerBackend compiler_backend, InstructionSet
       jni_compiler_(NULL),
       compiler_enable_auto_elf_loading_(NULL),
       compiler_get_method_code_addr_(NULL),
-      support_boot_image_fixup_(true) {
+      support_boot_image_fixup_(true),
+      dedupe_code_("dedupe code"),
+      dedupe_mapping_table_("dedupe mapping table"),
+      dedupe_vmap_table_("dedupe vmap table"),
+      dedupe_gc_map_("dedupe gc map") {
 
   CHECK_PTHREAD_CALL(pthread_key_create, (&tls_key_, NULL), "compiler tls key");
 
@@ -494,6 +499,11 @@ void CompilerDriver::CompileAll(jobject class_loader,
   Compile(class_loader, dex_files, *thread_pool.get(), timings);
   if (dump_stats_) {
     stats_->Dump();
+    Thread* self = Thread::Current();
+    VLOG(compiler) << "Code dedupe: " << dedupe_code_.DumpStats(self);
+    VLOG(compiler) << "Mapping table dedupe: " << dedupe_mapping_table_.DumpStats(self);
+    VLOG(compiler) << "Vmap table dedupe: " << dedupe_vmap_table_.DumpStats(self);
+    VLOG(compiler) << "GC map dedupe: " << dedupe_gc_map_.DumpStats(self);
   }
 }
 
@@ -1289,6 +1299,41 @@ bool CompilerDriver::ComputeInvokeInfo(const DexCompilationUnit* mUnit, const ui
   return false;  // Incomplete knowledge needs slow path.
 }
 
+bool CompilerDriver::GetReceiverTypes(const DexCompilationUnit* mUnit, uint32_t dex_pc,
+                                      std::vector<mirror::Class*>* receiver_types) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::DexCache* dex_cache = mUnit->GetClassLinker()->FindDexCache(*mUnit->GetDexFile());
+  // The interpreter only records sites of methods that were resolved to be run.
+  mirror::ArtMethod* method = dex_cache->GetResolvedMethod(mUnit->GetDexMethodIndex());
+  if (method == NULL) {
+    return false;
+  }
+  return Runtime::Current()->GetInlineCacheTable()->GetReceiverTypes(method, dex_pc,
+                                                                     receiver_types);
+}
+
+DexCompilationUnit* CompilerDriver::GetInlineCandidateUnit(const DexCompilationUnit* mUnit,
+                                                           const MethodReference& target_method) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::DexCache* dex_cache = mUnit->GetClassLinker()->FindDexCache(*target_method.dex_file);
+  mirror::ArtMethod* method = dex_cache->GetResolvedMethod(target_method.dex_method_index);
+  // Static methods may need their class initialized, natives, abstracts and proxies have no code
+  // item and synchronized methods need the monitor.
+  if (method == NULL || method->IsStatic() || method->IsNative() || method->IsAbstract() ||
+      method->IsProxyMethod() || method->IsSynchronized()) {
+    return NULL;
+  }
+  // Methods of classes that failed verification run with access checks, don't inline them.
+  if (!method->GetDeclaringClass()->IsVerified()) {
+    return NULL;
+  }
+  MethodHelper mh(method);
+  return new DexCompilationUnit(mUnit->GetCompilationUnit(), mUnit->GetClassLoader(),
+                                mUnit->GetClassLinker(), mh.GetDexFile(), mh.GetCodeItem(),
+                                mh.GetClassDefIndex(), method->GetDexMethodIndex(),
+                                method->GetAccessFlags());
+}
+
 bool CompilerDriver::IsSafeCast(const MethodReference& mr, uint32_t dex_pc) {
   bool result = verifier::MethodVerifier::IsSafeCast(mr, dex_pc);
   if (result) {
@@ -188,6 +188,19 @@ class CompilerDriver {
                          uintptr_t& direct_code, uintptr_t& direct_method, bool update_stats)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
+  // Copies the receiver classes the interpreter saw at the invoke at dex_pc into receiver_types,
+  // see interpreter::InlineCacheTable. Returns false if the site is megamorphic or none were seen.
+  bool GetReceiverTypes(const DexCompilationUnit* mUnit, uint32_t dex_pc,
+                        std::vector<mirror::Class*>* receiver_types)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // Returns a new compilation unit, owned by the caller, for an exactly known invoke target, as
+  // computed by ComputeInvokeInfo, when the target is a plain instance method whose body may be
+  // inlined; otherwise NULL. Accesses made by the inlined body are checked against this unit.
+  DexCompilationUnit* GetInlineCandidateUnit(const DexCompilationUnit* mUnit,
+                                             const MethodReference& target_method)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
   bool IsSafeCast(const MethodReference& mr, uint32_t dex_pc);
 
   // Record patch information for later fix up.
@@ -18,22 +18,28 @@
 #define ART_COMPILER_UTILS_DEDUPE_SET_H_
 
 #include <set>
+#include <string>
 
 #include "base/mutex.h"
 #include "base/stl_util.h"
+#include "base/stringprintf.h"
+#include "UniquePtr.h"
 
 namespace art {
 
-// A simple data structure to handle hashed deduplication. Add is thread safe.
-template <typename Key, typename HashType, typename HashFunc>
+// A simple data structure to handle hashed deduplication. Add is thread safe. Keys are spread
+// over kShards independently locked shards by hash, so that threads adding different keys rarely
+// contend.
+template <typename Key, typename HashType, typename HashFunc, HashType kShards = 16>
 class DedupeSet {
   typedef std::pair<HashType, Key*> HashedKey;
 
   class Comparator {
    public:
     bool operator()(const HashedKey& a, const HashedKey& b) const {
-      if (a.first < b.first) return true;
-      if (a.first > b.first) return true;
+      if (a.first != b.first) {
+        return a.first < b.first;
+      }
       return *a.second < *b.second;
     }
   };
@@ -41,39 +47,59 @@ class DedupeSet {
   typedef std::set<HashedKey, Comparator> Keys;
 
  public:
-  typedef typename Keys::iterator iterator;
-  typedef typename Keys::const_iterator const_iterator;
-  typedef typename Keys::size_type size_type;
-  typedef typename Keys::value_type value_type;
-
-  iterator begin() { return keys_.begin(); }
-  const_iterator begin() const { return keys_.begin(); }
-  iterator end() { return keys_.end(); }
-  const_iterator end() const { return keys_.end(); }
-
   Key* Add(Thread* self, const Key& key) {
     HashType hash = HashFunc()(key);
+    // Fold the high bits in as hash functions tend to mix poorly into the low bits.
+    HashType shard = (hash ^ (hash >> 8) ^ (hash >> 16)) % kShards;
     HashedKey hashed_key(hash, const_cast<Key*>(&key));
-    MutexLock lock(self, lock_);
-    auto it = keys_.find(hashed_key);
-    if (it != keys_.end()) {
+    MutexLock lock(self, *lock_[shard]);
+    auto it = keys_[shard].find(hashed_key);
+    if (it != keys_[shard].end()) {
+      ++hits_[shard];
       return it->second;
     }
     hashed_key.second = new Key(key);
-    keys_.insert(hashed_key);
+    keys_[shard].insert(hashed_key);
     return hashed_key.second;
   }
 
-  DedupeSet() : lock_("dedupe lock") {
+  // Returns the number of keys and the number of Adds that found an existing key, per shard.
+  std::string DumpStats(Thread* self) const {
+    std::string result;
+    size_t total_keys = 0;
+    size_t total_hits = 0;
+    for (HashType shard = 0; shard < kShards; ++shard) {
+      MutexLock lock(self, *lock_[shard]);
+      total_keys += keys_[shard].size();
+      total_hits += hits_[shard];
+      StringAppendF(&result, " %zu/%zu", keys_[shard].size(), hits_[shard]);
+    }
+    return StringPrintf("%zu keys, %zu hits, per shard keys/hits:", total_keys, total_hits) +
+        result;
+  }
+
+  explicit DedupeSet(const char* set_name) {
+    for (HashType shard = 0; shard < kShards; ++shard) {
+      lock_name_[shard] = StringPrintf("%s lock %zu", set_name, static_cast<size_t>(shard));
+      lock_[shard].reset(new Mutex(lock_name_[shard].c_str()));
+      hits_[shard] = 0;
+    }
   }
 
   ~DedupeSet() {
-    STLDeleteValues(&keys_);
+    for (HashType shard = 0; shard < kShards; ++shard) {
+      STLDeleteValues(&keys_[shard]);
+    }
   }
 
  private:
-  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  Keys keys_;
+  // Mutex names need to outlive the mutexes.
+  std::string lock_name_[kShards];
+  UniquePtr<Mutex> lock_[kShards];
+  Keys keys_[kShards];
+  // Adds that found an existing key, guarded by the shard's lock.
+  size_t hits_[kShards];
+
   DISALLOW_COPY_AND_ASSIGN(DedupeSet);
 };
 
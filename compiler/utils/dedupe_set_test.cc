@@ -38,7 +38,7 @@ class DedupeHashFunc {
 TEST_F(DedupeSetTest, Test) {
   Thread* self = Thread::Current();
   typedef std::vector<uint8_t> ByteArray;
-  DedupeSet<ByteArray, size_t, DedupeHashFunc> deduplicator;
+  DedupeSet<ByteArray, size_t, DedupeHashFunc> deduplicator("test");
   ByteArray* array1;
   {
     ByteArray test1;
@@ -75,4 +75,40 @@ TEST_F(DedupeSetTest, Test) {
   }
 }
 
+// Puts every key in the same shard with the same hash, so that only the contents tell keys apart.
+class ConstantHashFunc {
+ public:
+  size_t operator()(const std::vector<uint8_t>& /* array */) const {
+    return 42;
+  }
+};
+
+template <typename HashFunc>
+static void TestManyKeys() {
+  Thread* self = Thread::Current();
+  typedef std::vector<uint8_t> ByteArray;
+  DedupeSet<ByteArray, size_t, HashFunc> deduplicator("test");
+  const size_t kNumKeys = 1000;
+  std::vector<ByteArray*> added;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    ByteArray key;
+    key.push_back(i & 0xff);
+    key.push_back(i >> 8);
+    added.push_back(deduplicator.Add(self, key));
+    ASSERT_EQ(key, *added[i]);
+  }
+  // Adding in a different order must find the same keys.
+  for (size_t i = kNumKeys; i-- > 0;) {
+    ByteArray key;
+    key.push_back(i & 0xff);
+    key.push_back(i >> 8);
+    ASSERT_EQ(added[i], deduplicator.Add(self, key));
+  }
+}
+
+TEST_F(DedupeSetTest, ManyKeys) {
+  TestManyKeys<DedupeHashFunc>();
+  TestManyKeys<ConstantHashFunc>();
+}
+
 }  // namespace art
@@ -53,6 +53,7 @@ LIBART_COMMON_SRC_FILES := \
 	gc/collector/mark_sweep.cc \
 	gc/collector/partial_mark_sweep.cc \
 	gc/collector/sticky_mark_sweep.cc \
+	gc/allocation_sampler.cc \
 	gc/heap.cc \
 	gc/space/dlmalloc_space.cc \
 	gc/space/image_space.cc \
@@ -63,6 +64,7 @@ LIBART_COMMON_SRC_FILES := \
 	indirect_reference_table.cc \
 	instrumentation.cc \
 	intern_table.cc \
+	interpreter/inline_cache.cc \
 	interpreter/interpreter.cc \
 	jdwp/jdwp_event.cc \
 	jdwp/jdwp_expand_buf.cc \
@@ -253,6 +255,9 @@ LIBART_CFLAGS :=
 ifeq ($(ART_USE_PORTABLE_COMPILER),true)
   LIBART_CFLAGS += -DART_USE_PORTABLE_COMPILER=1
 endif
+ifeq ($(ART_USE_COMPUTED_GOTO_INTERPRETER),true)
+  LIBART_CFLAGS += -DART_USE_COMPUTED_GOTO_INTERPRETER=1
+endif
 
 # $(1): target or host
 # $(2): ndebug or debug
@@ -64,6 +64,7 @@
 #include "stack_indirect_reference_table.h"
 #include "thread.h"
 #include "UniquePtr.h"
+#include "utf.h"
 #include "utils.h"
 #include "verifier/method_verifier.h"
 #include "well_known_classes.h"
@@ -125,11 +126,7 @@ static void WrapExceptionInInitializer() SHARED_LOCKS_REQUIRED(Locks::mutator_lo
 
 static size_t Hash(const char* s) {
   // This is the java.lang.String hashcode for convenience, not interoperability.
-  size_t hash = 0;
-  for (; *s != '\0'; ++s) {
-    hash = hash * 31 + *s;
-  }
-  return hash;
+  return ComputeModifiedUtf8Hash(s);
 }
 
 const char* ClassLinker::class_roots_descriptors_[] = {
@@ -187,8 +184,7 @@ ClassLinker* ClassLinker::CreateFromImage(InternTable* intern_table) {
 ClassLinker::ClassLinker(InternTable* intern_table)
     // dex_lock_ is recursive as it may be used in stack dumping.
     : dex_lock_("ClassLinker dex lock", kDefaultMutexLevel),
-      dex_cache_image_class_lookup_required_(false),
-      failed_dex_cache_class_lookups_(0),
+      class_table_(true),
       class_roots_(NULL),
       array_iftable_(NULL),
       init_done_(false),
@@ -269,7 +265,7 @@ void ClassLinker::InitFromCompiler(const std::vector<const DexFile*>& boot_class
   SetClassRoot(kPrimitiveVoid, CreatePrimitiveClass(self, Primitive::kPrimVoid));
 
   // Create array interface entries to populate once we can load system classes.
-  array_iftable_ = AllocIfTable(self, 2);
+  array_iftable_ = AllocIfTable(self, 2, false);
 
   // Create int array type for AllocDexCache (done in AppendToBootClassPath).
   SirtRef<mirror::Class> int_array_class(self, AllocClass(self, java_lang_Class.get(), sizeof(mirror::Class)));
@@ -1015,7 +1011,6 @@ void ClassLinker::InitFromImage() {
 
   gc::Heap* heap = Runtime::Current()->GetHeap();
   gc::space::ImageSpace* space = heap->GetImageSpace();
-  dex_cache_image_class_lookup_required_ = true;
   CHECK(space != NULL);
   OatFile& oat_file = GetImageOatFile(space);
   CHECK_EQ(oat_file.GetOatHeader().GetImageFileLocationOatChecksum(), 0U);
@@ -1085,6 +1080,8 @@ void ClassLinker::InitFromImage() {
   mirror::Throwable::SetClass(GetClassRoot(kJavaLangThrowable));
   mirror::StackTraceElement::SetClass(GetClassRoot(kJavaLangStackTraceElement));
 
+  AddImageClassesToClassTable();
+
   FinishInit();
 
   VLOG(startup) << "ClassLinker::InitFromImage exiting";
@@ -1111,9 +1108,11 @@ void ClassLinker::VisitRoots(RootVisitor* visitor, void* arg, bool only_dirty, b
   {
     ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
     if (!only_dirty || class_table_dirty_) {
-      for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-        visitor(it.second, arg);
-      }
+      auto root_visitor = [visitor, arg](mirror::Class* klass) {
+        visitor(klass, arg);
+        return true;
+      };
+      class_table_.Visit(root_visitor);
       if (clean_dirty) {
         class_table_dirty_ = false;
       }
@@ -1127,15 +1126,11 @@ void ClassLinker::VisitRoots(RootVisitor* visitor, void* arg, bool only_dirty, b
 }
 
 void ClassLinker::VisitClasses(ClassVisitor* visitor, void* arg) {
-  if (dex_cache_image_class_lookup_required_) {
-    MoveImageClassesToClassTable();
-  }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-    if (!visitor(it.second, arg)) {
-      return;
-    }
-  }
+  auto class_visitor = [visitor, arg](mirror::Class* klass) {
+    return visitor(klass, arg);
+  };
+  class_table_.Visit(class_visitor);
 }
 
 static bool GetClassesVisitor(mirror::Class* c, void* arg) {
@@ -2207,89 +2202,72 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
   if (existing != NULL) {
     return existing;
   }
-  if (kIsDebugBuild && klass->GetClassLoader() == NULL && dex_cache_image_class_lookup_required_) {
-    // Check a class loaded with the system class loader matches one in the image if the class
-    // is in the image.
-    existing = LookupClassFromImage(descriptor);
-    if (existing != NULL) {
-      CHECK(klass == existing);
-    }
-  }
   Runtime::Current()->GetHeap()->VerifyObject(klass);
-  class_table_.insert(std::make_pair(hash, klass));
+  class_table_.Insert(hash, klass);
   class_table_dirty_ = true;
   return NULL;
 }
 
+// Matches classes with a given descriptor and class loader in the class table.
+class ClassDescriptorMatcher {
+ public:
+  ClassDescriptorMatcher(ClassLinker* class_linker, const char* descriptor,
+                         const mirror::ClassLoader* class_loader)
+      : kh_(NULL, class_linker), descriptor_(descriptor), class_loader_(class_loader) {}
+
+  bool operator()(mirror::Class* klass) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (klass->GetClassLoader() != class_loader_) {
+      return false;
+    }
+    kh_.ChangeClass(klass);
+    return strcmp(descriptor_, kh_.GetDescriptor()) == 0;
+  }
+
+ private:
+  ClassHelper kh_;
+  const char* const descriptor_;
+  const mirror::ClassLoader* const class_loader_;
+};
+
 bool ClassLinker::RemoveClass(const char* descriptor, const mirror::ClassLoader* class_loader) {
   size_t hash = Hash(descriptor);
   WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  ClassHelper kh;
-  for (auto it = class_table_.lower_bound(hash), end = class_table_.end(); it != end && it->first == hash;
-       ++it) {
-    mirror::Class* klass = it->second;
-    kh.ChangeClass(klass);
-    if (strcmp(kh.GetDescriptor(), descriptor) == 0 && klass->GetClassLoader() == class_loader) {
-      class_table_.erase(it);
-      return true;
-    }
-  }
-  return false;
+  ClassDescriptorMatcher matcher(this, descriptor, class_loader);
+  mirror::Class* klass = class_table_.Find(hash, matcher);
+  return klass != NULL && class_table_.Remove(hash, klass);
 }
 
 mirror::Class* ClassLinker::LookupClass(const char* descriptor,
                                         const mirror::ClassLoader* class_loader) {
   size_t hash = Hash(descriptor);
-  {
-    ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-    mirror::Class* result = LookupClassFromTableLocked(descriptor, class_loader, hash);
-    if (result != NULL) {
-      return result;
-    }
-  }
-  if (class_loader != NULL || !dex_cache_image_class_lookup_required_) {
-    return NULL;
-  } else {
-    // Lookup failed but need to search dex_caches_.
-    mirror::Class* result = LookupClassFromImage(descriptor);
-    if (result != NULL) {
-      InsertClass(descriptor, result, hash);
-    } else {
-      // Searching the image dex files/caches failed, we don't want to get into this situation
-      // often as map searches are faster, so after kMaxFailedDexCacheLookups move all image
-      // classes into the class table.
-      const int32_t kMaxFailedDexCacheLookups = 1000;
-      if (++failed_dex_cache_class_lookups_ > kMaxFailedDexCacheLookups) {
-        MoveImageClassesToClassTable();
-      }
-    }
+  // Most lookups find a class, first try without the lock.
+  ClassDescriptorMatcher matcher(this, descriptor, class_loader);
+  mirror::Class* result = class_table_.Find(hash, matcher);
+  if (result != NULL) {
     return result;
   }
+  ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
+  return LookupClassFromTableLocked(descriptor, class_loader, hash);
 }
 
 mirror::Class* ClassLinker::LookupClassFromTableLocked(const char* descriptor,
                                                        const mirror::ClassLoader* class_loader,
                                                        size_t hash) {
-  ClassHelper kh(NULL, this);
-  auto end = class_table_.end();
-  for (auto it = class_table_.lower_bound(hash); it != end && it->first == hash; ++it) {
-    mirror::Class* klass = it->second;
-    kh.ChangeClass(klass);
-    if (klass->GetClassLoader() == class_loader && strcmp(descriptor, kh.GetDescriptor()) == 0) {
-      if (kIsDebugBuild) {
-        // Check for duplicates in the table.
-        for (++it; it != end && it->first == hash; ++it) {
-          mirror::Class* klass2 = it->second;
-          kh.ChangeClass(klass2);
-          CHECK(!(strcmp(descriptor, kh.GetDescriptor()) == 0 && klass2->GetClassLoader() == class_loader))
-          << PrettyClass(klass) << " " << klass << " " << klass->GetClassLoader() << " "
-          << PrettyClass(klass2) << " " << klass2 << " " << klass2->GetClassLoader();
-        }
+  ClassDescriptorMatcher matcher(this, descriptor, class_loader);
+  mirror::Class* klass = class_table_.Find(hash, matcher);
+  if (kIsDebugBuild && klass != NULL) {
+    // Check for duplicates in the table.
+    size_t matches = 0;
+    auto counter = [&matcher, &matches](mirror::Class* klass2) NO_THREAD_SAFETY_ANALYSIS {
+      if (matcher(klass2)) {
+        ++matches;
       }
-      return klass;
-    }
+      return false;
+    };
+    class_table_.Find(hash, counter);
+    CHECK_EQ(matches, 1U) << PrettyClass(klass) << " " << klass << " " << klass->GetClassLoader();
   }
-  return NULL;
+  return klass;
 }
 
 static mirror::ObjectArray<mirror::DexCache>* GetImageDexCaches()
@@ -2300,15 +2278,18 @@ static mirror::ObjectArray<mirror::DexCache>* GetImageDexCaches()
   return root->AsObjectArray<mirror::DexCache>();
 }
 
-void ClassLinker::MoveImageClassesToClassTable() {
+void ClassLinker::AddImageClassesToClassTable() {
   Thread* self = Thread::Current();
   WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
-  if (!dex_cache_image_class_lookup_required_) {
-    return;  // All dex cache classes are already in the class table.
-  }
   const char* old_no_suspend_cause =
-      self->StartAssertNoThreadSuspension("Moving image classes to class table");
+      self->StartAssertNoThreadSuspension("Adding image classes to class table");
   mirror::ObjectArray<mirror::DexCache>* dex_caches = GetImageDexCaches();
+  size_t num_types = 0;
+  for (int32_t i = 0; i < dex_caches->GetLength(); i++) {
+    num_types += dex_caches->Get(i)->GetResolvedTypes()->GetLength();
+  }
+  // Not every type is resolved, but this bounds the growth to at most one step.
+  class_table_.Reserve(num_types);
   ClassHelper kh(NULL, this);
   for (int32_t i = 0; i < dex_caches->GetLength(); i++) {
     mirror::DexCache* dex_cache = dex_caches->Get(i);
@@ -2325,74 +2306,28 @@ void ClassLinker::MoveImageClassesToClassTable() {
           CHECK(existing == klass) << PrettyClassAndClassLoader(existing) << " != "
               << PrettyClassAndClassLoader(klass);
         } else {
-          class_table_.insert(std::make_pair(hash, klass));
+          class_table_.Insert(hash, klass);
         }
       }
     }
   }
   class_table_dirty_ = true;
-  dex_cache_image_class_lookup_required_ = false;
-  self->EndAssertNoThreadSuspension(old_no_suspend_cause);
-}
-
-mirror::Class* ClassLinker::LookupClassFromImage(const char* descriptor) {
-  Thread* self = Thread::Current();
-  const char* old_no_suspend_cause =
-      self->StartAssertNoThreadSuspension("Image class lookup");
-  mirror::ObjectArray<mirror::DexCache>* dex_caches = GetImageDexCaches();
-  for (int32_t i = 0; i < dex_caches->GetLength(); ++i) {
-    mirror::DexCache* dex_cache = dex_caches->Get(i);
-    const DexFile* dex_file = dex_cache->GetDexFile();
-    // First search using the class def map, but don't bother for non-class types.
-    if (descriptor[0] == 'L') {
-      const DexFile::StringId* descriptor_string_id = dex_file->FindStringId(descriptor);
-      if (descriptor_string_id != NULL) {
-        const DexFile::TypeId* type_id =
-            dex_file->FindTypeId(dex_file->GetIndexForStringId(*descriptor_string_id));
-        if (type_id != NULL) {
-          mirror::Class* klass = dex_cache->GetResolvedType(dex_file->GetIndexForTypeId(*type_id));
-          if (klass != NULL) {
-            self->EndAssertNoThreadSuspension(old_no_suspend_cause);
-            return klass;
-          }
-        }
-      }
-    }
-    // Now try binary searching the string/type index.
-    const DexFile::StringId* string_id = dex_file->FindStringId(descriptor);
-    if (string_id != NULL) {
-      const DexFile::TypeId* type_id =
-          dex_file->FindTypeId(dex_file->GetIndexForStringId(*string_id));
-      if (type_id != NULL) {
-        uint16_t type_idx = dex_file->GetIndexForTypeId(*type_id);
-        mirror::Class* klass = dex_cache->GetResolvedType(type_idx);
-        if (klass != NULL) {
-          self->EndAssertNoThreadSuspension(old_no_suspend_cause);
-          return klass;
-        }
-      }
-    }
-  }
   self->EndAssertNoThreadSuspension(old_no_suspend_cause);
-  return NULL;
 }
 
 void ClassLinker::LookupClasses(const char* descriptor, std::vector<mirror::Class*>& result) {
   result.clear();
-  if (dex_cache_image_class_lookup_required_) {
-    MoveImageClassesToClassTable();
-  }
   size_t hash = Hash(descriptor);
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
   ClassHelper kh(NULL, this);
-  for (auto it = class_table_.lower_bound(hash), end = class_table_.end();
-      it != end && it->first == hash; ++it) {
-    mirror::Class* klass = it->second;
+  auto collector = [descriptor, &kh, &result](mirror::Class* klass) NO_THREAD_SAFETY_ANALYSIS {
     kh.ChangeClass(klass);
     if (strcmp(descriptor, kh.GetDescriptor()) == 0) {
       result.push_back(klass);
     }
-  }
+    return false;
+  };
+  class_table_.Find(hash, collector);
 }
 
 void ClassLinker::VerifyClass(mirror::Class* klass) {
@@ -3517,7 +3452,9 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
     }
   }
   Thread* self = Thread::Current();
-  SirtRef<mirror::IfTable> iftable(self, AllocIfTable(self, ifcount));
+  // Interfaces are never receivers of interface dispatch, so only other classes get an IMT.
+  const bool with_imt = !klass->IsInterface();
+  SirtRef<mirror::IfTable> iftable(self, AllocIfTable(self, ifcount, with_imt));
   if (UNLIKELY(iftable.get() == NULL)) {
     CHECK(self->IsExceptionPending());  // OOME.
     return false;
@@ -3572,7 +3509,8 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
   }
   // Shrink iftable in case duplicates were found
   if (idx < ifcount) {
-    iftable.reset(down_cast<mirror::IfTable*>(iftable->CopyOf(self, idx * mirror::IfTable::kMax)));
+    size_t new_length = idx * mirror::IfTable::kMax + (with_imt ? 1 : 0);
+    iftable.reset(down_cast<mirror::IfTable*>(iftable->CopyOf(self, new_length)));
     if (UNLIKELY(iftable.get() == NULL)) {
       CHECK(self->IsExceptionPending());  // OOME.
       return false;
@@ -3699,11 +3637,58 @@ bool ClassLinker::LinkInterfaceMethods(SirtRef<mirror::Class>& klass,
     CHECK(vtable->Get(i) != NULL);
   }
 
+  if (!LinkImTable(iftable.get())) {
+    return false;
+  }
+
 //  klass->DumpClass(std::cerr, Class::kDumpClassFullDetail);
 
   return true;
 }
 
+bool ClassLinker::LinkImTable(mirror::IfTable* iftable) {
+  size_t ifcount = iftable->Count();
+  size_t num_interface_methods = 0;
+  for (size_t i = 0; i < ifcount; ++i) {
+    num_interface_methods += iftable->GetMethodArrayCount(i);
+  }
+  if (num_interface_methods == 0) {
+    // Only marker interfaces, nothing to dispatch.
+    return true;
+  }
+  size_t num_entries = RoundUpToPowerOfTwo(static_cast<uint32_t>(num_interface_methods));
+  if (num_entries > mirror::IfTable::kMaxImTableEntries) {
+    num_entries = mirror::IfTable::kMaxImTableEntries;
+  }
+  Thread* self = Thread::Current();
+  mirror::ObjectArray<mirror::ArtMethod>* imt =
+      AllocArtMethodArray(self, num_entries * mirror::IfTable::kImTableMax);
+  if (UNLIKELY(imt == NULL)) {
+    CHECK(self->IsExceptionPending());  // OOME.
+    return false;
+  }
+  for (size_t i = 0; i < ifcount; ++i) {
+    if (iftable->GetMethodArrayCount(i) == 0) {
+      continue;
+    }
+    mirror::Class* interface = iftable->GetInterface(i);
+    mirror::ObjectArray<mirror::ArtMethod>* method_array = iftable->GetMethodArray(i);
+    for (int32_t j = 0; j < method_array->GetLength(); ++j) {
+      mirror::ArtMethod* interface_method = interface->GetVirtualMethod(j);
+      size_t index = mirror::IfTable::GetImTableIndex(interface_method->GetDexMethodIndex(),
+                                                      imt->GetLength());
+      if (imt->Get(index + mirror::IfTable::kImTableInterfaceMethod) != NULL) {
+        // Keep the first method for the slot, later ones fall back to searching the iftable.
+        continue;
+      }
+      imt->Set(index + mirror::IfTable::kImTableInterfaceMethod, interface_method);
+      imt->Set(index + mirror::IfTable::kImTableImplementation, method_array->Get(j));
+    }
+  }
+  iftable->SetImTable(imt);
+  return true;
+}
+
 bool ClassLinker::LinkInstanceFields(SirtRef<mirror::Class>& klass) {
   CHECK(klass.get() != NULL);
   return LinkFields(klass, false);
@@ -4225,17 +4210,16 @@ const char* ClassLinker::MethodShorty(uint32_t method_idx, mirror::ArtMethod* re
 }
 
 void ClassLinker::DumpAllClasses(int flags) {
-  if (dex_cache_image_class_lookup_required_) {
-    MoveImageClassesToClassTable();
-  }
   // TODO: at the time this was written, it wasn't safe to call PrettyField with the ClassLinker
   // lock held, because it might need to resolve a field's type, which would try to take the lock.
   std::vector<mirror::Class*> all_classes;
   {
     ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-    for (const std::pair<size_t, mirror::Class*>& it : class_table_) {
-      all_classes.push_back(it.second);
-    }
+    auto collector = [&all_classes](mirror::Class* klass) {
+      all_classes.push_back(klass);
+      return true;
+    };
+    class_table_.Visit(collector);
   }
 
   for (size_t i = 0; i < all_classes.size(); ++i) {
@@ -4244,19 +4228,13 @@ void ClassLinker::DumpAllClasses(int flags) {
 }
 
 void ClassLinker::DumpForSigQuit(std::ostream& os) {
-  if (dex_cache_image_class_lookup_required_) {
-    MoveImageClassesToClassTable();
-  }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  os << "Loaded classes: " << class_table_.size() << " allocated classes\n";
+  os << "Loaded classes: " << class_table_.Size() << " allocated classes\n";
 }
 
 size_t ClassLinker::NumLoadedClasses() {
-  if (dex_cache_image_class_lookup_required_) {
-    MoveImageClassesToClassTable();
-  }
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-  return class_table_.size();
+  return class_table_.Size();
 }
 
 pid_t ClassLinker::GetClassesLockOwner() {
@@ -25,6 +25,7 @@
 #include "base/mutex.h"
 #include "dex_file.h"
 #include "gtest/gtest.h"
+#include "open_addressing_table.h"
 #include "root_visitor.h"
 #include "oat_file.h"
 
@@ -296,7 +297,8 @@ class ClassLinker {
   mirror::ObjectArray<mirror::ArtMethod>* AllocArtMethodArray(Thread* self, size_t length)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  mirror::IfTable* AllocIfTable(Thread* self, size_t ifcount)
+  // Allocates an iftable for ifcount interfaces, optionally with a slot for an IMT.
+  mirror::IfTable* AllocIfTable(Thread* self, size_t ifcount, bool with_imt)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   mirror::ObjectArray<mirror::ArtField>* AllocArtFieldArray(Thread* self, size_t length)
@@ -473,6 +475,10 @@ class ClassLinker {
                             mirror::ObjectArray<mirror::Class>* interfaces)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Builds the interface method table of a class from its fully linked iftable.
+  bool LinkImTable(mirror::IfTable* iftable)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   bool LinkStaticFields(SirtRef<mirror::Class>& klass)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   bool LinkInstanceFields(SirtRef<mirror::Class>& klass)
@@ -528,26 +534,20 @@ class ClassLinker {
   std::vector<const OatFile*> oat_files_ GUARDED_BY(dex_lock_);
 
 
-  // multimap from a string hash code of a class descriptor to
-  // mirror::Class* instances. Results should be compared for a matching
-  // Class::descriptor_ and Class::class_loader_.
-  typedef std::multimap<size_t, mirror::Class*> Table;
-  Table class_table_ GUARDED_BY(Locks::classlinker_classes_lock_);
-
-  // Do we need to search dex caches to find image classes?
-  bool dex_cache_image_class_lookup_required_;
-  // Number of times we've searched dex caches for a class. After a certain number of misses we move
-  // the classes into the class_table_ to avoid dex cache based searches.
-  AtomicInteger failed_dex_cache_class_lookups_;
+  // Table from a string hash code of a class descriptor to mirror::Class* instances. Results
+  // should be compared for a matching Class::descriptor_ and Class::class_loader_. Modified with
+  // classlinker_classes_lock_ held exclusively, and also searched without the lock, see
+  // OpenAddressingTable.
+  OpenAddressingTable<mirror::Class> class_table_;
 
   mirror::Class* LookupClassFromTableLocked(const char* descriptor,
                                             const mirror::ClassLoader* class_loader,
                                             size_t hash)
       SHARED_LOCKS_REQUIRED(Locks::classlinker_classes_lock_, Locks::mutator_lock_);
 
-  void MoveImageClassesToClassTable() LOCKS_EXCLUDED(Locks::classlinker_classes_lock_)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  mirror::Class* LookupClassFromImage(const char* descriptor)
+  // Adds the classes of the image's dex caches to the class table so that lookups of image
+  // classes don't need to search the dex caches.
+  void AddImageClassesToClassTable() LOCKS_EXCLUDED(Locks::classlinker_classes_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   // indexes into class_roots_.
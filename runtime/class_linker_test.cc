@@ -971,6 +971,28 @@ TEST_F(ClassLinkerTest, Interfaces) {
   EXPECT_EQ(Aj1, A->FindVirtualMethodForVirtualOrInterface(Jj1));
   EXPECT_EQ(Aj2, A->FindVirtualMethodForVirtualOrInterface(Jj2));
 
+  // Every method cached in A's IMT must agree with the iftable.
+  EXPECT_TRUE(I->GetIfTable() == NULL || I->GetIfTable()->GetImTable() == NULL);
+  mirror::IfTable* iftable = A->GetIfTable();
+  mirror::ObjectArray<mirror::ArtMethod>* imt = iftable->GetImTable();
+  ASSERT_TRUE(imt != NULL);
+  size_t num_cached = 0;
+  for (int32_t i = 0; i < imt->GetLength(); i += mirror::IfTable::kImTableMax) {
+    mirror::ArtMethod* interface_method = imt->Get(i + mirror::IfTable::kImTableInterfaceMethod);
+    if (interface_method == NULL) {
+      continue;
+    }
+    ++num_cached;
+    mirror::ArtMethod* implementation = NULL;
+    for (size_t j = 0; j < iftable->Count(); ++j) {
+      if (iftable->GetInterface(j) == interface_method->GetDeclaringClass()) {
+        implementation = iftable->GetMethodArray(j)->Get(interface_method->GetMethodIndex());
+      }
+    }
+    EXPECT_EQ(implementation, imt->Get(i + mirror::IfTable::kImTableImplementation));
+  }
+  EXPECT_NE(0U, num_cached);
+
   mirror::ArtField* Afoo = A->FindStaticField("foo", "Ljava/lang/String;");
   mirror::ArtField* Bfoo = B->FindStaticField("foo", "Ljava/lang/String;");
   mirror::ArtField* Jfoo = J->FindStaticField("foo", "Ljava/lang/String;");
@@ -1056,4 +1078,16 @@ TEST_F(ClassLinkerTest, ClassRootDescriptors) {
   }
 }
 
+TEST_F(ClassLinkerTest, LookupLoadedClasses) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  ASSERT_TRUE(object != NULL);
+  EXPECT_EQ(object, class_linker_->LookupClass("Ljava/lang/Object;", NULL));
+  std::vector<mirror::Class*> classes;
+  class_linker_->LookupClasses("Ljava/lang/Object;", classes);
+  ASSERT_EQ(1U, classes.size());
+  EXPECT_EQ(object, classes[0]);
+  EXPECT_TRUE(class_linker_->LookupClass("Lno/such/Class;", NULL) == NULL);
+}
+
 }  // namespace art
@@ -27,6 +27,7 @@
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "class_linker.h"
+#include "cutils/atomic-inline.h"
 #include "dex_file-inl.h"
 #include "dex_file_verifier.h"
 #include "globals.h"
@@ -34,6 +35,7 @@
 #include "mirror/art_field-inl.h"
 #include "mirror/art_method-inl.h"
 #include "mirror/string.h"
+#include "open_addressing_table.h"
 #include "os.h"
 #include "safe_map.h"
 #include "thread.h"
@@ -50,9 +52,10 @@ const byte DexFile::kDexMagicVersion[] = { '0', '3', '5', '\0' };
 
 DexFile::ClassPathEntry DexFile::FindInClassPath(const char* descriptor,
                                                  const ClassPath& class_path) {
+  size_t hash = ComputeModifiedUtf8Hash(descriptor);
   for (size_t i = 0; i != class_path.size(); ++i) {
     const DexFile* dex_file = class_path[i];
-    const DexFile::ClassDef* dex_class_def = dex_file->FindClassDef(descriptor);
+    const DexFile::ClassDef* dex_class_def = dex_file->FindClassDef(descriptor, hash);
     if (dex_class_def != NULL) {
       return ClassPathEntry(dex_file, dex_class_def);
     }
@@ -274,6 +277,7 @@ DexFile::~DexFile() {
   // that's only called after DetachCurrentThread, which means there's no JNIEnv. We could
   // re-attach, but cleaning up these global references is not obviously useful. It's not as if
   // the global reference table is otherwise empty!
+  delete class_def_index_;
 }
 
 bool DexFile::Init() {
@@ -331,38 +335,51 @@ uint32_t DexFile::GetVersion() const {
   return atoi(version);
 }
 
-const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor) const {
-  size_t num_class_defs = NumClassDefs();
-  if (num_class_defs == 0) {
-    return NULL;
-  }
-  const StringId* string_id = FindStringId(descriptor);
-  if (string_id == NULL) {
-    return NULL;
+const DexFile::ClassDefIndex* DexFile::GetClassDefIndex() const {
+  const ClassDefIndex* index = class_def_index_;
+  if (UNLIKELY(index == NULL)) {
+    MutexLock mu(Thread::Current(), class_def_index_lock_);
+    index = class_def_index_;
+    if (index == NULL) {
+      // Replaces linear scans of the class defs, which show up in class loading when there are
+      // many dex files on the class path. Built in full before it is published, so it needs no
+      // support for concurrent readers.
+      ClassDefIndex* new_index = new ClassDefIndex(false);
+      size_t num_class_defs = NumClassDefs();
+      new_index->Reserve(num_class_defs);
+      for (size_t i = 0; i < num_class_defs; ++i) {
+        const ClassDef& class_def = GetClassDef(i);
+        new_index->Insert(ComputeModifiedUtf8Hash(GetClassDescriptor(class_def)), &class_def);
+      }
+      index = new_index;
+      // Make the index's contents visible before the index itself.
+      ANDROID_MEMBAR_STORE();
+      class_def_index_ = index;
+    }
   }
-  const TypeId* type_id = FindTypeId(GetIndexForStringId(*string_id));
-  if (type_id == NULL) {
+  return index;
+}
+
+const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor) const {
+  return FindClassDef(descriptor, ComputeModifiedUtf8Hash(descriptor));
+}
+
+const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor, size_t hash) const {
+  DCHECK_EQ(hash, ComputeModifiedUtf8Hash(descriptor));
+  if (NumClassDefs() == 0) {
     return NULL;
   }
-  uint16_t type_idx = GetIndexForTypeId(*type_id);
-  for (size_t i = 0; i < num_class_defs; ++i) {
-    const ClassDef& class_def = GetClassDef(i);
-    if (class_def.class_idx_ == type_idx) {
-      return &class_def;
-    }
-  }
-  return NULL;
+  auto matcher = [this, descriptor](const ClassDef* class_def) {
+    return strcmp(descriptor, GetClassDescriptor(*class_def)) == 0;
+  };
+  return GetClassDefIndex()->Find(hash, matcher);
 }
 
 const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
-  size_t num_class_defs = NumClassDefs();
-  for (size_t i = 0; i < num_class_defs; ++i) {
-    const ClassDef& class_def = GetClassDef(i);
-    if (class_def.class_idx_ == type_idx) {
-      return &class_def;
-    }
-  }
-  return NULL;
+  // Type ids are unique by descriptor, so a class def with this descriptor is for type_idx.
+  const ClassDef* class_def = FindClassDef(StringByTypeIdx(type_idx));
+  DCHECK(class_def == NULL || class_def->class_idx_ == type_idx) << GetLocation();
+  return class_def;
 }
 
 const DexFile::FieldId* DexFile::FindFieldId(const DexFile::TypeId& declaring_klass,
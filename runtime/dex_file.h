@@ -40,6 +40,7 @@ namespace mirror {
   class DexCache;
 }  // namespace mirror
 class ClassLinker;
+template <typename T> class OpenAddressingTable;
 class ZipArchive;
 
 // TODO: move all of the macro functionality into the DexCache class.
@@ -599,6 +600,10 @@ class DexFile {
   // Looks up a class definition by its class descriptor.
   const ClassDef* FindClassDef(const char* descriptor) const;
 
+  // Looks up a class definition by its class descriptor and the descriptor's
+  // ComputeModifiedUtf8Hash, for callers searching several dex files.
+  const ClassDef* FindClassDef(const char* descriptor, size_t hash) const;
+
   // Looks up a class definition by its type index.
   const ClassDef* FindClassDef(uint16_t type_idx) const;
 
@@ -850,7 +855,9 @@ class DexFile {
         field_ids_(0),
         method_ids_(0),
         proto_ids_(0),
-        class_defs_(0) {
+        class_defs_(0),
+        class_def_index_lock_("DEX class def index lock"),
+        class_def_index_(NULL) {
     CHECK(begin_ != NULL) << GetLocation();
     CHECK_GT(size_, 0U) << GetLocation();
   }
@@ -864,6 +871,12 @@ class DexFile {
   // Returns true if the header magic and version numbers are of the expected values.
   bool CheckMagicAndVersion() const;
 
+  // Class defs keyed by descriptor hash.
+  typedef OpenAddressingTable<const ClassDef> ClassDefIndex;
+
+  // Returns the class def index, building it on first use.
+  const ClassDefIndex* GetClassDefIndex() const;
+
   void DecodeDebugInfo0(const CodeItem* code_item, bool is_static, uint32_t method_idx,
       DexDebugNewPositionCb position_cb, DexDebugNewLocalCb local_cb,
       void* context, const byte* stream, LocalInfo* local_in_reg) const;
@@ -910,6 +923,12 @@ class DexFile {
 
   // Points to the base of the class definition list.
   const ClassDef* class_defs_;
+
+  // Guards building the class def index.
+  mutable Mutex class_def_index_lock_;
+
+  // Lazily built index used by FindClassDef, only published once complete.
+  mutable const ClassDefIndex* volatile class_def_index_;
 };
 
 // Iterate over a dex file's ProtoId's paramters
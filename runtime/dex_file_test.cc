@@ -193,6 +193,19 @@ TEST_F(DexFileTest, CreateMethodSignature) {
   }
 }
 
+TEST_F(DexFileTest, FindClassDef) {
+  for (size_t i = 0; i < java_lang_dex_file_->NumClassDefs(); i++) {
+    const DexFile::ClassDef& to_find = java_lang_dex_file_->GetClassDef(i);
+    const char* descriptor = java_lang_dex_file_->GetClassDescriptor(to_find);
+    const DexFile::ClassDef* found = java_lang_dex_file_->FindClassDef(descriptor);
+    ASSERT_TRUE(found != NULL) << "Didn't find class def " << i << ": " << descriptor;
+    EXPECT_EQ(java_lang_dex_file_->GetIndexForClassDef(*found), i);
+    EXPECT_EQ(java_lang_dex_file_->FindClassDef(to_find.class_idx_), found);
+  }
+  EXPECT_TRUE(java_lang_dex_file_->FindClassDef("Ljava/lang/NoSuchClass;") == NULL);
+  EXPECT_TRUE(java_lang_dex_file_->FindClassDef("I") == NULL);
+}
+
 TEST_F(DexFileTest, FindStringId) {
   ScopedObjectAccess soa(Thread::Current());
   const DexFile* raw(OpenTestDexFile("CreateMethodSignature"));
@@ -73,6 +73,34 @@ class AtomicStack {
     return true;
   }
 
+  // Atomically reserves num_slots slots at the back of the stack for the caller to fill in without
+  // further synchronization, returns false if we overflowed the stack. Slots that are never filled
+  // in stay NULL, so users of a stack with reserved slots must skip NULL entries.
+  bool AtomicBumpBack(size_t num_slots, T** start_address, T** end_address) {
+    if (kIsDebugBuild) {
+      debug_is_sorted_ = false;
+    }
+    int32_t index;
+    int32_t new_index;
+    do {
+      index = back_index_;
+      new_index = index + num_slots;
+      if (UNLIKELY(static_cast<size_t>(new_index) > capacity_)) {
+        // Stack overflow.
+        return false;
+      }
+    } while (!back_index_.compare_and_swap(index, new_index));
+    *start_address = begin_ + index;
+    *end_address = begin_ + new_index;
+    if (kIsDebugBuild) {
+      // Reset zeroes the stack and slots are only written once between resets.
+      for (int32_t i = index; i < new_index; ++i) {
+        DCHECK(begin_[i] == NULL) << "i=" << i << " index=" << index << " new_index=" << new_index;
+      }
+    }
+    return true;
+  }
+
   void PushBack(const T& value) {
     if (kIsDebugBuild) {
       debug_is_sorted_ = false;
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ACCOUNTING_CARD_BITMAP_H_
+#define ART_RUNTIME_GC_ACCOUNTING_CARD_BITMAP_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "card_table.h"
+#include "gc_allocator.h"
+#include "globals.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+// One bit per card for the cards covering a range of the heap. Used by the mod-union tables to
+// remember cleared cards, a set bit means the card at that index was dirty.
+class CardBitmap {
+ public:
+  CardBitmap(uintptr_t begin, uintptr_t end) : begin_(RoundDown(begin, CardTable::kCardSize)) {
+    Extend(end);
+  }
+
+  // Grows the covered range so that it ends at or after end. Keeps the bits already set.
+  void Extend(uintptr_t end) {
+    size_t num_cards = (RoundUp(end, CardTable::kCardSize) - begin_) / CardTable::kCardSize;
+    size_t num_words = RoundUp(num_cards, kBitsPerWord) / kBitsPerWord;
+    if (num_words > bits_.size()) {
+      bits_.resize(num_words, 0);
+    }
+  }
+
+  bool HasAddress(uintptr_t addr) const {
+    return addr >= begin_ && CardIndex(addr) < bits_.size() * kBitsPerWord;
+  }
+
+  // Sets the bit of the card holding addr.
+  void Set(uintptr_t addr) {
+    DCHECK(HasAddress(addr)) << reinterpret_cast<void*>(addr);
+    const size_t index = CardIndex(addr);
+    bits_[index / kBitsPerWord] |= BitMask(index);
+  }
+
+  bool Test(uintptr_t addr) const {
+    DCHECK(HasAddress(addr)) << reinterpret_cast<void*>(addr);
+    const size_t index = CardIndex(addr);
+    return (bits_[index / kBitsPerWord] & BitMask(index)) != 0;
+  }
+
+  // Clears every bit, a word at a time.
+  void Clear() {
+    std::fill(bits_.begin(), bits_.end(), 0);
+  }
+
+  // Calls visitor(card_begin) with the first address of every card whose bit is set, in address
+  // order. Skips clear words without looking at their bits.
+  template <typename Visitor>
+  void VisitSetCards(const Visitor& visitor) const {
+    for (size_t i = 0; i < bits_.size(); ++i) {
+      uintptr_t w = bits_[i];
+      if (w != 0) {
+        const uintptr_t word_begin = begin_ + i * kBitsPerWord * CardTable::kCardSize;
+        do {
+          const size_t shift = CTZ(w);
+          visitor(word_begin + shift * CardTable::kCardSize);
+          w &= w - 1;
+        } while (w != 0);
+      }
+    }
+  }
+
+  // Returns the number of set bits.
+  size_t Count() const {
+    size_t count = 0;
+    for (uintptr_t w : bits_) {
+      count += CountOneBits(w);
+    }
+    return count;
+  }
+
+  uintptr_t Begin() const {
+    return begin_;
+  }
+
+ private:
+  size_t CardIndex(uintptr_t addr) const {
+    return (addr - begin_) / CardTable::kCardSize;
+  }
+
+  static uintptr_t BitMask(size_t index) {
+    return static_cast<uintptr_t>(1) << (index % kBitsPerWord);
+  }
+
+  // First address covered by the first card.
+  const uintptr_t begin_;
+
+  std::vector<uintptr_t, GCAllocator<uintptr_t> > bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(CardBitmap);
+};
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ACCOUNTING_CARD_BITMAP_H_
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "card_bitmap.h"
+
+#include "common_test.h"
+#include "globals.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class CardBitmapTest : public CommonTest {
+ public:
+};
+
+TEST_F(CardBitmapTest, SetTestClear) {
+  const uintptr_t heap_begin = 0x10000000;
+  CardBitmap bitmap(heap_begin, heap_begin + 1 * MB);
+  EXPECT_TRUE(bitmap.HasAddress(heap_begin));
+  EXPECT_TRUE(bitmap.HasAddress(heap_begin + 1 * MB - 1));
+  EXPECT_FALSE(bitmap.HasAddress(heap_begin - 1));
+  EXPECT_EQ(0U, bitmap.Count());
+
+  // Any address within a card sets the bit of that card.
+  bitmap.Set(heap_begin + CardTable::kCardSize * 3 + 5);
+  EXPECT_TRUE(bitmap.Test(heap_begin + CardTable::kCardSize * 3));
+  EXPECT_FALSE(bitmap.Test(heap_begin + CardTable::kCardSize * 2));
+  EXPECT_FALSE(bitmap.Test(heap_begin + CardTable::kCardSize * 4));
+  bitmap.Set(heap_begin + CardTable::kCardSize * 3);
+  EXPECT_EQ(1U, bitmap.Count());
+
+  bitmap.Clear();
+  EXPECT_FALSE(bitmap.Test(heap_begin + CardTable::kCardSize * 3));
+  EXPECT_EQ(0U, bitmap.Count());
+}
+
+TEST_F(CardBitmapTest, VisitSetCards) {
+  const uintptr_t heap_begin = 0x10000000;
+  const size_t num_cards = kBitsPerWord * 3 + 7;
+  CardBitmap bitmap(heap_begin, heap_begin + num_cards * CardTable::kCardSize);
+  // Set every third card, including the first and last cards of the words.
+  std::vector<uintptr_t> expected;
+  for (size_t i = 0; i < num_cards; i += 3) {
+    expected.push_back(heap_begin + i * CardTable::kCardSize);
+    bitmap.Set(expected.back());
+  }
+  bitmap.Set(heap_begin + (kBitsPerWord - 1) * CardTable::kCardSize);
+  bitmap.Set(heap_begin + kBitsPerWord * CardTable::kCardSize);
+  expected.push_back(heap_begin + (kBitsPerWord - 1) * CardTable::kCardSize);
+  expected.push_back(heap_begin + kBitsPerWord * CardTable::kCardSize);
+  std::sort(expected.begin(), expected.end());
+  expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+  std::vector<uintptr_t> visited;
+  bitmap.VisitSetCards([&visited](uintptr_t card_begin) {
+    visited.push_back(card_begin);
+  });
+  EXPECT_TRUE(expected == visited);
+  EXPECT_EQ(expected.size(), bitmap.Count());
+}
+
+TEST_F(CardBitmapTest, Extend) {
+  const uintptr_t heap_begin = 0x10000000;
+  CardBitmap bitmap(heap_begin, heap_begin + 4 * KB);
+  bitmap.Set(heap_begin + 2 * KB);
+  EXPECT_FALSE(bitmap.HasAddress(heap_begin + 64 * KB));
+  bitmap.Extend(heap_begin + 64 * KB + 1);
+  EXPECT_TRUE(bitmap.HasAddress(heap_begin + 64 * KB));
+  // Bits set before growing are kept.
+  EXPECT_TRUE(bitmap.Test(heap_begin + 2 * KB));
+  bitmap.Set(heap_begin + 64 * KB);
+  EXPECT_EQ(2U, bitmap.Count());
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
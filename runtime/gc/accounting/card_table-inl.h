@@ -41,6 +41,18 @@ static inline bool byte_cas(byte old_value, byte new_value, byte* address) {
   return success;
 }
 
+// Returns the first word at or after word_cur which has a card that isn't clean, or word_end.
+static inline uintptr_t* SkipCleanWords(uintptr_t* word_cur, uintptr_t* word_end) {
+  // Most cards are clean, so test several words per branch before finding the exact word.
+  while (word_end - word_cur >= 4 && (word_cur[0] | word_cur[1] | word_cur[2] | word_cur[3]) == 0) {
+    word_cur += 4;
+  }
+  while (word_cur < word_end && *word_cur == 0) {
+    ++word_cur;
+  }
+  return word_cur;
+}
+
 template <typename Visitor>
 inline size_t CardTable::Scan(SpaceBitmap* bitmap, byte* scan_begin, byte* scan_end,
                               const Visitor& visitor, const byte minimum_age) const {
@@ -50,60 +62,40 @@ inline size_t CardTable::Scan(SpaceBitmap* bitmap, byte* scan_begin, byte* scan_
   byte* card_end = CardFromAddr(scan_end);
   CheckCardValid(card_cur);
   CheckCardValid(card_end);
+  uintptr_t* word_end = reinterpret_cast<uintptr_t*>(
+      reinterpret_cast<uintptr_t>(card_end) & ~(sizeof(uintptr_t) - 1));
   size_t cards_scanned = 0;
 
-  // Handle any unaligned cards at the start.
-  while (!IsAligned<sizeof(word)>(card_cur) && card_cur < card_end) {
-    if (*card_cur >= minimum_age) {
-      uintptr_t start = reinterpret_cast<uintptr_t>(AddrFromCard(card_cur));
-      bitmap->VisitMarkedRange(start, start + kCardSize, visitor);
-      ++cards_scanned;
-    }
-    ++card_cur;
-  }
-
-  byte* aligned_end = card_end -
-      (reinterpret_cast<uintptr_t>(card_end) & (sizeof(uintptr_t) - 1));
-
-  uintptr_t* word_end = reinterpret_cast<uintptr_t*>(aligned_end);
-  for (uintptr_t* word_cur = reinterpret_cast<uintptr_t*>(card_cur); word_cur < word_end;
-      ++word_cur) {
-    while (LIKELY(*word_cur == 0)) {
-      ++word_cur;
-      if (UNLIKELY(word_cur >= word_end)) {
-        goto exit_for;
-      }
-    }
-
-    // Find the first dirty card.
-    uintptr_t start_word = *word_cur;
-    uintptr_t start = reinterpret_cast<uintptr_t>(AddrFromCard(reinterpret_cast<byte*>(word_cur)));
-    // TODO: Investigate if processing continuous runs of dirty cards with a single bitmap visit is
-    // more efficient.
-    for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
-      if (static_cast<byte>(start_word) >= minimum_age) {
-        auto* card = reinterpret_cast<byte*>(word_cur) + i;
-        DCHECK(*card == static_cast<byte>(start_word) || *card == kCardDirty)
-            << "card " << static_cast<size_t>(*card) << " word " << (start_word & 0xFF);
-        bitmap->VisitMarkedRange(start, start + kCardSize, visitor);
-        ++cards_scanned;
+  // Consecutive cards of at least minimum age are visited with a single bitmap visit of the run
+  // [run_begin, card_cur).
+  byte* run_begin = card_cur;
+  while (card_cur < card_end) {
+    if (run_begin == card_cur && IsAligned<sizeof(uintptr_t)>(card_cur)) {
+      // Not in a run, skip whole words of clean cards.
+      card_cur = reinterpret_cast<byte*>(
+          SkipCleanWords(reinterpret_cast<uintptr_t*>(card_cur), word_end));
+      run_begin = card_cur;
+      if (card_cur >= card_end) {
+        break;
       }
-      start_word >>= 8;
-      start += kCardSize;
     }
-  }
-  exit_for:
-
-  // Handle any unaligned cards at the end.
-  card_cur = reinterpret_cast<byte*>(word_end);
-  while (card_cur < card_end) {
     if (*card_cur >= minimum_age) {
-      uintptr_t start = reinterpret_cast<uintptr_t>(AddrFromCard(card_cur));
-      bitmap->VisitMarkedRange(start, start + kCardSize, visitor);
       ++cards_scanned;
+    } else {
+      if (run_begin != card_cur) {
+        bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(AddrFromCard(run_begin)),
+                                 reinterpret_cast<uintptr_t>(AddrFromCard(card_cur)), visitor);
+      }
+      run_begin = card_cur + 1;
     }
     ++card_cur;
   }
+  if (run_begin != card_cur) {
+    // card_cur may be one past the last card of the table, so compute the end from the last card.
+    bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(AddrFromCard(run_begin)),
+                             reinterpret_cast<uintptr_t>(AddrFromCard(card_cur - 1)) + kCardSize,
+                             visitor);
+  }
 
   return cards_scanned;
 }
@@ -146,7 +138,7 @@ inline void CardTable::ModifyCardsAtomic(byte* scan_begin, byte* scan_end, const
       new_value = visitor(expected);
     } while (expected != new_value && UNLIKELY(!byte_cas(expected, new_value, card_end)));
     if (expected != new_value) {
-      modified(card_cur, expected, new_value);
+      modified(card_end, expected, new_value);
     }
   }
 
@@ -158,6 +150,11 @@ inline void CardTable::ModifyCardsAtomic(byte* scan_begin, byte* scan_end, const
 
   // TODO: Parallelize.
   while (word_cur < word_end) {
+    // Clean cards stay clean, skip over them.
+    word_cur = SkipCleanWords(word_cur, word_end);
+    if (word_cur == word_end) {
+      break;
+    }
     while ((expected_word = *word_cur) != 0) {
       new_word =
           (visitor((expected_word >> 0) & 0xFF) << 0) |
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "card_table.h"
+
+#include "card_table-inl.h"
+#include "common_test.h"
+#include "globals.h"
+#include "space_bitmap-inl.h"
+#include "UniquePtr.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class CardTableTest : public CommonTest {
+ public:
+};
+
+class CollectObjectsVisitor {
+ public:
+  explicit CollectObjectsVisitor(std::vector<const mirror::Object*>* objects)
+      : objects_(objects) {}
+
+  void operator()(const mirror::Object* obj) const {
+    objects_->push_back(obj);
+  }
+
+ private:
+  std::vector<const mirror::Object*>* const objects_;
+};
+
+// Test that scanning visits exactly the marked objects on cards of at least the minimum age,
+// whatever the runs of dirty, aged and clean cards look like.
+TEST_F(CardTableTest, Scan) {
+  byte* heap_begin = reinterpret_cast<byte*>(0x10000000);
+  size_t heap_capacity = 1 * MB;
+  UniquePtr<SpaceBitmap> bitmap(SpaceBitmap::Create("test bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(bitmap.get() != NULL);
+  UniquePtr<CardTable> card_table(CardTable::Create(heap_begin, heap_capacity));
+  ASSERT_TRUE(card_table.get() != NULL);
+
+  // Mark an object every 3 alignment units.
+  const size_t num_cards = 200;
+  for (size_t i = 0; i < num_cards * CardTable::kCardSize; i += 3 * SpaceBitmap::kAlignment) {
+    bitmap->Set(reinterpret_cast<mirror::Object*>(heap_begin + i));
+  }
+  // Dirty and age cards in runs of different lengths, separated by clean stretches.
+  for (size_t i = 0; i < num_cards; ++i) {
+    byte* card = card_table->CardFromAddr(heap_begin + i * CardTable::kCardSize);
+    if ((i % 37) < (i % 5) || i == num_cards - 1) {
+      *card = CardTable::kCardDirty;
+    } else if (i % 11 == 0) {
+      *card = CardTable::kCardDirty - 1;
+    } else {
+      *card = CardTable::kCardClean;
+    }
+  }
+
+  for (byte minimum_age : {CardTable::kCardDirty, static_cast<byte>(CardTable::kCardDirty - 1)}) {
+    std::vector<const mirror::Object*> expected;
+    size_t expected_cards = 0;
+    for (size_t i = 0; i < num_cards; ++i) {
+      byte* card_begin = heap_begin + i * CardTable::kCardSize;
+      if (*card_table->CardFromAddr(card_begin) >= minimum_age) {
+        ++expected_cards;
+        for (byte* addr = card_begin; addr < card_begin + CardTable::kCardSize;
+            addr += SpaceBitmap::kAlignment) {
+          if (bitmap->Test(reinterpret_cast<mirror::Object*>(addr))) {
+            expected.push_back(reinterpret_cast<mirror::Object*>(addr));
+          }
+        }
+      }
+    }
+
+    std::vector<const mirror::Object*> visited;
+    size_t cards_scanned;
+    {
+      Thread* self = Thread::Current();
+      ScopedObjectAccess soa(self);
+      WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+      cards_scanned = card_table->Scan(bitmap.get(), heap_begin,
+                                       heap_begin + num_cards * CardTable::kCardSize,
+                                       CollectObjectsVisitor(&visited), minimum_age);
+    }
+    EXPECT_EQ(expected_cards, cards_scanned);
+    EXPECT_TRUE(expected == visited);
+  }
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
@@ -17,6 +17,7 @@
 #include "mod_union_table.h"
 
 #include "base/stl_util.h"
+#include "card_bitmap.h"
 #include "card_table-inl.h"
 #include "heap_bitmap.h"
 #include "gc/collector/mark_sweep-inl.h"
@@ -36,20 +37,21 @@ namespace art {
 namespace gc {
 namespace accounting {
 
-class ModUnionClearCardSetVisitor {
+class ModUnionClearCardBitmapVisitor {
  public:
-  explicit ModUnionClearCardSetVisitor(ModUnionTable::CardSet* const cleared_cards)
-    : cleared_cards_(cleared_cards) {
+  ModUnionClearCardBitmapVisitor(const CardTable* card_table, CardBitmap* const cleared_cards)
+    : card_table_(card_table), cleared_cards_(cleared_cards) {
   }
 
-  inline void operator()(byte* card, byte expected_value, byte new_value) const {
+  inline void operator()(byte* card, byte expected_value, byte /* new_value */) const {
     if (expected_value == CardTable::kCardDirty) {
-      cleared_cards_->insert(card);
+      cleared_cards_->Set(reinterpret_cast<uintptr_t>(card_table_->AddrFromCard(card)));
     }
   }
 
  private:
-  ModUnionTable::CardSet* const cleared_cards_;
+  const CardTable* const card_table_;
+  CardBitmap* const cleared_cards_;
 };
 
 class ModUnionClearCardVisitor {
@@ -83,9 +85,25 @@ class ModUnionScanImageRootVisitor {
   collector::MarkSweep* const mark_sweep_;
 };
 
-void ModUnionTableReferenceCache::ClearCards(space::ContinuousSpace* space) {
+ModUnionTable::~ModUnionTable() {
+  STLDeleteValues(&cleared_cards_);
+}
+
+void ModUnionTable::ClearCards(space::ContinuousSpace* space) {
   CardTable* card_table = GetHeap()->GetCardTable();
-  ModUnionClearCardSetVisitor visitor(&cleared_cards_);
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(space->Begin());
+  const uintptr_t end = reinterpret_cast<uintptr_t>(space->End());
+  CardBitmap* cleared_cards;
+  auto found = cleared_cards_.find(space);
+  if (found == cleared_cards_.end()) {
+    cleared_cards = new CardBitmap(begin, end);
+    cleared_cards_.Put(space, cleared_cards);
+  } else {
+    cleared_cards = found->second;
+    // The space may have grown since the last time its cards were cleared.
+    cleared_cards->Extend(end);
+  }
+  ModUnionClearCardBitmapVisitor visitor(card_table, cleared_cards);
   // Clear dirty cards in the this space and update the corresponding mod-union bits.
   card_table->ModifyCardsAtomic(space->Begin(), space->End(), AgeCardVisitor(), visitor);
 }
@@ -215,10 +233,11 @@ void ModUnionTableReferenceCache::Verify() {
 void ModUnionTableReferenceCache::Dump(std::ostream& os) {
   CardTable* card_table = heap_->GetCardTable();
   os << "ModUnionTable cleared cards: [";
-  for (byte* card_addr : cleared_cards_) {
-    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card_addr));
-    uintptr_t end = start + CardTable::kCardSize;
-    os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << ",";
+  for (const auto& it : cleared_cards_) {
+    it.second->VisitSetCards([&os](uintptr_t start) {
+      uintptr_t end = start + CardTable::kCardSize;
+      os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << ",";
+    });
   }
   os << "]\nModUnionTable references: [";
   for (const std::pair<const byte*, std::vector<const Object*> >& it : references_) {
@@ -234,35 +253,33 @@ void ModUnionTableReferenceCache::Dump(std::ostream& os) {
 }
 
 void ModUnionTableReferenceCache::Update() {
-  Heap* heap = GetHeap();
-  CardTable* card_table = heap->GetCardTable();
+  CardTable* card_table = GetHeap()->GetCardTable();
 
   std::vector<const Object*> cards_references;
   ModUnionReferenceVisitor visitor(this, &cards_references);
 
-  for (const auto& card : cleared_cards_) {
-    // Clear and re-compute alloc space references associated with this card.
-    cards_references.clear();
-    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
-    uintptr_t end = start + CardTable::kCardSize;
-    auto* space = heap->FindContinuousSpaceFromObject(reinterpret_cast<Object*>(start), false);
-    DCHECK(space != nullptr);
-    SpaceBitmap* live_bitmap = space->GetLiveBitmap();
-    live_bitmap->VisitMarkedRange(start, end, visitor);
-
-    // Update the corresponding references for the card.
-    auto found = references_.find(card);
-    if (found == references_.end()) {
-      if (cards_references.empty()) {
-        // No reason to add empty array.
-        continue;
+  for (const auto& it : cleared_cards_) {
+    SpaceBitmap* live_bitmap = it.first->GetLiveBitmap();
+    it.second->VisitSetCards([&](uintptr_t start) NO_THREAD_SAFETY_ANALYSIS {
+      // Clear and re-compute alloc space references associated with this card.
+      cards_references.clear();
+      live_bitmap->VisitMarkedRange(start, start + CardTable::kCardSize, visitor);
+
+      // Update the corresponding references for the card.
+      const byte* card = card_table->CardFromAddr(reinterpret_cast<void*>(start));
+      auto found = references_.find(card);
+      if (found == references_.end()) {
+        if (cards_references.empty()) {
+          // No reason to add empty array.
+          return;
+        }
+        references_.Put(card, cards_references);
+      } else {
+        found->second = cards_references;
       }
-      references_.Put(card, cards_references);
-    } else {
-      found->second = cards_references;
-    }
+    });
+    it.second->Clear();
   }
-  cleared_cards_.clear();
 }
 
 void ModUnionTableReferenceCache::MarkReferences(collector::MarkSweep* mark_sweep) {
@@ -279,40 +296,25 @@ void ModUnionTableReferenceCache::MarkReferences(collector::MarkSweep* mark_swee
   }
 }
 
-void ModUnionTableCardCache::ClearCards(space::ContinuousSpace* space) {
-  CardTable* card_table = GetHeap()->GetCardTable();
-  ModUnionClearCardSetVisitor visitor(&cleared_cards_);
-  // Clear dirty cards in the this space and update the corresponding mod-union bits.
-  card_table->ModifyCardsAtomic(space->Begin(), space->End(), AgeCardVisitor(), visitor);
-}
-
 // Mark all references to the alloc space(s).
 void ModUnionTableCardCache::MarkReferences(collector::MarkSweep* mark_sweep) {
-  CardTable* card_table = heap_->GetCardTable();
   ModUnionScanImageRootVisitor visitor(mark_sweep);
-  space::ContinuousSpace* space = nullptr;
-  SpaceBitmap* bitmap = nullptr;
-  for (const byte* card_addr : cleared_cards_) {
-    auto start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card_addr));
-    auto end = start + CardTable::kCardSize;
-    auto obj_start = reinterpret_cast<Object*>(start);
-    if (UNLIKELY(space == nullptr || !space->Contains(obj_start))) {
-      space = heap_->FindContinuousSpaceFromObject(obj_start, false);
-      DCHECK(space != nullptr);
-      bitmap = space->GetLiveBitmap();
-      DCHECK(bitmap != nullptr);
-    }
-    bitmap->VisitMarkedRange(start, end, visitor);
+  for (const auto& it : cleared_cards_) {
+    SpaceBitmap* bitmap = it.first->GetLiveBitmap();
+    DCHECK(bitmap != nullptr);
+    it.second->VisitSetCards([bitmap, &visitor](uintptr_t start) NO_THREAD_SAFETY_ANALYSIS {
+      bitmap->VisitMarkedRange(start, start + CardTable::kCardSize, visitor);
+    });
   }
 }
 
 void ModUnionTableCardCache::Dump(std::ostream& os) {
-  CardTable* card_table = heap_->GetCardTable();
   os << "ModUnionTable dirty cards: [";
-  for (const byte* card_addr : cleared_cards_) {
-    auto start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card_addr));
-    auto end = start + CardTable::kCardSize;
-    os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << ",";
+  for (const auto& it : cleared_cards_) {
+    it.second->VisitSetCards([&os](uintptr_t start) {
+      uintptr_t end = start + CardTable::kCardSize;
+      os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << ",";
+    });
   }
   os << "]";
 }
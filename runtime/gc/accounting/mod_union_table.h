@@ -17,11 +17,11 @@
 #ifndef ART_RUNTIME_GC_ACCOUNTING_MOD_UNION_TABLE_H_
 #define ART_RUNTIME_GC_ACCOUNTING_MOD_UNION_TABLE_H_
 
+#include "base/mutex.h"
 #include "gc_allocator.h"
 #include "globals.h"
 #include "safe_map.h"
 
-#include <set>
 #include <vector>
 
 namespace art {
@@ -43,6 +43,7 @@ class Heap;
 
 namespace accounting {
 
+class CardBitmap;
 class SpaceBitmap;
 class HeapBitmap;
 
@@ -50,16 +51,18 @@ class HeapBitmap;
 // cleared between GC phases, reducing the number of dirty cards that need to be scanned.
 class ModUnionTable {
  public:
-  typedef std::set<byte*, std::less<byte*>, GCAllocator<byte*> > CardSet;
+  // Cleared cards, with one bitmap per space whose cards were cleared.
+  typedef SafeMap<space::ContinuousSpace*, CardBitmap*, std::less<space::ContinuousSpace*>,
+      GCAllocator<std::pair<space::ContinuousSpace* const, CardBitmap*> > > CardBitmaps;
 
   explicit ModUnionTable(Heap* heap) : heap_(heap) {}
 
-  virtual ~ModUnionTable() {}
+  virtual ~ModUnionTable();
 
   // Clear cards which map to a memory range of a space. This doesn't immediately update the
   // mod-union table, as updating the mod-union table may have an associated cost, such as
   // determining references to track.
-  virtual void ClearCards(space::ContinuousSpace* space) = 0;
+  void ClearCards(space::ContinuousSpace* space);
 
   // Update the mod-union table using data stored by ClearCards. There may be multiple ClearCards
   // before a call to update, for example, back-to-back sticky GCs.
@@ -82,6 +85,9 @@ class ModUnionTable {
 
  protected:
   Heap* const heap_;
+
+  // Cards which were dirty when ClearCards cleared them.
+  CardBitmaps cleared_cards_;
 };
 
 // Reference caching implementation. Caches references pointing to alloc space(s) for each card.
@@ -90,9 +96,6 @@ class ModUnionTableReferenceCache : public ModUnionTable {
   explicit ModUnionTableReferenceCache(Heap* heap) : ModUnionTable(heap) {}
   virtual ~ModUnionTableReferenceCache() {}
 
-  // Clear and store cards for a space.
-  void ClearCards(space::ContinuousSpace* space);
-
   // Update table based on cleared cards.
   void Update()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
@@ -113,9 +116,6 @@ class ModUnionTableReferenceCache : public ModUnionTable {
   void Dump(std::ostream& os);
 
  protected:
-  // Cleared card array, used to update the mod-union table.
-  ModUnionTable::CardSet cleared_cards_;
-
   // Maps from dirty cards to their corresponding alloc space references.
   SafeMap<const byte*, std::vector<const mirror::Object*>, std::less<const byte*>,
     GCAllocator<std::pair<const byte*, std::vector<const mirror::Object*> > > > references_;
@@ -127,9 +127,6 @@ class ModUnionTableCardCache : public ModUnionTable {
   explicit ModUnionTableCardCache(Heap* heap) : ModUnionTable(heap) {}
   virtual ~ModUnionTableCardCache() {}
 
-  // Clear and store cards for a space.
-  void ClearCards(space::ContinuousSpace* space);
-
   // Nothing to update as all dirty cards were placed into cleared cards during clearing.
   void Update() {}
 
@@ -142,10 +139,6 @@ class ModUnionTableCardCache : public ModUnionTable {
   void Verify() {}
 
   void Dump(std::ostream& os);
-
- protected:
-  // Cleared card array, used to update the mod-union table.
-  CardSet cleared_cards_;
 };
 
 }  // namespace accounting
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+#include "base/stl_util.h"
+#include "cutils/atomic-inline.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "object_utils.h"
+#include "stack.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+bool AllocationSite::operator<(const AllocationSite& other) const {
+  if (klass != other.klass) {
+    return klass < other.klass;
+  }
+  if (depth != other.depth) {
+    return depth < other.depth;
+  }
+  for (size_t i = 0; i < depth; ++i) {
+    if (frames[i].method != other.frames[i].method) {
+      return frames[i].method < other.frames[i].method;
+    }
+    if (frames[i].dex_pc != other.frames[i].dex_pc) {
+      return frames[i].dex_pc < other.frames[i].dex_pc;
+    }
+  }
+  return false;
+}
+
+// A ring of samples written by a single thread without locking and read by whoever holds the
+// sampler's lock.
+class AllocationSampleBuffer {
+ public:
+  // Must be a power of two.
+  static constexpr uint32_t kCapacity = 64;
+
+  struct Sample {
+    AllocationSite site;
+    size_t byte_count;
+  };
+
+  explicit AllocationSampleBuffer(Thread* owner)
+      : head_(0), tail_(0),
+        random_state_(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(owner)) | 1) {
+  }
+
+  // Appends a sample, returns false if the buffer is full. Only called by the owner.
+  bool Push(const AllocationSite& site, size_t byte_count) {
+    const uint32_t head = head_;
+    if (head - tail_ == kCapacity) {
+      return false;
+    }
+    Sample& sample = samples_[head % kCapacity];
+    sample.site = site;
+    sample.byte_count = byte_count;
+    // The consumer reads the sample once it sees the new head.
+    ANDROID_MEMBAR_STORE();
+    head_ = head + 1;
+    return true;
+  }
+
+  // Calls visitor(sample) for every published sample and frees their slots. Callers must hold the
+  // sampler's lock so that there is a single consumer at a time.
+  template <typename Visitor>
+  void Drain(const Visitor& visitor) {
+    const uint32_t head = head_;
+    // Don't read samples older than the head we saw.
+    ANDROID_MEMBAR_FULL();
+    for (uint32_t i = tail_; i != head; ++i) {
+      visitor(samples_[i % kCapacity]);
+    }
+    // Finish reading the samples before the owner may overwrite their slots.
+    ANDROID_MEMBAR_FULL();
+    tail_ = head;
+  }
+
+  // Returns the next value of a xorshift generator, only called by the owner.
+  uint32_t NextRandom() {
+    uint32_t x = random_state_;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random_state_ = x;
+    return x;
+  }
+
+ private:
+  // Index of the next sample the owner writes.
+  volatile uint32_t head_;
+
+  // Index of the oldest sample not yet drained.
+  volatile uint32_t tail_;
+
+  uint32_t random_state_;
+
+  Sample samples_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampleBuffer);
+};
+
+// Records the innermost non-runtime frames of a thread into an allocation site.
+class AllocationSiteVisitor : public StackVisitor {
+ public:
+  AllocationSiteVisitor(Thread* thread, AllocationSite* site)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      : StackVisitor(thread, NULL), site_(site) {
+    site_->depth = 0;
+  }
+
+  bool VisitFrame() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::ArtMethod* m = GetMethod();
+    if (m->IsRuntimeMethod()) {
+      return true;
+    }
+    AllocationSite::Frame& frame = site_->frames[site_->depth];
+    frame.method = m;
+    frame.dex_pc = GetDexPc();
+    return ++site_->depth < AllocationSite::kMaxStackDepth;
+  }
+
+ private:
+  AllocationSite* const site_;
+};
+
+struct AllocationSiteGreater {
+  bool operator()(const std::pair<AllocationSite, AllocationSiteStats>& a,
+                  const std::pair<AllocationSite, AllocationSiteStats>& b) const {
+    return a.second.samples > b.second.samples;
+  }
+};
+
+AllocationSampler::AllocationSampler(size_t sample_interval)
+    : sample_interval_(sample_interval),
+      lock_("allocation sampler lock"),
+      total_samples_(0) {
+}
+
+AllocationSampler::~AllocationSampler() {
+  STLDeleteElements(&buffers_);
+}
+
+size_t AllocationSampler::NextSampleDistance(AllocationSampleBuffer* buffer) const {
+  return sample_interval_ / 2 + buffer->NextRandom() % sample_interval_;
+}
+
+void AllocationSampler::SampleAllocation(Thread* self, mirror::Class* klass, size_t byte_count) {
+  if (!IsEnabled()) {
+    self->SetAllocSampleBytesLeft(std::numeric_limits<size_t>::max());
+    return;
+  }
+  AllocationSampleBuffer* buffer = self->GetAllocationSampleBuffer();
+  if (UNLIKELY(buffer == NULL)) {
+    // First allocation of the thread, start the countdown without sampling.
+    buffer = new AllocationSampleBuffer(self);
+    {
+      MutexLock mu(self, lock_);
+      buffers_.push_back(buffer);
+    }
+    self->SetAllocationSampleBuffer(buffer);
+    self->SetAllocSampleBytesLeft(NextSampleDistance(buffer));
+    return;
+  }
+  AllocationSite site;
+  site.klass = klass;
+  AllocationSiteVisitor visitor(self, &site);
+  visitor.WalkStack();
+  if (!buffer->Push(site, byte_count)) {
+    MutexLock mu(self, lock_);
+    DrainLocked(buffer);
+    CHECK(buffer->Push(site, byte_count));
+  }
+  self->SetAllocSampleBytesLeft(NextSampleDistance(buffer));
+}
+
+void AllocationSampler::ThreadDetached(Thread* thread) {
+  AllocationSampleBuffer* buffer = thread->GetAllocationSampleBuffer();
+  if (buffer == NULL) {
+    return;
+  }
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    DrainLocked(buffer);
+    buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffer));
+  }
+  thread->SetAllocationSampleBuffer(NULL);
+  delete buffer;
+}
+
+void AllocationSampler::DrainLocked(AllocationSampleBuffer* buffer) {
+  buffer->Drain([this](const AllocationSampleBuffer::Sample& sample) NO_THREAD_SAFETY_ANALYSIS {
+    auto it = sites_.find(sample.site);
+    if (it == sites_.end()) {
+      sites_.Put(sample.site, AllocationSiteStats());
+      it = sites_.find(sample.site);
+    }
+    ++it->second.samples;
+    it->second.sampled_bytes += sample.byte_count;
+    ++total_samples_;
+  });
+}
+
+void AllocationSampler::DrainAllLocked() {
+  for (AllocationSampleBuffer* buffer : buffers_) {
+    DrainLocked(buffer);
+  }
+}
+
+void AllocationSampler::GetSites(
+    std::vector<std::pair<AllocationSite, AllocationSiteStats> >* sites) {
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    DrainAllLocked();
+    sites->assign(sites_.begin(), sites_.end());
+  }
+  std::stable_sort(sites->begin(), sites->end(), AllocationSiteGreater());
+}
+
+uint64_t AllocationSampler::GetTotalSamples() {
+  MutexLock mu(Thread::Current(), lock_);
+  DrainAllLocked();
+  return total_samples_;
+}
+
+void AllocationSampler::Reset() {
+  MutexLock mu(Thread::Current(), lock_);
+  // Drop the samples still in the buffers along with the histogram.
+  DrainAllLocked();
+  sites_.clear();
+  total_samples_ = 0;
+}
+
+void AllocationSampler::Dump(std::ostream& os) {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::vector<std::pair<AllocationSite, AllocationSiteStats> > sites;
+  GetSites(&sites);
+  uint64_t total_samples = 0;
+  for (const auto& entry : sites) {
+    total_samples += entry.second.samples;
+  }
+  os << "Allocation sites: " << total_samples << " samples, one every ~"
+     << PrettySize(sample_interval_) << " allocated per thread\n";
+  if (total_samples == 0) {
+    return;
+  }
+  const size_t max_dumped_sites = kMaxDumpedSites;
+  const size_t num_dumped = std::min(sites.size(), max_dumped_sites);
+  for (size_t i = 0; i < num_dumped; ++i) {
+    const AllocationSite& site = sites[i].first;
+    const AllocationSiteStats& stats = sites[i].second;
+    os << "  " << (stats.samples * 100 / total_samples) << "% ~"
+       << PrettySize(stats.samples * sample_interval_) << " " << stats.samples << " samples "
+       << PrettyDescriptor(site.klass) << "\n";
+    for (size_t j = 0; j < site.depth; ++j) {
+      mirror::ArtMethod* m = site.frames[j].method;
+      MethodHelper mh(m);
+      const char* source_file = mh.GetDeclaringClassSourceFile();
+      os << "      at " << PrettyMethod(m, false) << "("
+         << (source_file != NULL ? source_file : "unknown") << ":"
+         << mh.GetLineNumFromDexPC(site.frames[j].dex_pc) << ")\n";
+    }
+  }
+  if (sites.size() > num_dumped) {
+    os << "  ... " << (sites.size() - num_dumped) << " more sites\n";
+  }
+}
+
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <iosfwd>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "globals.h"
+#include "locks.h"
+#include "safe_map.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+  class ArtMethod;
+  class Class;
+}  // namespace mirror
+
+namespace gc {
+
+// Where a sampled allocation happened: the class allocated and the innermost frames of the
+// allocating thread. Classes and methods are never moved or unloaded, so the raw pointers stay
+// valid for the lifetime of the runtime.
+struct AllocationSite {
+  static constexpr size_t kMaxStackDepth = 4;
+
+  struct Frame {
+    mirror::ArtMethod* method;
+    uint32_t dex_pc;
+  };
+
+  mirror::Class* klass;
+  size_t depth;
+  Frame frames[kMaxStackDepth];
+
+  bool operator<(const AllocationSite& other) const;
+};
+
+// What the sampler knows about the allocations made at one site.
+struct AllocationSiteStats {
+  AllocationSiteStats() : samples(0), sampled_bytes(0) {}
+
+  // Number of sampled allocations.
+  uint64_t samples;
+
+  // Total size of the sampled allocations.
+  uint64_t sampled_bytes;
+};
+
+class AllocationSampleBuffer;
+
+// Samples an allocation about every sample interval bytes allocated by each thread and keeps a
+// histogram of the sites the samples were taken at. Each sample stands for about sample interval
+// bytes, so multiplying a site's sample count by the interval estimates how many bytes it
+// allocated.
+//
+// Samples are first appended to a buffer owned by the allocating thread without taking any lock,
+// the buffers are drained into the histogram under lock_ when full and whenever the histogram is
+// read.
+class AllocationSampler {
+ public:
+  static constexpr size_t kDefaultSampleInterval = 512 * KB;
+
+  // A sample_interval of 0 disables sampling.
+  explicit AllocationSampler(size_t sample_interval);
+  ~AllocationSampler();
+
+  bool IsEnabled() const {
+    return sample_interval_ != 0;
+  }
+
+  size_t GetSampleInterval() const {
+    return sample_interval_;
+  }
+
+  // Called by Heap::AllocObject when self's sampling countdown ran out, records the allocation and
+  // restarts the countdown.
+  void SampleAllocation(Thread* self, mirror::Class* klass, size_t byte_count)
+      LOCKS_EXCLUDED(lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Moves the samples of thread into the histogram and frees its buffer. Called by the thread
+  // itself when it is destroyed.
+  void ThreadDetached(Thread* thread) LOCKS_EXCLUDED(lock_);
+
+  // Returns the sampled sites ordered by decreasing number of samples.
+  void GetSites(std::vector<std::pair<AllocationSite, AllocationSiteStats> >* sites)
+      LOCKS_EXCLUDED(lock_);
+
+  // Returns the number of samples taken so far.
+  uint64_t GetTotalSamples() LOCKS_EXCLUDED(lock_);
+
+  // Forgets all samples taken so far.
+  void Reset() LOCKS_EXCLUDED(lock_);
+
+  // Prints the sites that allocated the most, used for SIGQUIT.
+  void Dump(std::ostream& os)
+      LOCKS_EXCLUDED(lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+ private:
+  // Number of sites printed by Dump.
+  static constexpr size_t kMaxDumpedSites = 20;
+
+  // Returns the next countdown, uniformly distributed around the sample interval so that
+  // allocation patterns repeating with a period of the interval don't bias the samples.
+  size_t NextSampleDistance(AllocationSampleBuffer* buffer) const;
+
+  void DrainLocked(AllocationSampleBuffer* buffer) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void DrainAllLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t sample_interval_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+
+  // The buffers of all threads that took a sample.
+  std::vector<AllocationSampleBuffer*> buffers_ GUARDED_BY(lock_);
+
+  SafeMap<AllocationSite, AllocationSiteStats> sites_ GUARDED_BY(lock_);
+
+  uint64_t total_samples_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
@@ -72,7 +72,7 @@ class GarbageCollector {
     return cumulative_timings_;
   }
 
-  void ResetCumulativeStatistics();
+  virtual void ResetCumulativeStatistics();
 
   // Swap the live and mark bitmaps of spaces that are active for the collector. For partial GC,
   // this is the allocation space, for full GC then we swap the zygote bitmaps too.
@@ -26,6 +26,7 @@
 #include "base/macros.h"
 #include "base/mutex-inl.h"
 #include "base/timing_logger.h"
+#include "class_linker.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap.h"
 #include "gc/accounting/space_bitmap-inl.h"
@@ -74,6 +75,12 @@ constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 constexpr size_t kMinimumParallelMarkStackSize = 128;
 constexpr bool kParallelProcessMarkStack = true;
+constexpr bool kParallelSweep = true;
+// Alloc spaces with less than this many bytes in use are swept by the GC thread alone.
+constexpr size_t kMinimumParallelSweepSize = 4 * MB;
+constexpr bool kParallelReferenceProcessing = true;
+// Reference lists with fewer references than this are cleared by the GC thread alone.
+constexpr size_t kMinimumParallelReferenceCount = 1024;
 
 // Profiling and information flags.
 constexpr bool kCountClassesMarked = false;
@@ -142,6 +149,7 @@ MarkSweep::MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_pre
       finalizer_reference_list_(NULL),
       phantom_reference_list_(NULL),
       cleared_reference_list_(NULL),
+      total_reference_stats_(),
       gc_barrier_(new Barrier(0)),
       large_object_lock_("mark sweep large object lock", kMarkSweepLargeObjectLock),
       mark_stack_lock_("mark sweep mark stack lock", kMarkSweepMarkStackLock),
@@ -196,6 +204,12 @@ bool MarkSweep::HandleDirtyObjectsPhase() {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertExclusiveHeld(self);
 
+  // All mutators are suspended, so their allocation caches can be handed back to the alloc space.
+  {
+    base::TimingLogger::ScopedSplit split("RevokeAllThreadLocalBuffers", &timings_);
+    GetHeap()->RevokeAllThreadLocalBuffers();
+  }
+
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
 
@@ -214,6 +228,8 @@ bool MarkSweep::HandleDirtyObjectsPhase() {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
     // This second sweep makes sure that we don't have any objects in the live stack which point to
     // freed objects. These cause problems since their references may be previously freed objects.
+    // Sweeping resets the allocation stack, so threads must reserve new segments of it.
+    GetHeap()->RevokeAllThreadLocalAllocationStacks();
     SweepArray(GetHeap()->allocation_stack_.get(), false);
   }
 
@@ -252,6 +268,14 @@ void MarkSweep::MarkingPhase() {
   timings_.NewSplit("SwapStacks");
   heap_->SwapStacks();
 
+  if (Locks::mutator_lock_->IsExclusiveHeld(self)) {
+    base::TimingLogger::ScopedSplit split("RevokeAllThreadLocalBuffers", &timings_);
+    GetHeap()->RevokeAllThreadLocalBuffers();
+    // The threads' segments are in what is now the live stack. When mutators are running, each
+    // thread drops its segment at the root marking checkpoint instead.
+    GetHeap()->RevokeAllThreadLocalAllocationStacks();
+  }
+
   WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
   if (Locks::mutator_lock_->IsExclusiveHeld(self)) {
     // If we exclusively hold the mutator lock, all threads must be suspended.
@@ -561,10 +585,132 @@ void MarkSweep::VerifyRoots() {
   Runtime::Current()->GetThreadList()->VerifyRoots(VerifyRootCallback, this);
 }
 
+// Marks roots from any thread. Newly marked roots are collected locally and handed to the shared
+// mark stack kMaxSize at a time, so that parallel root markers rarely take mark_stack_lock_.
+class ParallelRootMarker {
+ public:
+  explicit ParallelRootMarker(MarkSweep* mark_sweep) : mark_sweep_(mark_sweep), num_roots_(0) {}
+
+  ~ParallelRootMarker() {
+    Flush();
+  }
+
+  static void MarkRootCallback(const Object* root, void* arg) {
+    DCHECK(root != NULL);
+    reinterpret_cast<ParallelRootMarker*>(arg)->MarkRoot(root);
+  }
+
+  void Flush() {
+    if (num_roots_ != 0) {
+      mark_sweep_->PushOnMarkStackParallel(roots_, num_roots_);
+      num_roots_ = 0;
+    }
+  }
+
+ private:
+  static const size_t kMaxSize = 256;
+
+  void MarkRoot(const Object* root) ALWAYS_INLINE {
+    if (mark_sweep_->MarkObjectParallel(root)) {
+      if (UNLIKELY(num_roots_ == kMaxSize)) {
+        Flush();
+      }
+      roots_[num_roots_++] = root;
+    }
+  }
+
+  MarkSweep* const mark_sweep_;
+  const Object* roots_[kMaxSize];
+  size_t num_roots_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelRootMarker);
+};
+
+// Marks one root set on the heap thread pool.
+class MarkRootsTask : public Task {
+ public:
+  enum RootSet {
+    kThreadRoots,       // The stack, SIRT and local references of thread_.
+    kNonThreadRoots,    // JNI globals and the runtime's own roots.
+    kInternTableRoots,
+    kClassLinkerRoots,
+  };
+
+  MarkRootsTask(MarkSweep* mark_sweep, RootSet root_set, Thread* thread)
+      : mark_sweep_(mark_sweep), root_set_(root_set), thread_(thread) {
+    DCHECK_EQ(root_set == kThreadRoots, thread != NULL);
+  }
+
+ protected:
+  virtual void Run(Thread* /* self */) NO_THREAD_SAFETY_ANALYSIS {
+    ParallelRootMarker marker(mark_sweep_);
+    Runtime* runtime = Runtime::Current();
+    switch (root_set_) {
+      case kThreadRoots:
+        thread_->VisitRoots(ParallelRootMarker::MarkRootCallback, &marker);
+        break;
+      case kNonThreadRoots:
+        runtime->VisitNonThreadRoots(ParallelRootMarker::MarkRootCallback, &marker);
+        break;
+      case kInternTableRoots:
+        runtime->GetInternTable()->VisitRoots(ParallelRootMarker::MarkRootCallback, &marker, false,
+                                              true);
+        break;
+      case kClassLinkerRoots:
+        runtime->GetClassLinker()->VisitRoots(ParallelRootMarker::MarkRootCallback, &marker, false,
+                                              true);
+        break;
+    }
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  MarkSweep* const mark_sweep_;
+  const RootSet root_set_;
+  Thread* const thread_;
+};
+
+void MarkSweep::PushOnMarkStackParallel(const Object** objs, size_t count) {
+  MutexLock mu(Thread::Current(), mark_stack_lock_);
+  for (size_t i = 0; i < count; ++i) {
+    if (UNLIKELY(mark_stack_->Size() >= mark_stack_->Capacity())) {
+      ExpandMarkStack();
+    }
+    mark_stack_->PushBack(const_cast<Object*>(objs[i]));
+  }
+}
+
+void MarkSweep::RunMarkRootsTasks(Thread* self, size_t thread_count) {
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  // Let the workers mark while we hold the heap bitmap lock on their behalf, as for card scanning.
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 // Marks all objects in the root set.
 void MarkSweep::MarkRoots() {
   timings_.StartSplit("MarkRoots");
-  Runtime::Current()->VisitNonConcurrentRoots(MarkObjectCallback, this);
+  Thread* self = Thread::Current();
+  const size_t thread_count = GetThreadCount(true);
+  if (thread_count > 1) {
+    // All other threads are suspended, scan one thread per task.
+    ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+    thread_pool->AddTask(self, new MarkRootsTask(this, MarkRootsTask::kNonThreadRoots, NULL));
+    {
+      MutexLock mu(self, *Locks::thread_list_lock_);
+      for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+        thread_pool->AddTask(self, new MarkRootsTask(this, MarkRootsTask::kThreadRoots, thread));
+      }
+    }
+    RunMarkRootsTasks(self, thread_count);
+  } else {
+    Runtime::Current()->VisitNonConcurrentRoots(MarkObjectCallback, this);
+  }
   timings_.EndSplit();
 }
 
@@ -576,8 +722,17 @@ void MarkSweep::MarkNonThreadRoots() {
 
 void MarkSweep::MarkConcurrentRoots() {
   timings_.StartSplit("MarkConcurrentRoots");
+  Thread* self = Thread::Current();
+  const size_t thread_count = GetThreadCount(Locks::mutator_lock_->IsExclusiveHeld(self));
   // Visit all runtime roots and clear dirty flags.
-  Runtime::Current()->VisitConcurrentRoots(MarkObjectCallback, this, false, true);
+  if (thread_count > 1) {
+    ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+    thread_pool->AddTask(self, new MarkRootsTask(this, MarkRootsTask::kClassLinkerRoots, NULL));
+    thread_pool->AddTask(self, new MarkRootsTask(this, MarkRootsTask::kInternTableRoots, NULL));
+    RunMarkRootsTasks(self, thread_count);
+  } else {
+    Runtime::Current()->VisitConcurrentRoots(MarkObjectCallback, this, false, true);
+  }
   timings_.EndSplit();
 }
 
@@ -1081,7 +1236,12 @@ class CheckpointMarkThreadRoots : public Closure {
     Thread* self = Thread::Current();
     CHECK(thread == self || thread->IsSuspended() || thread->GetState() == kWaitingPerformingGc)
         << thread->GetState() << " thread " << thread << " self " << self;
-    thread->VisitRoots(MarkSweep::MarkRootParallelCallback, mark_sweep_);
+    {
+      ParallelRootMarker marker(mark_sweep_);
+      thread->VisitRoots(ParallelRootMarker::MarkRootCallback, &marker);
+    }
+    // The stacks were swapped, stop the thread from pushing on the live stack.
+    mark_sweep_->GetHeap()->RevokeThreadLocalAllocationStack(thread);
     ATRACE_END();
     mark_sweep_->GetBarrier().Pass(self);
   }
@@ -1140,6 +1300,95 @@ void MarkSweep::ZygoteSweepCallback(size_t num_ptrs, Object** ptrs, void* arg) {
   }
 }
 
+// Sweeps part of an alloc space, batching the garbage into FreeList calls of up to
+// kSweepArrayChunkFreeSize objects so that parallel sweepers rarely contend on the space lock.
+class SweepTask : public Task {
+ public:
+  SweepTask(space::AllocSpace* space, accounting::SpaceBitmap* live_bitmap,
+            accounting::SpaceBitmap* mark_bitmap, uintptr_t begin, uintptr_t end)
+      : space_(space), live_bitmap_(live_bitmap), mark_bitmap_(mark_bitmap), begin_(begin),
+        end_(end), self_(NULL), freed_objects_(0), freed_bytes_(0) {
+    free_list_.reserve(kSweepArrayChunkFreeSize);
+  }
+
+  // The GC thread holds the heap bitmap lock exclusively while it waits for the sweep tasks.
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    self_ = self;
+    accounting::SpaceBitmap::SweepWalk(*live_bitmap_, *mark_bitmap_, begin_, end_,
+                                       &SweepWalkCallback, this);
+    FreeGarbage();
+  }
+
+  size_t GetFreedObjects() const {
+    return freed_objects_;
+  }
+
+  size_t GetFreedBytes() const {
+    return freed_bytes_;
+  }
+
+ private:
+  static void SweepWalkCallback(size_t num_ptrs, Object** ptrs, void* arg) {
+    SweepTask* task = reinterpret_cast<SweepTask*>(arg);
+    task->free_list_.insert(task->free_list_.end(), ptrs, ptrs + num_ptrs);
+    if (task->free_list_.size() >= kSweepArrayChunkFreeSize) {
+      task->FreeGarbage();
+    }
+  }
+
+  void FreeGarbage() {
+    if (!free_list_.empty()) {
+      freed_objects_ += free_list_.size();
+      freed_bytes_ += space_->FreeList(self_, free_list_.size(), &free_list_[0]);
+      free_list_.clear();
+    }
+  }
+
+  space::AllocSpace* const space_;
+  accounting::SpaceBitmap* const live_bitmap_;
+  accounting::SpaceBitmap* const mark_bitmap_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+  Thread* self_;
+  std::vector<Object*> free_list_;
+  size_t freed_objects_;
+  size_t freed_bytes_;
+};
+
+void MarkSweep::SweepAllocSpaceParallel(space::AllocSpace* space,
+                                        accounting::SpaceBitmap* live_bitmap,
+                                        accounting::SpaceBitmap* mark_bitmap,
+                                        uintptr_t begin, uintptr_t end, size_t thread_count) {
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  // Chunks must start on bitmap word boundaries, otherwise two tasks would free the objects of
+  // a shared word.
+  const size_t chunk_alignment = accounting::SpaceBitmap::kAlignment * kBitsPerWord;
+  DCHECK_ALIGNED(begin, chunk_alignment);
+  const size_t chunk_size = RoundUp((end - begin) / (thread_count * 2) + 1, chunk_alignment);
+  std::vector<SweepTask*> tasks;
+  for (uintptr_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+    uintptr_t chunk_end = std::min(chunk_begin + chunk_size, end);
+    tasks.push_back(new SweepTask(space, live_bitmap, mark_bitmap, chunk_begin, chunk_end));
+    thread_pool->AddTask(self, tasks.back());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+
+  size_t freed_objects = 0;
+  size_t freed_bytes = 0;
+  for (SweepTask* task : tasks) {
+    freed_objects += task->GetFreedObjects();
+    freed_bytes += task->GetFreedBytes();
+    delete task;
+  }
+  heap_->RecordFree(freed_objects, freed_bytes);
+  freed_objects_.fetch_add(freed_objects);
+  freed_bytes_.fetch_add(freed_bytes);
+}
+
 void MarkSweep::SweepArray(accounting::ObjectStack* allocations, bool swap_bitmaps) {
   space::DlMallocSpace* space = heap_->GetAllocSpace();
   timings_.StartSplit("SweepArray");
@@ -1168,6 +1417,10 @@ void MarkSweep::SweepArray(accounting::ObjectStack* allocations, bool swap_bitma
   Thread* self = Thread::Current();
   for (size_t i = 0; i < count; ++i) {
     Object* obj = objects[i];
+    if (obj == NULL) {
+      // An unused slot of a thread's allocation stack segment.
+      continue;
+    }
     // There should only be objects in the AllocSpace/LargeObjectSpace in the allocation stack.
     if (LIKELY(mark_bitmap->HasAddress(obj))) {
       if (!mark_bitmap->Test(obj)) {
@@ -1226,6 +1479,7 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
   SweepCallbackContext scc;
   scc.mark_sweep = this;
   scc.self = Thread::Current();
+  const size_t thread_count = GetThreadCount(!IsConcurrent());
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     // We always sweep always collect spaces.
     bool sweep_space = (space->GetGcRetentionPolicy() == space::kGcRetentionPolicyAlwaysCollect);
@@ -1245,8 +1499,13 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
       if (!space->IsZygoteSpace()) {
         base::TimingLogger::ScopedSplit split("SweepAllocSpace", &timings_);
         // Bitmaps are pre-swapped for optimization which enables sweeping with the heap unlocked.
-        accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
-                                           &SweepCallback, reinterpret_cast<void*>(&scc));
+        if (kParallelSweep && thread_count > 1 &&
+            scc.space->GetBytesAllocated() >= kMinimumParallelSweepSize) {
+          SweepAllocSpaceParallel(scc.space, live_bitmap, mark_bitmap, begin, end, thread_count);
+        } else {
+          accounting::SpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin, end,
+                                             &SweepCallback, reinterpret_cast<void*>(&scc));
+        }
       } else {
         base::TimingLogger::ScopedSplit split("SweepZygote", &timings_);
         // Zygote sweep takes care of dirtying cards and clearing live bits, does not free actual
@@ -1470,11 +1729,13 @@ void MarkSweep::PreserveSomeSoftReferences(Object** list) {
   DCHECK(mark_stack_->IsEmpty());
 
   timings_.StartSplit("PreserveSomeSoftReferences");
+  const uint64_t start_time = NanoTime();
   while (*list != NULL) {
     Object* ref = heap_->DequeuePendingReference(list);
     Object* referent = heap_->GetReferenceReferent(ref);
     if (referent == NULL) {
       // Referent was cleared by the user during marking.
+      ++total_reference_stats_[kSoftReference].processed;
       continue;
     }
     bool is_marked = IsMarked(referent);
@@ -1486,6 +1747,9 @@ void MarkSweep::PreserveSomeSoftReferences(Object** list) {
     if (!is_marked) {
       // Referent is white, queue it for clearing.
       heap_->EnqueuePendingReference(ref, &clear);
+    } else {
+      // Preserved references are done, the ones queued for clearing get counted when cleared.
+      ++total_reference_stats_[kSoftReference].processed;
     }
   }
   *list = clear;
@@ -1493,6 +1757,7 @@ void MarkSweep::PreserveSomeSoftReferences(Object** list) {
 
   // Restart the mark with the newly black references added to the root set.
   ProcessMarkStack(true);
+  total_reference_stats_[kSoftReference].time_ns += NanoTime() - start_time;
 }
 
 inline bool MarkSweep::IsMarked(const Object* object) const
@@ -1507,22 +1772,112 @@ inline bool MarkSweep::IsMarked(const Object* object) const
   return heap_->GetMarkBitmap()->Test(object);
 }
 
-// Unlink the reference list clearing references objects with white
-// referents.  Cleared references registered to a reference queue are
-// scheduled for appending by the heap worker thread.
-void MarkSweep::ClearWhiteReferences(Object** list) {
-  DCHECK(list != NULL);
-  while (*list != NULL) {
-    Object* ref = heap_->DequeuePendingReference(list);
+// Clears white referents for a slice of a reference list.
+class ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(MarkSweep* mark_sweep, Object** begin, Object** end)
+      : mark_sweep_(mark_sweep), begin_(begin), end_(end), cleared_count_(0) {
+  }
+
+  // The GC thread holds the heap bitmap lock while it waits for the tasks.
+  virtual void Run(Thread* /* self */) NO_THREAD_SAFETY_ANALYSIS {
+    cleared_count_ = mark_sweep_->ClearWhiteReferents(begin_, end_, &enqueuable_);
+  }
+
+  const std::vector<Object*>& GetEnqueuable() const {
+    return enqueuable_;
+  }
+
+  size_t GetClearedCount() const {
+    return cleared_count_;
+  }
+
+ private:
+  MarkSweep* const mark_sweep_;
+  Object** const begin_;
+  Object** const end_;
+  std::vector<Object*> enqueuable_;
+  size_t cleared_count_;
+};
+
+size_t MarkSweep::ClearWhiteReferents(Object** begin, Object** end,
+                                      std::vector<Object*>* enqueuable) {
+  size_t cleared_count = 0;
+  for (Object** it = begin; it != end; ++it) {
+    Object* ref = *it;
     Object* referent = heap_->GetReferenceReferent(ref);
     if (referent != NULL && !IsMarked(referent)) {
       // Referent is white, clear it.
       heap_->ClearReferenceReferent(ref);
+      ++cleared_count;
       if (heap_->IsEnqueuable(ref)) {
-        heap_->EnqueueReference(ref, &cleared_reference_list_);
+        enqueuable->push_back(ref);
       }
     }
   }
+  return cleared_count;
+}
+
+size_t MarkSweep::ClearWhiteReferentsParallel(std::vector<Object*>* references,
+                                              std::vector<Object*>* enqueuable,
+                                              size_t thread_count) {
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  const size_t chunk_size = references->size() / (thread_count * 2) + 1;
+  std::vector<ClearWhiteReferencesTask*> tasks;
+  Object** const end = &(*references)[0] + references->size();
+  for (Object** it = &(*references)[0]; it < end; it += chunk_size) {
+    Object** chunk_end = it + std::min(static_cast<size_t>(end - it), chunk_size);
+    tasks.push_back(new ClearWhiteReferencesTask(this, it, chunk_end));
+    thread_pool->AddTask(self, tasks.back());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+
+  // Enqueue in list order, as the serial path does.
+  size_t cleared_count = 0;
+  for (ClearWhiteReferencesTask* task : tasks) {
+    const std::vector<Object*>& task_enqueuable = task->GetEnqueuable();
+    enqueuable->insert(enqueuable->end(), task_enqueuable.begin(), task_enqueuable.end());
+    cleared_count += task->GetClearedCount();
+    delete task;
+  }
+  return cleared_count;
+}
+
+// Unlink the reference list clearing references objects with white
+// referents.  Cleared references registered to a reference queue are
+// scheduled for appending by the heap worker thread.
+void MarkSweep::ClearWhiteReferences(Object** list, ReferenceKind kind) {
+  DCHECK(list != NULL);
+  if (*list == NULL) {
+    return;
+  }
+  const uint64_t start_time = NanoTime();
+  // Unlinking is serial, clearing the referents of long lists is split across the thread pool.
+  std::vector<Object*> references;
+  while (*list != NULL) {
+    references.push_back(heap_->DequeuePendingReference(list));
+  }
+  std::vector<Object*> enqueuable;
+  size_t cleared_count;
+  const size_t thread_count = GetThreadCount(true);
+  if (kParallelReferenceProcessing && thread_count > 1 &&
+      references.size() >= kMinimumParallelReferenceCount) {
+    cleared_count = ClearWhiteReferentsParallel(&references, &enqueuable, thread_count);
+  } else {
+    cleared_count = ClearWhiteReferents(&references[0], &references[0] + references.size(),
+                                        &enqueuable);
+  }
+  for (Object* ref : enqueuable) {
+    heap_->EnqueueReference(ref, &cleared_reference_list_);
+  }
+  ReferenceStats& stats = total_reference_stats_[kind];
+  stats.processed += references.size();
+  stats.cleared += cleared_count;
+  stats.time_ns += NanoTime() - start_time;
   DCHECK(*list == NULL);
 }
 
@@ -1532,12 +1887,16 @@ void MarkSweep::ClearWhiteReferences(Object** list) {
 void MarkSweep::EnqueueFinalizerReferences(Object** list) {
   DCHECK(list != NULL);
   timings_.StartSplit("EnqueueFinalizerReferences");
+  const uint64_t start_time = NanoTime();
+  ReferenceStats& stats = total_reference_stats_[kFinalizerReference];
   MemberOffset zombie_offset = heap_->GetFinalizerReferenceZombieOffset();
   bool has_enqueued = false;
   while (*list != NULL) {
     Object* ref = heap_->DequeuePendingReference(list);
+    ++stats.processed;
     Object* referent = heap_->GetReferenceReferent(ref);
     if (referent != NULL && !IsMarked(referent)) {
+      ++stats.cleared;
       MarkObject(referent);
       // If the referent is non-null the reference must queuable.
       DCHECK(heap_->IsEnqueuable(ref));
@@ -1551,6 +1910,7 @@ void MarkSweep::EnqueueFinalizerReferences(Object** list) {
   if (has_enqueued) {
     ProcessMarkStack(true);
   }
+  stats.time_ns += NanoTime() - start_time;
   DCHECK(*list == NULL);
 }
 
@@ -1574,8 +1934,8 @@ void MarkSweep::ProcessReferences(Object** soft_references, bool clear_soft,
   timings_.StartSplit("ProcessReferences");
   // Clear all remaining soft and weak references with white
   // referents.
-  ClearWhiteReferences(soft_references);
-  ClearWhiteReferences(weak_references);
+  ClearWhiteReferences(soft_references, kSoftReference);
+  ClearWhiteReferences(weak_references, kWeakReference);
   timings_.EndSplit();
 
   // Preserve all white objects with finalize methods and schedule
@@ -1585,11 +1945,11 @@ void MarkSweep::ProcessReferences(Object** soft_references, bool clear_soft,
   timings_.StartSplit("ProcessReferences");
   // Clear all f-reachable soft and weak references with white
   // referents.
-  ClearWhiteReferences(soft_references);
-  ClearWhiteReferences(weak_references);
+  ClearWhiteReferences(soft_references, kSoftReference);
+  ClearWhiteReferences(weak_references, kWeakReference);
 
   // Clear all phantom references with white referents.
-  ClearWhiteReferences(phantom_references);
+  ClearWhiteReferences(phantom_references, kPhantomReference);
 
   // At this point all reference lists should be empty.
   DCHECK(*soft_references == NULL);
@@ -1599,6 +1959,18 @@ void MarkSweep::ProcessReferences(Object** soft_references, bool clear_soft,
   timings_.EndSplit();
 }
 
+const char* MarkSweep::GetReferenceKindName(ReferenceKind kind) {
+  switch (kind) {
+    case kSoftReference: return "soft";
+    case kWeakReference: return "weak";
+    case kFinalizerReference: return "finalizer";
+    case kPhantomReference: return "phantom";
+    default:
+      LOG(FATAL) << "Unexpected reference kind " << static_cast<int>(kind);
+      return NULL;
+  }
+}
+
 void MarkSweep::UnBindBitmaps() {
   base::TimingLogger::ScopedSplit split("UnBindBitmaps", &timings_);
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
@@ -51,6 +51,7 @@ namespace accounting {
 }  // namespace accounting
 
 namespace space {
+  class AllocSpace;
   class ContinuousSpace;
 }  // namespace space
 
@@ -60,6 +61,24 @@ namespace collector {
 
 class MarkSweep : public GarbageCollector {
  public:
+  // Kinds of java.lang.ref.Reference, for the reference processing statistics.
+  enum ReferenceKind {
+    kSoftReference,
+    kWeakReference,
+    kFinalizerReference,
+    kPhantomReference,
+    kReferenceKindCount
+  };
+
+  // Reference processing statistics of one kind, cumulative over all collections.
+  struct ReferenceStats {
+    // References found on the pending lists, their referents were unmarked when found.
+    uint64_t processed;
+    // References whose referent got cleared, or got enqueued for finalization.
+    uint64_t cleared;
+    uint64_t time_ns;
+  };
+
   explicit MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_prefix = "");
 
   ~MarkSweep() {}
@@ -143,6 +162,12 @@ class MarkSweep : public GarbageCollector {
   // Sweeps unmarked objects to complete the garbage collection.
   void SweepLargeObjects(bool swap_bitmaps) EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
+  // Sweeps [begin, end) of an alloc space in chunks on the heap thread pool.
+  void SweepAllocSpaceParallel(space::AllocSpace* space, accounting::SpaceBitmap* live_bitmap,
+                               accounting::SpaceBitmap* mark_bitmap, uintptr_t begin,
+                               uintptr_t end, size_t thread_count)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
   // Sweep only pointers within an array. WARNING: Trashes objects.
   void SweepArray(accounting::ObjectStack* allocation_stack_, bool swap_bitmaps)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
@@ -198,6 +223,12 @@ class MarkSweep : public GarbageCollector {
     return total_freed_bytes_;
   }
 
+  const ReferenceStats& GetReferenceStats(ReferenceKind kind) const {
+    return total_reference_stats_[kind];
+  }
+
+  static const char* GetReferenceKindName(ReferenceKind kind);
+
   // Everything inside the immune range is assumed to be marked.
   void SetImmuneRange(mirror::Object* begin, mirror::Object* end);
 
@@ -301,6 +332,14 @@ class MarkSweep : public GarbageCollector {
   void VerifyRoots()
       NO_THREAD_SAFETY_ANALYSIS;
 
+  // Pushes count objects marked by a parallel marker on the mark stack, growing it if needed.
+  void PushOnMarkStackParallel(const mirror::Object** objs, size_t count)
+      LOCKS_EXCLUDED(mark_stack_lock_);
+
+  // Runs the MarkRootsTasks added to the heap thread pool on thread_count threads, including self.
+  void RunMarkRootsTasks(Thread* self, size_t thread_count)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+
   // Expand mark stack to 2x its current size.
   void ExpandMarkStack() EXCLUSIVE_LOCKS_REQUIRED(mark_stack_lock_);
   void ResizeMarkStack(size_t new_size) EXCLUSIVE_LOCKS_REQUIRED(mark_stack_lock_);
@@ -380,7 +419,18 @@ class MarkSweep : public GarbageCollector {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  void ClearWhiteReferences(mirror::Object** list)
+  void ClearWhiteReferences(mirror::Object** list, ReferenceKind kind)
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // Clears the white referents of the references in [begin, end), adding the cleared references
+  // which have a queue to enqueuable. Returns how many referents were cleared.
+  size_t ClearWhiteReferents(mirror::Object** begin, mirror::Object** end,
+                             std::vector<mirror::Object*>* enqueuable)
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+
+  // ClearWhiteReferents on the heap thread pool.
+  size_t ClearWhiteReferentsParallel(std::vector<mirror::Object*>* references,
+                                     std::vector<mirror::Object*>* enqueuable, size_t thread_count)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
 
   void ProcessReferences(mirror::Object** soft_references, bool clear_soft_references,
@@ -415,6 +465,8 @@ class MarkSweep : public GarbageCollector {
   mirror::Object* phantom_reference_list_;
   mirror::Object* cleared_reference_list_;
 
+  ReferenceStats total_reference_stats_[kReferenceKindCount];
+
   // Parallel finger.
   AtomicInteger atomic_finger_;
   // Number of non large object bytes freed in this collection.
@@ -456,9 +508,11 @@ class MarkSweep : public GarbageCollector {
   friend class CardScanTask;
   friend class CheckBitmapVisitor;
   friend class CheckReferenceVisitor;
+  friend class ClearWhiteReferencesTask;
   friend class art::gc::Heap;
   friend class InternTableEntryIsUnmarked;
   friend class MarkIfReachesAllocspaceVisitor;
+  friend class MarkRootsTask;
   friend class ModUnionCheckReferences;
   friend class ModUnionClearCardVisitor;
   friend class ModUnionReferenceVisitor;
@@ -466,6 +520,7 @@ class MarkSweep : public GarbageCollector {
   friend class ModUnionTableBitmap;
   friend class ModUnionTableReferenceCache;
   friend class ModUnionScanImageRootVisitor;
+  friend class ParallelRootMarker;
   friend class ScanBitmapVisitor;
   friend class ScanImageRootVisitor;
   template<bool kUseFinger> friend class MarkStackTask;
@@ -26,10 +26,18 @@ namespace collector {
 
 StickyMarkSweep::StickyMarkSweep(Heap* heap, bool is_concurrent, const std::string& name_prefix)
     : PartialMarkSweep(heap, is_concurrent,
-                       name_prefix + (name_prefix.empty() ? "" : " ") + "sticky") {
+                       name_prefix + (name_prefix.empty() ? "" : " ") + "sticky"),
+      total_young_objects_(0),
+      total_promoted_objects_(0) {
   cumulative_timings_.SetName(GetName());
 }
 
+void StickyMarkSweep::ResetCumulativeStatistics() {
+  PartialMarkSweep::ResetCumulativeStatistics();
+  total_young_objects_ = 0;
+  total_promoted_objects_ = 0;
+}
+
 void StickyMarkSweep::BindBitmaps() {
   PartialMarkSweep::BindBitmaps();
 
@@ -56,7 +64,20 @@ void StickyMarkSweep::MarkReachableObjects() {
 
 void StickyMarkSweep::Sweep(bool swap_bitmaps) {
   accounting::ObjectStack* live_stack = GetHeap()->GetLiveStack();
+  // Everything on the live stack was allocated since the last GC, whatever we don't free here
+  // gets promoted to the live bitmap.
+  // Skip the unused slots of thread allocation stack segments.
+  const size_t young_objects =
+      live_stack->Size() - std::count(live_stack->Begin(), live_stack->End(),
+                                      static_cast<mirror::Object*>(NULL));
+  const size_t freed_before = GetFreedObjects() + GetFreedLargeObjects();
   SweepArray(live_stack, false);
+  const size_t freed_objects = GetFreedObjects() + GetFreedLargeObjects() - freed_before;
+  DCHECK_LE(freed_objects, young_objects);
+  total_young_objects_ += young_objects;
+  total_promoted_objects_ += young_objects - freed_objects;
+  VLOG(heap) << "Sticky GC promoted " << young_objects - freed_objects << "/" << young_objects
+             << " objects";
 }
 
 void StickyMarkSweep::MarkThreadRoots(Thread* self) {
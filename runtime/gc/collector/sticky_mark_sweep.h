@@ -34,6 +34,18 @@ class StickyMarkSweep : public PartialMarkSweep {
   explicit StickyMarkSweep(Heap* heap, bool is_concurrent, const std::string& name_prefix = "");
   ~StickyMarkSweep() {}
 
+  virtual void ResetCumulativeStatistics();
+
+  // Total number of objects allocated since the previous GC which sticky GCs have looked at.
+  uint64_t GetTotalYoungObjects() const {
+    return total_young_objects_;
+  }
+
+  // Total number of those objects which survived their first sticky GC.
+  uint64_t GetTotalPromotedObjects() const {
+    return total_promoted_objects_;
+  }
+
  protected:
   // Bind the live bits to the mark bits of bitmaps for all spaces, all spaces other than the
   // alloc space will be marked as immune.
@@ -50,6 +62,9 @@ class StickyMarkSweep : public PartialMarkSweep {
   void Sweep(bool swap_bitmaps) EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
  private:
+  uint64_t total_young_objects_;
+  uint64_t total_promoted_objects_;
+
   DISALLOW_COPY_AND_ASSIGN(StickyMarkSweep);
 };
 
@@ -65,12 +65,27 @@ static constexpr bool kDumpGcPerformanceOnShutdown = false;
 static constexpr size_t kMinConcurrentRemainingBytes = 128 * KB;
 // If true, measure the total allocation time.
 static constexpr bool kMeasureAllocationTime = false;
+// If true, serve small alloc space allocations from per-thread caches to avoid the space lock.
+static constexpr bool kUseThreadLocalAllocationCache = true;
+// If true, threads push new objects on segments of the allocation stack they reserved rather than
+// all contending on the allocation stack's back index.
+static constexpr bool kUseThreadLocalAllocationStack = true;
+// Number of allocation stack slots a thread reserves at a time.
+static constexpr size_t kThreadLocalAllocationStackSize = 128;
+// Free bytes within the alloc space footprint above which we request a trim even if the space is
+// otherwise well utilized. Objects never move, so holes left between survivors can only be given
+// back to the kernel by trimming.
+static constexpr size_t kHeapTrimMinFreeBytes = 4 * MB;
+// The size class large object space reserves its address space up front, cap it rather than
+// reserving as much again as the heap's capacity. Large arrays that don't fit in it go to the
+// alloc space.
+static constexpr size_t kMaxSizeClassSpaceCapacity = 64 * MB;
 
 Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max_free,
            double target_utilization, size_t capacity, const std::string& original_image_file_name,
            bool concurrent_gc, size_t parallel_gc_threads, size_t conc_gc_threads,
            bool low_memory_mode, size_t long_pause_log_threshold, size_t long_gc_log_threshold,
-           bool ignore_max_footprint)
+           bool ignore_max_footprint, size_t alloc_sample_interval)
     : alloc_space_(NULL),
       card_table_(NULL),
       concurrent_gc_(concurrent_gc),
@@ -125,6 +140,7 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
        */
       max_allocation_stack_size_(kGCALotMode ? kGcAlotInterval
           : (kDesiredHeapVerification > kNoHeapVerification) ? KB : MB),
+      allocation_sampler_(new AllocationSampler(alloc_sample_interval)),
       reference_referent_offset_(0),
       reference_queue_offset_(0),
       reference_queueNext_offset_(0),
@@ -171,8 +187,13 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
   AddContinuousSpace(alloc_space_);
 
   // Allocate the large object space.
+  const bool kUseSizeClassSpaceForLOS = true;
   const bool kUseFreeListSpaceForLOS = false;
-  if (kUseFreeListSpaceForLOS) {
+  if (kUseSizeClassSpaceForLOS) {
+    large_object_space_ = space::SizeClassSpace::Create("large object space", NULL,
+                                                        std::min(capacity,
+                                                                 kMaxSizeClassSpaceCapacity));
+  } else if (kUseFreeListSpaceForLOS) {
     large_object_space_ = space::FreeListSpace::Create("large object space", NULL, capacity);
   } else {
     large_object_space_ = space::LargeObjectMapSpace::Create("large object space");
@@ -381,6 +402,8 @@ void Heap::AddContinuousSpace(space::ContinuousSpace* space) {
   mark_bitmap_->AddContinuousSpaceBitmap(space->GetMarkBitmap());
   continuous_spaces_.push_back(space);
   if (space->IsDlMallocSpace() && !space->IsLargeObjectSpace()) {
+    // Callers switching alloc spaces once threads run must first revoke the thread local
+    // buffers of all threads, with them suspended so that none are refilled from the old space.
     alloc_space_ = space->AsDlMallocSpace();
   }
 
@@ -450,6 +473,26 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
          << " objects with total size " << PrettySize(freed_bytes) << "\n"
          << collector->GetName() << " throughput: " << freed_objects / seconds << "/s / "
          << PrettySize(freed_bytes / seconds) << "/s\n";
+      if (collector->GetGcType() == collector::kGcTypeSticky) {
+        collector::StickyMarkSweep* sticky = down_cast<collector::StickyMarkSweep*>(collector);
+        const uint64_t young_objects = sticky->GetTotalYoungObjects();
+        const uint64_t promoted_objects = sticky->GetTotalPromotedObjects();
+        os << collector->GetName() << " promoted: " << promoted_objects << "/" << young_objects
+           << " young objects";
+        if (young_objects != 0) {
+          os << " (" << (100 * promoted_objects) / young_objects << "% promotion rate)";
+        }
+        os << "\n";
+      }
+      for (int i = 0; i < collector::MarkSweep::kReferenceKindCount; ++i) {
+        const auto kind = static_cast<collector::MarkSweep::ReferenceKind>(i);
+        const collector::MarkSweep::ReferenceStats& stats = collector->GetReferenceStats(kind);
+        if (stats.processed != 0) {
+          os << collector->GetName() << " " << collector::MarkSweep::GetReferenceKindName(kind)
+             << " references: " << stats.processed << " processed, " << stats.cleared
+             << " cleared in " << PrettyDuration(stats.time_ns) << "\n";
+        }
+      }
       total_duration += total_ns;
       total_paused_time += total_pause_ns;
     }
@@ -474,6 +517,9 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   }
   os << "Total mutator paused time: " << PrettyDuration(total_paused_time) << "\n";
   os << "Total time waiting for GC to complete: " << PrettyDuration(total_wait_time_) << "\n";
+  if (thread_pool_.get() != nullptr) {
+    thread_pool_->DumpStats(os);
+  }
   os << "Approximate GC data structures memory overhead: " << gc_memory_overhead_;
 }
 
@@ -554,6 +600,21 @@ static void MSpaceChunkCallback(void* start, void* end, size_t used_bytes, void*
   }
 }
 
+struct FreeChunkStats {
+  size_t free_bytes;
+  size_t largest_free_chunk;
+};
+
+static void MSpaceFreeChunkStatsCallback(void* start, void* end, size_t used_bytes, void* arg) {
+  size_t chunk_size = reinterpret_cast<uint8_t*>(end) - reinterpret_cast<uint8_t*>(start);
+  if (used_bytes < chunk_size) {
+    size_t chunk_free_bytes = chunk_size - used_bytes;
+    FreeChunkStats* stats = reinterpret_cast<FreeChunkStats*>(arg);
+    stats->free_bytes += chunk_free_bytes;
+    stats->largest_free_chunk = std::max(stats->largest_free_chunk, chunk_free_bytes);
+  }
+}
+
 mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_count) {
   DCHECK(c == NULL || (c->IsClassClass() && byte_count >= sizeof(mirror::Class)) ||
          (c->IsVariableSize() || c->GetObjectSize() == byte_count) ||
@@ -580,6 +641,10 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
     DCHECK(obj == NULL ||
            reinterpret_cast<byte*>(obj) < continuous_spaces_.front()->Begin() ||
            reinterpret_cast<byte*>(obj) >= continuous_spaces_.back()->End());
+    if (UNLIKELY(obj == NULL)) {
+      // The large object space may be smaller than the heap, see kMaxSizeClassSpaceCapacity.
+      obj = Allocate(self, alloc_space_, byte_count, &bytes_allocated);
+    }
   } else {
     obj = Allocate(self, alloc_space_, byte_count, &bytes_allocated);
     // Ensure that we did not allocate into a zygote space.
@@ -591,11 +656,14 @@ mirror::Object* Heap::AllocObject(Thread* self, mirror::Class* c, size_t byte_co
 
     // Record allocation after since we want to use the atomic add for the atomic fence to guard
     // the SetClass since we do not want the class to appear NULL in another thread.
-    RecordAllocation(bytes_allocated, obj);
+    RecordAllocation(self, bytes_allocated, obj);
 
     if (Dbg::IsAllocTrackingEnabled()) {
       Dbg::RecordAllocation(c, byte_count);
     }
+    if (UNLIKELY(self->CountAllocSampleBytes(bytes_allocated))) {
+      allocation_sampler_->SampleAllocation(self, c, bytes_allocated);
+    }
     if (UNLIKELY(static_cast<size_t>(num_bytes_allocated_) >= concurrent_start_bytes_)) {
       // The SirtRef is necessary since the calls in RequestConcurrentGC are a safepoint.
       SirtRef<mirror::Object> ref(self, obj);
@@ -771,13 +839,13 @@ void Heap::VerifyHeap() {
   GetLiveBitmap()->Walk(Heap::VerificationCallback, this);
 }
 
-inline void Heap::RecordAllocation(size_t size, mirror::Object* obj) {
+inline void Heap::RecordAllocation(Thread* self, size_t size, mirror::Object* obj) {
   DCHECK(obj != NULL);
   DCHECK_GT(size, 0u);
   num_bytes_allocated_.fetch_add(size);
 
   if (Runtime::Current()->HasStatsEnabled()) {
-    RuntimeStats* thread_stats = Thread::Current()->GetStats();
+    RuntimeStats* thread_stats = self->GetStats();
     ++thread_stats->allocated_objects;
     thread_stats->allocated_bytes += size;
 
@@ -789,9 +857,26 @@ inline void Heap::RecordAllocation(size_t size, mirror::Object* obj) {
 
   // This is safe to do since the GC will never free objects which are neither in the allocation
   // stack or the live bitmap.
-  while (!allocation_stack_->AtomicPushBack(obj)) {
+  if (kUseThreadLocalAllocationStack) {
+    if (UNLIKELY(!self->PushOnThreadLocalAllocationStack(obj))) {
+      PushOnThreadLocalAllocationStackWithInternalGC(self, obj);
+    }
+  } else {
+    while (!allocation_stack_->AtomicPushBack(obj)) {
+      CollectGarbageInternal(collector::kGcTypeSticky, kGcCauseForAlloc, false);
+    }
+  }
+}
+
+void Heap::PushOnThreadLocalAllocationStackWithInternalGC(Thread* self, mirror::Object* obj) {
+  mirror::Object** start;
+  mirror::Object** end;
+  while (!allocation_stack_->AtomicBumpBack(kThreadLocalAllocationStackSize, &start, &end)) {
     CollectGarbageInternal(collector::kGcTypeSticky, kGcCauseForAlloc, false);
   }
+  self->SetThreadLocalAllocationStack(start, end);
+  bool pushed = self->PushOnThreadLocalAllocationStack(obj);
+  DCHECK(pushed);
 }
 
 void Heap::RecordFree(size_t freed_objects, size_t freed_bytes) {
@@ -842,6 +927,10 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self, space::DlMallocSpace* s
     return NULL;
   }
   if (LIKELY(!running_on_valgrind_)) {
+    if (kUseThreadLocalAllocationCache &&
+        alloc_size <= space::DlMallocSpace::kMaxThreadLocalBracketSize) {
+      return space->AllocThreadLocal(self, alloc_size, bytes_allocated);
+    }
     return space->AllocNonvirtual(self, alloc_size, bytes_allocated);
   } else {
     return space->Alloc(self, alloc_size, bytes_allocated);
@@ -1148,11 +1237,16 @@ void Heap::PreZygoteFork() {
 
   VLOG(heap) << "Starting PreZygoteFork with alloc space size " << PrettySize(alloc_space_->Size());
 
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  thread_list->SuspendAll();
   {
     // Flush the alloc stack.
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
     FlushAllocStack();
   }
+  // Cached chunks would otherwise end up in the zygote space and be handed out from there. Keep
+  // the threads suspended until the new alloc space is in place so they can't cache any more.
+  RevokeAllThreadLocalBuffers();
 
   // Turns the current alloc space into a Zygote space and obtain the new alloc space composed
   // of the remaining available heap memory.
@@ -1164,6 +1258,7 @@ void Heap::PreZygoteFork() {
   zygote_space->SetGcRetentionPolicy(space::kGcRetentionPolicyFullCollect);
   AddContinuousSpace(alloc_space_);
   have_zygote_space_ = true;
+  thread_list->ResumeAll();
 
   // Reset the cumulative loggers since we now have a few additional timing phases.
   for (const auto& collector : mark_sweep_collectors_) {
@@ -1171,7 +1266,46 @@ void Heap::PreZygoteFork() {
   }
 }
 
+void Heap::RevokeThreadLocalBuffers(Thread* thread) {
+  if (kUseThreadLocalAllocationCache) {
+    for (const auto& space : continuous_spaces_) {
+      if (space->IsDlMallocSpace()) {
+        space->AsDlMallocSpace()->RevokeThreadLocalBuffers(thread);
+      }
+    }
+  }
+}
+
+void Heap::RevokeAllThreadLocalBuffers() {
+  if (kUseThreadLocalAllocationCache) {
+    Thread* self = Thread::Current();
+    // A running thread could refill its cache while it is being revoked.
+    Locks::mutator_lock_->AssertExclusiveHeld(self);
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      RevokeThreadLocalBuffers(thread);
+    }
+  }
+}
+
+void Heap::RevokeThreadLocalAllocationStack(Thread* thread) {
+  if (kUseThreadLocalAllocationStack) {
+    thread->SetThreadLocalAllocationStack(NULL, NULL);
+  }
+}
+
+void Heap::RevokeAllThreadLocalAllocationStacks() {
+  if (kUseThreadLocalAllocationStack) {
+    MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      RevokeThreadLocalAllocationStack(thread);
+    }
+  }
+}
+
 void Heap::FlushAllocStack() {
+  // Threads mustn't keep filling in segments of the stack once it is reset.
+  RevokeAllThreadLocalAllocationStacks();
   MarkAllocStack(alloc_space_->GetLiveBitmap(), large_object_space_->GetLiveObjects(),
                  allocation_stack_.get());
   allocation_stack_->Reset();
@@ -1182,7 +1316,10 @@ void Heap::MarkAllocStack(accounting::SpaceBitmap* bitmap, accounting::SpaceSetM
   mirror::Object** limit = stack->End();
   for (mirror::Object** it = stack->Begin(); it != limit; ++it) {
     const mirror::Object* obj = *it;
-    DCHECK(obj != NULL);
+    if (obj == NULL) {
+      // An unused slot of a thread's allocation stack segment.
+      continue;
+    }
     if (LIKELY(bitmap->HasAddress(obj))) {
       bitmap->Set(obj);
     } else {
@@ -1505,6 +1642,8 @@ class VerifyObjectVisitor {
 // Must do this with mutators suspended since we are directly accessing the allocation stacks.
 bool Heap::VerifyHeapReferences() {
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  // Sorting moves the unused slots of thread allocation stack segments.
+  RevokeAllThreadLocalAllocationStacks();
   // Lets sort our allocation stacks so that we can efficiently binary search them.
   allocation_stack_->Sort();
   live_stack_->Sort();
@@ -1516,7 +1655,9 @@ bool Heap::VerifyHeapReferences() {
   // 1. Allocated prior to the GC (pre GC verification).
   // 2. Allocated during the GC (pre sweep GC verification).
   for (mirror::Object** it = allocation_stack_->Begin(); it != allocation_stack_->End(); ++it) {
-    visitor(*it);
+    if (*it != NULL) {
+      visitor(*it);
+    }
   }
   // We don't want to verify the objects in the live stack since they themselves may be
   // pointing to dead objects if they are not reachable.
@@ -1625,14 +1766,18 @@ class VerifyLiveStackReferences {
 bool Heap::VerifyMissingCardMarks() {
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
 
-  // We need to sort the live stack since we binary search it.
+  // We need to sort the live stack since we binary search it. Sorting moves the unused slots of
+  // thread allocation stack segments.
+  RevokeAllThreadLocalAllocationStacks();
   live_stack_->Sort();
   VerifyLiveStackReferences visitor(this);
   GetLiveBitmap()->Visit(visitor);
 
   // We can verify objects in the live stack since none of these should reference dead objects.
   for (mirror::Object** it = live_stack_->Begin(); it != live_stack_->End(); ++it) {
-    visitor(*it);
+    if (*it != NULL) {
+      visitor(*it);
+    }
   }
 
   if (visitor.Failed()) {
@@ -1768,7 +1913,17 @@ collector::GcType Heap::WaitForConcurrentGcToComplete(Thread* self) {
 void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
+  // Since objects are never moved, free memory in the alloc space is only useful to allocations
+  // that fit in a single hole. Report how much of it is stranded outside of the largest hole.
+  FreeChunkStats stats = {0, 0};
+  alloc_space_->Walk(MSpaceFreeChunkStatsCallback, &stats);
+  if (stats.free_bytes != 0) {
+    os << "Alloc space: " << PrettySize(stats.free_bytes) << " free, largest free chunk "
+       << PrettySize(stats.largest_free_chunk) << " ("
+       << (100 - 100 * stats.largest_free_chunk / stats.free_bytes) << "% fragmented)\n";
+  }
   DumpGcPerformanceInfo(os);
+  allocation_sampler_->Dump(os);
 }
 
 size_t Heap::GetPercentFree() {
@@ -2037,12 +2192,18 @@ void Heap::RequestHeapTrim() {
   // to utilization (which is probably inversely proportional to how much benefit we can expect).
   // We could try mincore(2) but that's only a measure of how many pages we haven't given away,
   // not how much use we're making of those pages.
+  // Utilization alone under-reports the benefit on large heaps: 25% free in a 64MB space is 16MB
+  // of holes that no collection can compact away, so also trim once enough bytes are free.
   uint64_t ms_time = MilliTime();
-  float utilization =
-      static_cast<float>(alloc_space_->GetBytesAllocated()) / alloc_space_->Size();
-  if ((utilization > 0.75f && !IsLowMemoryMode()) || ((ms_time - last_trim_time_ms_) < 2 * 1000)) {
-    // Don't bother trimming the alloc space if it's more than 75% utilized and low memory mode is
-    // not enabled, or if a heap trim occurred in the last two seconds.
+  const size_t alloc_space_size = alloc_space_->Size();
+  const size_t bytes_allocated = static_cast<size_t>(alloc_space_->GetBytesAllocated());
+  const size_t bytes_free =
+      alloc_space_size > bytes_allocated ? alloc_space_size - bytes_allocated : 0;
+  float utilization = static_cast<float>(bytes_allocated) / alloc_space_size;
+  if ((utilization > 0.75f && !IsLowMemoryMode() && bytes_free < kHeapTrimMinFreeBytes) ||
+      ((ms_time - last_trim_time_ms_) < 2 * 1000)) {
+    // Don't bother trimming the alloc space if it's more than 75% utilized with few free bytes and
+    // low memory mode is not enabled, or if a heap trim occurred in the last two seconds.
     return;
   }
 
@@ -2074,7 +2235,7 @@ void Heap::RequestHeapTrim() {
 
 size_t Heap::Trim() {
   // Handle a requested heap trim on a thread outside of the main GC thread.
-  return alloc_space_->Trim();
+  return alloc_space_->Trim() + large_object_space_->Trim();
 }
 
 bool Heap::IsGCRequestPending() const {
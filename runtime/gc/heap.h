@@ -24,6 +24,7 @@
 #include "atomic_integer.h"
 #include "base/timing_logger.h"
 #include "gc/accounting/atomic_stack.h"
+#include "gc/allocation_sampler.h"
 #include "gc/accounting/card_table.h"
 #include "gc/collector/gc_type.h"
 #include "globals.h"
@@ -123,7 +124,8 @@ class Heap {
                 size_t max_free, double target_utilization, size_t capacity,
                 const std::string& original_image_file_name, bool concurrent_gc,
                 size_t parallel_gc_threads, size_t conc_gc_threads, bool low_memory_mode,
-                size_t long_pause_threshold, size_t long_gc_threshold, bool ignore_max_footprint);
+                size_t long_pause_threshold, size_t long_gc_threshold, bool ignore_max_footprint,
+                size_t alloc_sample_interval);
 
   ~Heap();
 
@@ -359,7 +361,7 @@ class Heap {
                                                               bool fail_ok) const;
   space::Space* FindSpaceFromObject(const mirror::Object*, bool fail_ok) const;
 
-  void DumpForSigQuit(std::ostream& os);
+  void DumpForSigQuit(std::ostream& os) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   size_t Trim();
 
@@ -377,7 +379,22 @@ class Heap {
 
   void PreZygoteFork() LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
 
-  // Mark and empty stack.
+  // Return the allocation cache of the given thread to the alloc space. The thread must be the
+  // caller or be suspended.
+  void RevokeThreadLocalBuffers(Thread* thread);
+
+  // Return the allocation caches of all threads to the alloc space. Requires all other threads to
+  // be suspended.
+  void RevokeAllThreadLocalBuffers() LOCKS_EXCLUDED(Locks::thread_list_lock_);
+
+  // Drop the given thread's segment of the allocation stack, the slots it didn't use stay NULL. The
+  // thread must be the caller or be suspended.
+  void RevokeThreadLocalAllocationStack(Thread* thread);
+
+  // Drop the allocation stack segments of all threads. Requires all other threads to be suspended.
+  void RevokeAllThreadLocalAllocationStacks() LOCKS_EXCLUDED(Locks::thread_list_lock_);
+
+  // Mark and empty stack. Requires all other threads to be suspended.
   void FlushAllocStack()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
@@ -445,6 +462,10 @@ class Heap {
     return conc_gc_threads_;
   }
 
+  AllocationSampler* GetAllocationSampler() {
+    return allocation_sampler_.get();
+  }
+
  private:
   // Allocates uninitialized storage. Passing in a null space tries to place the object in the
   // large object space.
@@ -480,10 +501,16 @@ class Heap {
   void RequestConcurrentGC(Thread* self) LOCKS_EXCLUDED(Locks::runtime_shutdown_lock_);
   bool IsGCRequestPending() const;
 
-  void RecordAllocation(size_t size, mirror::Object* object)
+  void RecordAllocation(Thread* self, size_t size, mirror::Object* object)
       LOCKS_EXCLUDED(GlobalSynchronization::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Reserves a new allocation stack segment for self, collecting garbage if the allocation stack is
+  // full, and pushes obj on it.
+  void PushOnThreadLocalAllocationStackWithInternalGC(Thread* self, mirror::Object* obj)
+      LOCKS_EXCLUDED(Locks::heap_bitmap_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Sometimes CollectGarbageInternal decides to run a different Gc than you requested. Returns
   // which type of Gc was actually ran.
   collector::GcType CollectGarbageInternal(collector::GcType gc_plan, GcCause gc_cause,
@@ -692,6 +719,9 @@ class Heap {
   // Second allocation stack so that we can process allocation with the heap unlocked.
   UniquePtr<accounting::ObjectStack> live_stack_;
 
+  // Histogram of the sites allocations are sampled at.
+  UniquePtr<AllocationSampler> allocation_sampler_;
+
   // offset of java.lang.ref.Reference.referent
   MemberOffset reference_referent_offset_;
 
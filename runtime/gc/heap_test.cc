@@ -67,5 +67,49 @@ TEST_F(HeapTest, HeapBitmapCapacityTest) {
   bitmap->Set(fake_end_of_heap_object);
 }
 
+TEST_F(HeapTest, ThreadLocalAllocationStack) {
+  ScopedObjectAccess soa(Thread::Current());
+  Heap* heap = Runtime::Current()->GetHeap();
+  // Enough objects to fill several segments of the allocation stack.
+  std::vector<mirror::Object*> objects;
+  for (size_t i = 0; i < 1000; ++i) {
+    mirror::Object* obj = mirror::ByteArray::Alloc(soa.Self(), 16);
+    ASSERT_TRUE(obj != NULL);
+    objects.push_back(obj);
+  }
+  ReaderMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+  for (mirror::Object* obj : objects) {
+    EXPECT_TRUE(heap->IsLiveObjectLocked(obj)) << obj;
+  }
+}
+
+TEST_F(HeapTest, AllocationSampling) {
+  ScopedObjectAccess soa(Thread::Current());
+  AllocationSampler* sampler = Runtime::Current()->GetHeap()->GetAllocationSampler();
+  ASSERT_TRUE(sampler->IsEnabled());
+  sampler->Reset();
+  // Samples are at most 1.5 sample intervals apart.
+  const size_t array_length = KB;
+  const size_t num_arrays = 8 * sampler->GetSampleInterval() / array_length;
+  for (size_t i = 0; i < num_arrays; ++i) {
+    ASSERT_TRUE(mirror::ByteArray::Alloc(soa.Self(), array_length) != NULL);
+  }
+  EXPECT_LE(5U, sampler->GetTotalSamples());
+
+  std::vector<std::pair<AllocationSite, AllocationSiteStats> > sites;
+  sampler->GetSites(&sites);
+  ASSERT_EQ(1U, sites.size());
+  EXPECT_EQ(class_linker_->FindSystemClass("[B"), sites[0].first.klass);
+  EXPECT_EQ(sampler->GetTotalSamples(), sites[0].second.samples);
+  EXPECT_LE(sites[0].second.samples * array_length, sites[0].second.sampled_bytes);
+
+  std::ostringstream os;
+  sampler->Dump(os);
+  EXPECT_NE(std::string::npos, os.str().find("byte[]")) << os.str();
+
+  sampler->Reset();
+  EXPECT_EQ(0U, sampler->GetTotalSamples());
+}
+
 }  // namespace gc
 }  // namespace art
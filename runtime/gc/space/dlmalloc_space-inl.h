@@ -37,6 +37,25 @@ inline mirror::Object* DlMallocSpace::AllocNonvirtual(Thread* self, size_t num_b
   return obj;
 }
 
+inline mirror::Object* DlMallocSpace::AllocThreadLocal(Thread* self, size_t num_bytes,
+                                                       size_t* bytes_allocated) {
+  DCHECK_GT(num_bytes, 0U);
+  DCHECK_LE(num_bytes, kMaxThreadLocalBracketSize);
+  const size_t bracket = (num_bytes - 1) / kThreadLocalBracketQuantum;
+  mirror::Object* obj = self->GetThreadLocalAllocBracket(bracket);
+  if (UNLIKELY(obj == NULL)) {
+    obj = RefillThreadLocalBracket(self, bracket);
+    if (obj == NULL) {
+      return NULL;
+    }
+  }
+  // Free chunks are linked through their first word.
+  self->SetThreadLocalAllocBracket(bracket, *reinterpret_cast<mirror::Object**>(obj));
+  *bytes_allocated = AllocationSizeNonvirtual(obj);
+  memset(obj, 0, num_bytes);
+  return obj;
+}
+
 inline mirror::Object* DlMallocSpace::AllocWithoutGrowthLocked(size_t num_bytes, size_t* bytes_allocated) {
   mirror::Object* result = reinterpret_cast<mirror::Object*>(mspace_malloc(mspace_, num_bytes));
   if (result != NULL) {
@@ -407,6 +407,51 @@ size_t DlMallocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** p
   }
 }
 
+mirror::Object* DlMallocSpace::RefillThreadLocalBracket(Thread* self, size_t bracket) {
+  const size_t bracket_size = (bracket + 1) * kThreadLocalBracketQuantum;
+  mirror::Object* head = NULL;
+  MutexLock mu(self, lock_);
+  for (size_t i = 0; i < kThreadLocalRefillCount; ++i) {
+    size_t bytes_allocated;
+    mirror::Object* obj = AllocWithoutGrowthLocked(bracket_size, &bytes_allocated);
+    if (obj == NULL) {
+      break;
+    }
+    *reinterpret_cast<mirror::Object**>(obj) = head;
+    head = obj;
+  }
+  return head;
+}
+
+size_t DlMallocSpace::RevokeThreadLocalBuffers(Thread* thread) {
+  size_t bytes_freed = 0;
+  MutexLock mu(Thread::Current(), lock_);
+  for (size_t i = 0; i < Thread::kNumThreadLocalAllocBrackets; ++i) {
+    // Chunks which belong to other spaces are left in the thread's cache.
+    mirror::Object* remaining = NULL;
+    mirror::Object* obj = thread->GetThreadLocalAllocBracket(i);
+    while (obj != NULL) {
+      mirror::Object* next = *reinterpret_cast<mirror::Object**>(obj);
+      if (Contains(obj)) {
+        // The chunk was never handed out as an object, so don't count it as ever allocated.
+        const size_t allocation_size = InternalAllocationSize(obj);
+        num_bytes_allocated_ -= allocation_size;
+        total_bytes_allocated_ -= allocation_size;
+        --num_objects_allocated_;
+        --total_objects_allocated_;
+        bytes_freed += allocation_size;
+        mspace_free(mspace_, obj);
+      } else {
+        *reinterpret_cast<mirror::Object**>(obj) = remaining;
+        remaining = obj;
+      }
+      obj = next;
+    }
+    thread->SetThreadLocalAllocBracket(i, remaining);
+  }
+  return bytes_freed;
+}
+
 // Callback from dlmalloc when it needs to increase the footprint
 extern "C" void* art_heap_morecore(void* mspace, intptr_t increment) {
   Heap* heap = Runtime::Current()->GetHeap();
@@ -19,6 +19,7 @@
 
 #include "gc/allocator/dlmalloc.h"
 #include "space.h"
+#include "thread.h"
 
 namespace art {
 namespace gc {
@@ -63,6 +64,22 @@ class DlMallocSpace : public MemMapSpace, public AllocSpace {
 
   mirror::Object* AllocNonvirtual(Thread* self, size_t num_bytes, size_t* bytes_allocated);
 
+  // Small allocations are served from per-thread free lists of chunks, one per size bracket, so
+  // that the common case doesn't need to take lock_.
+  static constexpr size_t kThreadLocalBracketQuantum = kObjectAlignment;
+  static constexpr size_t kMaxThreadLocalBracketSize =
+      kThreadLocalBracketQuantum * Thread::kNumThreadLocalAllocBrackets;
+  // Number of chunks taken from the mspace each time a thread's bracket runs dry.
+  static constexpr size_t kThreadLocalRefillCount = 16;
+
+  // Allocate num_bytes, which must be <= kMaxThreadLocalBracketSize, from self's allocation cache.
+  mirror::Object* AllocThreadLocal(Thread* self, size_t num_bytes, size_t* bytes_allocated)
+      LOCKS_EXCLUDED(lock_);
+
+  // Return the chunks from this space cached by thread back to the mspace. The thread must either
+  // be the caller or be suspended. Returns the number of bytes released.
+  size_t RevokeThreadLocalBuffers(Thread* thread) LOCKS_EXCLUDED(lock_);
+
   size_t AllocationSizeNonvirtual(const mirror::Object* obj) {
     return mspace_usable_size(const_cast<void*>(reinterpret_cast<const void*>(obj))) +
         kChunkOverhead;
@@ -154,6 +171,8 @@ class DlMallocSpace : public MemMapSpace, public AllocSpace {
   size_t InternalAllocationSize(const mirror::Object* obj);
   mirror::Object* AllocWithoutGrowthLocked(size_t num_bytes, size_t* bytes_allocated)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Fill the given bracket of self's allocation cache, returning the new head of its free list.
+  mirror::Object* RefillThreadLocalBracket(Thread* self, size_t bracket) LOCKS_EXCLUDED(lock_);
   bool Init(size_t initial_size, size_t maximum_size, size_t growth_size, byte* requested_base);
   void RegisterRecentFree(mirror::Object* ptr);
   static void* CreateMallocSpace(void* base, size_t morecore_start, size_t initial_size);
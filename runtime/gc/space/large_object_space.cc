@@ -326,6 +326,333 @@ void FreeListSpace::Dump(std::ostream& os) const {
   }
 }
 
+SizeClassSpace* SizeClassSpace::Create(const std::string& name, byte* requested_begin,
+                                       size_t capacity) {
+  CHECK_EQ(capacity % kPageSize, 0U);
+  MemMap* mem_map = MemMap::MapAnonymous(name.c_str(), requested_begin, capacity,
+                                         PROT_READ | PROT_WRITE);
+  CHECK(mem_map != NULL) << "Failed to allocate large object space mem map";
+  std::string page_map_name(name + " page map");
+  size_t page_map_size = RoundUp(capacity / kPageSize * sizeof(PageInfo), kPageSize);
+  MemMap* page_map_mem_map = MemMap::MapAnonymous(page_map_name.c_str(), NULL, page_map_size,
+                                                  PROT_READ | PROT_WRITE);
+  CHECK(page_map_mem_map != NULL) << "Failed to allocate large object space page map";
+  return new SizeClassSpace(name, mem_map, page_map_mem_map);
+}
+
+SizeClassSpace::SizeClassSpace(const std::string& name, MemMap* mem_map,
+                               MemMap* page_map_mem_map)
+    : LargeObjectSpace(name),
+      begin_(mem_map->Begin()),
+      end_(mem_map->End()),
+      num_pages_(mem_map->Size() / kPageSize),
+      mem_map_(mem_map),
+      page_map_mem_map_(page_map_mem_map),
+      page_map_(reinterpret_cast<PageInfo*>(page_map_mem_map->Begin())),
+      lock_("size class space lock", kAllocSpaceLock),
+      dirty_bytes_(0) {
+  CHECK_GT(num_pages_, 0U);
+  CHECK_LE(num_pages_, static_cast<size_t>(kRunPagesMask));
+  // The whole space starts out as a single clean free run.
+  MutexLock mu(Thread::Current(), lock_);
+  SetRun(0, num_pages_, 0);
+}
+
+SizeClassSpace::~SizeClassSpace() {}
+
+size_t SizeClassSpace::SizeClass(size_t num_pages) {
+  DCHECK_GT(num_pages, 0U);
+  if (num_pages <= kNumExactSizeClasses) {
+    return num_pages - 1;
+  }
+  // The highest set bit of num_pages - 1 is at least 4 here, classes from kNumExactSizeClasses
+  // on hold runs of (2^k, 2^(k+1)] pages.
+  return kNumExactSizeClasses - 4 + (31 - CLZ(num_pages - 1));
+}
+
+void SizeClassSpace::SetRun(size_t first_page, size_t num_pages, uint32_t flags) {
+  DCHECK_GT(num_pages, 0U);
+  DCHECK_LE(first_page + num_pages, num_pages_);
+  const uint32_t run = num_pages | flags;
+  page_map_[first_page].run = run;
+  page_map_[first_page + num_pages - 1].run = run;
+  if ((flags & kRunAllocated) == 0) {
+    AddFreeRun(first_page);
+  }
+}
+
+void SizeClassSpace::AddFreeRun(size_t first_page) {
+  const uint32_t run = page_map_[first_page].run;
+  const size_t num_pages = run & kRunPagesMask;
+  FreeRuns& runs = free_runs_[SizeClass(num_pages)];
+  page_map_[first_page].free_index = runs.size();
+  runs.push_back(first_page);
+  if ((run & kRunDirty) != 0) {
+    page_map_[first_page].dirty_index = dirty_runs_.size();
+    dirty_runs_.push_back(first_page);
+    dirty_bytes_ += num_pages * kPageSize;
+  }
+}
+
+void SizeClassSpace::RemoveFreeRun(size_t first_page) {
+  const uint32_t run = page_map_[first_page].run;
+  const size_t num_pages = run & kRunPagesMask;
+  FreeRuns& runs = free_runs_[SizeClass(num_pages)];
+  const uint32_t index = page_map_[first_page].free_index;
+  DCHECK_LT(index, runs.size());
+  DCHECK_EQ(runs[index], first_page);
+  // Move the last run of the list into the hole.
+  const uint32_t last = runs.back();
+  runs[index] = last;
+  page_map_[last].free_index = index;
+  runs.pop_back();
+  if ((run & kRunDirty) != 0) {
+    const uint32_t dirty_index = page_map_[first_page].dirty_index;
+    DCHECK_LT(dirty_index, dirty_runs_.size());
+    DCHECK_EQ(dirty_runs_[dirty_index], first_page);
+    const uint32_t last_dirty = dirty_runs_.back();
+    dirty_runs_[dirty_index] = last_dirty;
+    page_map_[last_dirty].dirty_index = dirty_index;
+    dirty_runs_.pop_back();
+    DCHECK_LE(num_pages * kPageSize, dirty_bytes_);
+    dirty_bytes_ -= num_pages * kPageSize;
+  }
+}
+
+void SizeClassSpace::CoalesceFreeRuns(size_t* begin, size_t* end, uint32_t flags) {
+  const uint32_t kStateMask = kRunAllocated | kRunDirty | kRunReleasing;
+  if (*begin > 0) {
+    const uint32_t prev = page_map_[*begin - 1].run;
+    if ((prev & kStateMask) == flags) {
+      const size_t prev_pages = prev & kRunPagesMask;
+      RemoveFreeRun(*begin - prev_pages);
+      page_map_[*begin - 1].run = 0;
+      *begin -= prev_pages;
+    }
+  }
+  if (*end < num_pages_) {
+    const uint32_t next = page_map_[*end].run;
+    if ((next & kStateMask) == flags) {
+      const size_t next_pages = next & kRunPagesMask;
+      RemoveFreeRun(*end);
+      page_map_[*end].run = 0;
+      *end += next_pages;
+    }
+  }
+}
+
+ssize_t SizeClassSpace::FindFreeRun(size_t num_pages) {
+  const size_t size_class = SizeClass(num_pages);
+  if (size_class >= kNumExactSizeClasses) {
+    // Runs in the same class may be too small, take the first that fits.
+    FreeRuns& runs = free_runs_[size_class];
+    for (size_t i = 0; i < runs.size(); ++i) {
+      const uint32_t first_page = runs[i];
+      if ((page_map_[first_page].run & kRunPagesMask) >= num_pages) {
+        RemoveFreeRun(first_page);
+        return first_page;
+      }
+    }
+  } else if (!free_runs_[size_class].empty()) {
+    // Take the most recently freed run as it is the most likely to still be dirty and cached.
+    const uint32_t first_page = free_runs_[size_class].back();
+    RemoveFreeRun(first_page);
+    return first_page;
+  }
+  // Every run of a larger class fits.
+  for (size_t i = size_class + 1; i < kNumSizeClasses; ++i) {
+    if (!free_runs_[i].empty()) {
+      const uint32_t first_page = free_runs_[i].back();
+      RemoveFreeRun(first_page);
+      return first_page;
+    }
+  }
+  return -1;
+}
+
+mirror::Object* SizeClassSpace::Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated) {
+  const size_t num_pages = RoundUp(num_bytes, kPageSize) / kPageSize;
+  if (UNLIKELY(num_pages == 0 || num_pages > num_pages_)) {
+    return NULL;
+  }
+  byte* obj_begin;
+  bool dirty;
+  {
+    MutexLock mu(self, lock_);
+    ssize_t first_page = FindFreeRun(num_pages);
+    if (first_page < 0 && !dirty_runs_.empty()) {
+      // Dirty runs don't coalesce with clean ones, release them to merge them and find room.
+      ReleaseDirtyRuns(self);
+      first_page = FindFreeRun(num_pages);
+    }
+    if (first_page < 0) {
+      return NULL;
+    }
+    const uint32_t run = page_map_[first_page].run;
+    const size_t run_pages = run & kRunPagesMask;
+    dirty = (run & kRunDirty) != 0;
+    SetRun(first_page, num_pages, kRunAllocated);
+    if (run_pages > num_pages) {
+      // Give back the rest of the run.
+      SetRun(first_page + num_pages, run_pages - num_pages, run & kRunDirty);
+    }
+    obj_begin = begin_ + first_page * kPageSize;
+
+    const size_t allocation_size = num_pages * kPageSize;
+    DCHECK(bytes_allocated != NULL);
+    *bytes_allocated = allocation_size;
+    ++num_objects_allocated_;
+    ++total_objects_allocated_;
+    num_bytes_allocated_ += allocation_size;
+    total_bytes_allocated_ += allocation_size;
+  }
+  if (dirty) {
+    // The pages still hold freed objects. Only the object needs to be zeroed, the rest of the last
+    // page is never read and gets zeroed if a later allocation reuses it.
+    memset(obj_begin, 0, num_bytes);
+  }
+  return reinterpret_cast<mirror::Object*>(obj_begin);
+}
+
+size_t SizeClassSpace::FreeLocked(mirror::Object* obj) {
+  DCHECK(Contains(obj));
+  DCHECK(IsAligned<kPageSize>(obj));
+  const size_t first_page = PageIndex(obj);
+  const uint32_t run = page_map_[first_page].run;
+  CHECK((run & kRunAllocated) != 0) << "Attempted to free large object which was not live";
+  const size_t num_pages = run & kRunPagesMask;
+  const size_t allocation_size = num_pages * kPageSize;
+  // The boundaries of the freed run become interior pages if it coalesces.
+  page_map_[first_page].run = 0;
+  page_map_[first_page + num_pages - 1].run = 0;
+
+  // Only coalesce with dirty free runs, as runs must be all clean or all dirty so that reusing a
+  // run never memsets released pages. Clean neighbours join in when dirty runs get released,
+  // keeping madvise out of the free path.
+  size_t begin = first_page;
+  size_t end = first_page + num_pages;
+  CoalesceFreeRuns(&begin, &end, kRunDirty);
+  SetRun(begin, end - begin, kRunDirty);
+
+  --num_objects_allocated_;
+  DCHECK_LE(allocation_size, num_bytes_allocated_);
+  num_bytes_allocated_ -= allocation_size;
+  return allocation_size;
+}
+
+size_t SizeClassSpace::Free(Thread* self, mirror::Object* obj) {
+  MutexLock mu(self, lock_);
+  size_t freed_bytes = FreeLocked(obj);
+  if (dirty_bytes_ > kMaxDirtyBytes) {
+    ReleaseDirtyRuns(self);
+  }
+  return freed_bytes;
+}
+
+size_t SizeClassSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
+  MutexLock mu(self, lock_);
+  size_t total = 0;
+  for (size_t i = 0; i < num_ptrs; ++i) {
+    if (kDebugSpaces) {
+      CHECK(Contains(ptrs[i]));
+    }
+    total += FreeLocked(ptrs[i]);
+  }
+  if (dirty_bytes_ > kMaxDirtyBytes) {
+    ReleaseDirtyRuns(self);
+  }
+  return total;
+}
+
+size_t SizeClassSpace::ReleaseDirtyRuns(Thread* self) {
+  if (dirty_runs_.empty()) {
+    return 0;
+  }
+  // Take the dirty runs off the free lists, marking them so that neither allocations nor frees
+  // coalescing with a neighbour touch them while lock_ is released for the madvise calls.
+  FreeRuns releasing;
+  releasing.reserve(dirty_runs_.size());
+  while (!dirty_runs_.empty()) {
+    const uint32_t first_page = dirty_runs_.back();
+    const size_t num_pages = page_map_[first_page].run & kRunPagesMask;
+    RemoveFreeRun(first_page);
+    page_map_[first_page].run = num_pages | kRunReleasing;
+    page_map_[first_page + num_pages - 1].run = num_pages | kRunReleasing;
+    releasing.push_back(first_page);
+  }
+  DCHECK_EQ(dirty_bytes_, 0U);
+  size_t released_bytes = 0;
+  lock_.ExclusiveUnlock(self);
+  for (uint32_t first_page : releasing) {
+    const size_t num_pages = page_map_[first_page].run & kRunPagesMask;
+    madvise(begin_ + first_page * kPageSize, num_pages * kPageSize, MADV_DONTNEED);
+    released_bytes += num_pages * kPageSize;
+  }
+  lock_.ExclusiveLock(self);
+  // A released run merges with clean free neighbours. A neighbour still being released merges
+  // with it once its own release completes.
+  for (uint32_t first_page : releasing) {
+    const size_t num_pages = page_map_[first_page].run & kRunPagesMask;
+    page_map_[first_page].run = 0;
+    page_map_[first_page + num_pages - 1].run = 0;
+    size_t begin = first_page;
+    size_t end = first_page + num_pages;
+    CoalesceFreeRuns(&begin, &end, 0);
+    SetRun(begin, end - begin, 0);
+  }
+  return released_bytes;
+}
+
+size_t SizeClassSpace::Trim() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  return ReleaseDirtyRuns(self);
+}
+
+bool SizeClassSpace::Contains(const mirror::Object* obj) const {
+  return mem_map_->HasAddress(obj);
+}
+
+size_t SizeClassSpace::AllocationSize(const mirror::Object* obj) {
+  DCHECK(Contains(obj));
+  const uint32_t run = page_map_[PageIndex(obj)].run;
+  DCHECK((run & kRunAllocated) != 0);
+  return (run & kRunPagesMask) * kPageSize;
+}
+
+void SizeClassSpace::Walk(DlMallocSpace::WalkCallback callback, void* arg) {
+  MutexLock mu(Thread::Current(), lock_);
+  // Runs tile the space, so hop from run to run.
+  for (size_t page = 0; page < num_pages_; ) {
+    const uint32_t run = page_map_[page].run;
+    DCHECK_NE(run, 0U);
+    const size_t num_pages = run & kRunPagesMask;
+    if ((run & kRunAllocated) != 0) {
+      byte* byte_start = begin_ + page * kPageSize;
+      byte* byte_end = byte_start + num_pages * kPageSize;
+      callback(byte_start, byte_end, num_pages * kPageSize, arg);
+      callback(NULL, NULL, 0, arg);
+    }
+    page += num_pages;
+  }
+}
+
+void SizeClassSpace::Dump(std::ostream& os) const {
+  MutexLock mu(Thread::Current(), lock_);
+  os << GetName() << " -"
+     << " begin: " << reinterpret_cast<void*>(Begin())
+     << " end: " << reinterpret_cast<void*>(End())
+     << " dirty free bytes: " << dirty_bytes_ << "\n";
+  for (size_t page = 0; page < num_pages_; ) {
+    const uint32_t run = page_map_[page].run;
+    const size_t num_pages = run & kRunPagesMask;
+    os << ((run & kRunAllocated) != 0 ? "Large object" : "Free block") << " at address: "
+       << reinterpret_cast<const void*>(begin_ + page * kPageSize)
+       << " of length " << num_pages * kPageSize << " bytes\n";
+    page += num_pages;
+  }
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
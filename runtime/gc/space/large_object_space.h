@@ -59,6 +59,11 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
 
   size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs);
 
+  // Returns unused memory to the system, returning how many bytes were released.
+  virtual size_t Trim() {
+    return 0;
+  }
+
  protected:
   explicit LargeObjectSpace(const std::string& name);
 
@@ -230,6 +235,124 @@ class FreeListSpace : public LargeObjectSpace {
   FreeBlocks free_blocks_ GUARDED_BY(lock_);
 };
 
+// A continuous large object space which allocates page runs from segregated free lists. Each size
+// class has a list of free runs. Small classes hold runs of exactly one size, so an allocation
+// takes the first run of its class. Larger classes cover a power of two range of sizes. Free runs
+// coalesce with their free neighbours.
+//
+// Run boundaries are kept in a page map next to the space instead of in headers, so objects are
+// page aligned and free pages are never touched. Freed runs are released to the system with
+// madvise lazily: they stay dirty until kMaxDirtyBytes of dirty runs accumulate, or until Trim.
+// Reusing a dirty run costs a memset of the object instead of page faults.
+class SizeClassSpace : public LargeObjectSpace {
+ public:
+  virtual ~SizeClassSpace();
+  static SizeClassSpace* Create(const std::string& name, byte* requested_begin, size_t capacity);
+
+  size_t AllocationSize(const mirror::Object* obj);
+  mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated);
+  size_t Free(Thread* self, mirror::Object* obj) LOCKS_EXCLUDED(lock_);
+  size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) LOCKS_EXCLUDED(lock_);
+  bool Contains(const mirror::Object* obj) const;
+  void Walk(DlMallocSpace::WalkCallback callback, void* arg) LOCKS_EXCLUDED(lock_);
+  size_t Trim() LOCKS_EXCLUDED(lock_);
+
+  // Address at which the space begins.
+  byte* Begin() const {
+    return begin_;
+  }
+
+  // Address at which the space ends.
+  byte* End() const {
+    return end_;
+  }
+
+  size_t Size() const {
+    return End() - Begin();
+  }
+
+  void Dump(std::ostream& os) const;
+
+ private:
+  // Page map entries of the first and last page of each run hold the run's length in pages and
+  // these flags. Other entries are 0.
+  static const uint32_t kRunAllocated = 0x80000000;
+  // Set for free runs whose pages haven't been released since they were freed.
+  static const uint32_t kRunDirty = 0x40000000;
+  // Set for runs whose pages are being released with lock_ not held. They are neither allocated
+  // nor on the free lists, so nothing else touches them until the release completes.
+  static const uint32_t kRunReleasing = 0x20000000;
+  static const uint32_t kRunPagesMask = 0x1fffffff;
+
+  // Runs of 1 to kNumExactSizeClasses pages each have their own class, beyond that a class covers
+  // the sizes between two powers of two.
+  static const size_t kNumExactSizeClasses = 16;
+  static const size_t kNumSizeClasses = kNumExactSizeClasses - 4 + 32;
+
+  // Dirty free bytes above which frees release all dirty runs.
+  static const size_t kMaxDirtyBytes = 4 * MB;
+
+  struct PageInfo {
+    // Run length and flags, see kRunAllocated.
+    uint32_t run;
+    // Index of a free run in its size class's list, only valid for the first page of the run.
+    uint32_t free_index;
+    // Index of a dirty free run in dirty_runs_, only valid for the first page of the run.
+    uint32_t dirty_index;
+  };
+
+  typedef std::vector<uint32_t, accounting::GCAllocator<uint32_t> > FreeRuns;
+
+  SizeClassSpace(const std::string& name, MemMap* mem_map, MemMap* page_map_mem_map);
+
+  static size_t SizeClass(size_t num_pages);
+
+  size_t PageIndex(const mirror::Object* obj) const {
+    return (reinterpret_cast<const byte*>(obj) - begin_) / kPageSize;
+  }
+
+  // Records a run of num_pages starting at first_page with the given flags, adding it to the free
+  // lists unless it is allocated.
+  void SetRun(size_t first_page, size_t num_pages, uint32_t flags) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Add or remove a free run from the free lists, and from dirty_runs_ if it is dirty.
+  void AddFreeRun(size_t first_page) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void RemoveFreeRun(size_t first_page) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Extends [begin, end) over the free runs next to it whose flags are exactly flags, removing
+  // them from the free lists.
+  void CoalesceFreeRuns(size_t* begin, size_t* end, uint32_t flags)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the first page of a free run of at least num_pages, removed from the free lists, or -1.
+  ssize_t FindFreeRun(size_t num_pages) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  size_t FreeLocked(mirror::Object* obj) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Releases the pages of every dirty free run, with lock_ not held meanwhile, and coalesces the
+  // released runs with clean free neighbours. Returns how many bytes were released.
+  size_t ReleaseDirtyRuns(Thread* self) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  byte* const begin_;
+  byte* const end_;
+  const size_t num_pages_;
+
+  UniquePtr<MemMap> mem_map_;
+
+  // Zero filled on creation, so the entries of never used pages cost no memory.
+  UniquePtr<MemMap> page_map_mem_map_;
+  PageInfo* const page_map_;
+
+  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  FreeRuns free_runs_[kNumSizeClasses] GUARDED_BY(lock_);
+
+  // First pages of the dirty free runs, so that releasing them needn't walk the page map.
+  FreeRuns dirty_runs_ GUARDED_BY(lock_);
+
+  // Bytes in dirty free runs.
+  size_t dirty_bytes_ GUARDED_BY(lock_);
+};
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
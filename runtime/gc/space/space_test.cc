@@ -33,7 +33,9 @@ class SpaceTest : public CommonTest {
                                            int round, size_t growth_limit);
   void SizeFootPrintGrowthLimitAndTrimDriver(size_t object_size);
 
+  // Only the test thread allocates, so revoking its own buffers is enough to switch spaces.
   void AddContinuousSpace(ContinuousSpace* space) {
+    Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(Thread::Current());
     Runtime::Current()->GetHeap()->AddContinuousSpace(space);
   }
 };
@@ -206,12 +208,14 @@ TEST_F(SpaceTest, AllocAndFree) {
 
 TEST_F(SpaceTest, LargeObjectTest) {
   size_t rand_seed = 0;
-  for (size_t i = 0; i < 2; ++i) {
+  for (size_t i = 0; i < 3; ++i) {
     LargeObjectSpace* los = NULL;
     if (i == 0) {
       los = space::LargeObjectMapSpace::Create("large object space");
-    } else {
+    } else if (i == 1) {
       los = space::FreeListSpace::Create("large object space", NULL, 128 * MB);
+    } else {
+      los = space::SizeClassSpace::Create("large object space", NULL, 128 * MB);
     }
 
     static const size_t num_allocations = 64;
@@ -265,6 +269,94 @@ TEST_F(SpaceTest, LargeObjectTest) {
   }
 }
 
+static void CountLargeObjectsCallback(void* start, void* end, size_t /* num_bytes */,
+                                      void* arg) {
+  if (start != NULL) {
+    EXPECT_LT(start, end);
+    ++*reinterpret_cast<size_t*>(arg);
+  }
+}
+
+TEST_F(SpaceTest, SizeClassSpaceReuse) {
+  Thread* self = Thread::Current();
+  UniquePtr<SizeClassSpace> los(SizeClassSpace::Create("large object space", NULL, 16 * MB));
+  ASSERT_TRUE(los.get() != NULL);
+
+  // Allocations are page aligned and rounded up to whole pages.
+  std::vector<mirror::Object*> objects;
+  for (size_t i = 1; i <= 20; ++i) {
+    size_t bytes_allocated = 0;
+    mirror::Object* obj = los->Alloc(self, i * kPageSize - 8, &bytes_allocated);
+    ASSERT_TRUE(obj != NULL);
+    EXPECT_TRUE(IsAligned<kPageSize>(obj));
+    EXPECT_EQ(i * kPageSize, bytes_allocated);
+    memset(obj, 0xAB, i * kPageSize - 8);
+    objects.push_back(obj);
+  }
+  size_t num_objects = 0;
+  los->Walk(CountLargeObjectsCallback, &num_objects);
+  EXPECT_EQ(objects.size(), num_objects);
+
+  // Free every other object, the freed runs stay dirty and must come back zeroed.
+  for (size_t i = 0; i < objects.size(); i += 2) {
+    los->Free(self, objects[i]);
+  }
+  for (size_t i = 1; i <= 20; i += 2) {
+    size_t bytes_allocated = 0;
+    byte* obj = reinterpret_cast<byte*>(los->Alloc(self, i * kPageSize, &bytes_allocated));
+    ASSERT_TRUE(obj != NULL);
+    for (size_t k = 0; k < i * kPageSize; ++k) {
+      ASSERT_EQ(0, obj[k]);
+    }
+    los->Free(self, reinterpret_cast<mirror::Object*>(obj));
+  }
+  for (size_t i = 1; i < objects.size(); i += 2) {
+    los->Free(self, objects[i]);
+  }
+  num_objects = 0;
+  los->Walk(CountLargeObjectsCallback, &num_objects);
+  EXPECT_EQ(0U, num_objects);
+  EXPECT_EQ(0U, los->GetBytesAllocated());
+
+  // Everything coalesced back into a single run.
+  size_t bytes_allocated = 0;
+  mirror::Object* obj = los->Alloc(self, 16 * MB, &bytes_allocated);
+  ASSERT_TRUE(obj != NULL);
+  EXPECT_EQ(0, reinterpret_cast<byte*>(obj)[kPageSize]);
+  los->Free(self, obj);
+  los->Trim();
+}
+
+TEST_F(SpaceTest, SizeClassSpaceTrim) {
+  Thread* self = Thread::Current();
+  UniquePtr<SizeClassSpace> los(SizeClassSpace::Create("large object space", NULL, 1 * MB));
+  ASSERT_TRUE(los.get() != NULL);
+  mirror::Object* objects[3];
+  for (size_t i = 0; i < 3; ++i) {
+    size_t bytes_allocated = 0;
+    objects[i] = los->Alloc(self, 4 * kPageSize, &bytes_allocated);
+    ASSERT_TRUE(objects[i] != NULL);
+    memset(objects[i], 0xAB, 4 * kPageSize);
+  }
+
+  // Only the freed runs are dirty, once released there is nothing left to release.
+  los->Free(self, objects[0]);
+  los->Free(self, objects[2]);
+  EXPECT_EQ(8 * kPageSize, los->Trim());
+  EXPECT_EQ(0U, los->Trim());
+
+  // Releasing the last object's run merges every clean run back into one, which reads as zero.
+  los->Free(self, objects[1]);
+  EXPECT_EQ(4 * kPageSize, los->Trim());
+  size_t bytes_allocated = 0;
+  byte* obj = reinterpret_cast<byte*>(los->Alloc(self, 1 * MB, &bytes_allocated));
+  ASSERT_TRUE(obj != NULL);
+  for (size_t k = 0; k < 12 * kPageSize; k += kPageSize / 4) {
+    ASSERT_EQ(0, obj[k]);
+  }
+  los->Free(self, reinterpret_cast<mirror::Object*>(obj));
+}
+
 TEST_F(SpaceTest, AllocAndFreeList) {
   DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
   ASSERT_TRUE(space != NULL);
@@ -303,6 +395,41 @@ TEST_F(SpaceTest, AllocAndFreeList) {
   }
 }
 
+TEST_F(SpaceTest, ThreadLocalAllocation) {
+  DlMallocSpace* space(DlMallocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, NULL));
+  ASSERT_TRUE(space != NULL);
+
+  // Make space findable to the heap, will also delete space when runtime is cleaned up
+  AddContinuousSpace(space);
+  Thread* self = Thread::Current();
+  const uint64_t refill_count = DlMallocSpace::kThreadLocalRefillCount;
+
+  // The first allocation refills the thread's cache for its size bracket.
+  size_t allocation_size = 0;
+  mirror::Object* ptr1 = space->AllocThreadLocal(self, 24, &allocation_size);
+  ASSERT_TRUE(ptr1 != NULL);
+  EXPECT_TRUE(space->Contains(ptr1));
+  EXPECT_EQ(allocation_size, space->AllocationSize(ptr1));
+  EXPECT_LE(24U, allocation_size);
+  EXPECT_EQ(refill_count, space->GetObjectsAllocated());
+
+  // Served from the same bracket without going back to the mspace.
+  mirror::Object* ptr2 = space->AllocThreadLocal(self, 20, &allocation_size);
+  ASSERT_TRUE(ptr2 != NULL);
+  EXPECT_NE(ptr1, ptr2);
+  EXPECT_EQ(refill_count, space->GetObjectsAllocated());
+
+  // Revoking returns everything which wasn't handed out.
+  EXPECT_LT(0U, space->RevokeThreadLocalBuffers(self));
+  EXPECT_TRUE(self->GetThreadLocalAllocBracket(2) == NULL);
+  EXPECT_EQ(2U, space->GetObjectsAllocated());
+  EXPECT_EQ(2U, space->GetTotalObjectsAllocated());
+
+  space->Free(self, ptr1);
+  space->Free(self, ptr2);
+  EXPECT_EQ(0U, space->GetObjectsAllocated());
+}
+
 void SpaceTest::SizeFootPrintGrowthLimitAndTrimBody(DlMallocSpace* space, intptr_t object_size,
                                                     int round, size_t growth_limit) {
   if (((object_size > 0 && object_size >= static_cast<intptr_t>(growth_limit))) ||
@@ -15,11 +15,13 @@
  */
 
 /*
- * Preparation and completion of hprof data generation.  The output is
- * written into two files and then combined.  This is necessary because
- * we generate some of the data (strings and classes) while we dump the
- * heap, and some analysis tools require that the class and string data
- * appear first.
+ * Preparation and completion of hprof data generation.  We generate some
+ * of the data (strings and classes) while we dump the heap, and some
+ * analysis tools require that the class and string data appear before
+ * the records referring to them.  Dumps to a file are streamed, with each
+ * string and class written out as soon as it is discovered, ahead of the
+ * heap dump segment using it.  Dumps sent to DDMS are written into two
+ * in-memory files, the tables and the heap, which are then combined.
  */
 
 #include "hprof.h"
@@ -34,8 +36,12 @@
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
+#include <algorithm>
+#include <limits>
 #include <set>
+#include <vector>
 
 #include "base/logging.h"
 #include "base/stringprintf.h"
@@ -45,10 +51,12 @@
 #include "debugger.h"
 #include "dex_file-inl.h"
 #include "gc/accounting/heap_bitmap.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap.h"
 #include "gc/space/space.h"
 #include "globals.h"
 #include "mirror/art_field-inl.h"
+#include "mirror/art_method-inl.h"
 #include "mirror/class.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -364,6 +372,127 @@ class HprofRecord {
   DISALLOW_COPY_AND_ASSIGN(HprofRecord);
 };
 
+// The sink of streamed heap dumps: writes to a file, optionally compressing in the gzip format.
+// Open wraps it into a stdio stream with a fixed-size buffer, so that the dump is written with the
+// same code whether it goes to a file or to the in-memory buffers sent to DDMS.
+class HprofOutputStream {
+ public:
+  static constexpr size_t kBufferSize = 64 * KB;
+
+  // Returns a stream writing to file, which it takes ownership of, or NULL on failure.
+  // *bytes_written is kept up to date with the number of bytes written to the file.
+  static FILE* Open(File* file, bool compress, size_t* bytes_written) {
+    UniquePtr<HprofOutputStream> stream(new HprofOutputStream(file, compress, bytes_written));
+    if (!stream->Init()) {
+      return NULL;
+    }
+#if defined(__GLIBC__)
+    cookie_io_functions_t functions = { NULL, WriteCallback, NULL, CloseCallback };
+    FILE* fp = fopencookie(stream.get(), "w", functions);
+#else
+    FILE* fp = funopen(stream.get(), NULL, WriteCallback, NULL, CloseCallback);
+#endif
+    if (fp == NULL) {
+      return NULL;
+    }
+    stream.release();
+    setvbuf(fp, NULL, _IOFBF, kBufferSize);
+    return fp;
+  }
+
+  ~HprofOutputStream() {
+    if (compress_) {
+      deflateEnd(&zstream_);
+    }
+  }
+
+ private:
+  HprofOutputStream(File* file, bool compress, size_t* bytes_written)
+      : file_(file), compress_(compress), bytes_written_(bytes_written) {
+    *bytes_written_ = 0;
+  }
+
+  bool Init() {
+    if (!compress_) {
+      return true;
+    }
+    out_buffer_.reset(new uint8_t[kBufferSize]);
+    memset(&zstream_, 0, sizeof(zstream_));
+    // 16 + MAX_WBITS asks for a gzip header and trailer rather than the zlib ones.
+    int rc = deflateInit2(&zstream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                          Z_DEFAULT_STRATEGY);
+    if (rc != Z_OK) {
+      LOG(ERROR) << "hprof: deflateInit2 failed: " << rc;
+      compress_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  bool WriteToFile(const void* data, size_t size) {
+    if (!file_->WriteFully(data, size)) {
+      return false;
+    }
+    *bytes_written_ += size;
+    return true;
+  }
+
+  // Compresses the input and writes out whatever deflate produced, until it is done with flush.
+  bool Deflate(int flush) {
+    int rc;
+    do {
+      zstream_.next_out = out_buffer_.get();
+      zstream_.avail_out = kBufferSize;
+      rc = deflate(&zstream_, flush);
+      if (rc == Z_STREAM_ERROR) {
+        return false;
+      }
+      if (!WriteToFile(out_buffer_.get(), kBufferSize - zstream_.avail_out)) {
+        return false;
+      }
+    } while (zstream_.avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+    return true;
+  }
+
+  bool Write(const char* data, size_t size) {
+    if (!compress_) {
+      return WriteToFile(data, size);
+    }
+    zstream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zstream_.avail_in = size;
+    return Deflate(Z_NO_FLUSH);
+  }
+
+  bool Close() {
+    bool okay = !compress_ || Deflate(Z_FINISH);
+    return file_->Close() == 0 && okay;
+  }
+
+#if defined(__GLIBC__)
+  // fopencookie treats a short write, 0 included, as an error.
+  static ssize_t WriteCallback(void* cookie, const char* data, size_t size) {
+    return reinterpret_cast<HprofOutputStream*>(cookie)->Write(data, size) ? size : 0;
+  }
+#else
+  static int WriteCallback(void* cookie, const char* data, int size) {
+    return reinterpret_cast<HprofOutputStream*>(cookie)->Write(data, size) ? size : -1;
+  }
+#endif
+
+  static int CloseCallback(void* cookie) {
+    UniquePtr<HprofOutputStream> stream(reinterpret_cast<HprofOutputStream*>(cookie));
+    return stream->Close() ? 0 : -1;
+  }
+
+  UniquePtr<File> file_;
+  bool compress_;
+  size_t* const bytes_written_;
+  z_stream zstream_;
+  UniquePtr<uint8_t[]> out_buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HprofOutputStream);
+};
+
 class Hprof {
  public:
   Hprof(const char* output_filename, int fd, bool direct_to_ddms)
@@ -372,6 +501,7 @@ class Hprof {
         direct_to_ddms_(direct_to_ddms),
         start_ns_(NanoTime()),
         current_record_(),
+        table_record_(),
         gc_thread_serial_number_(0),
         gc_scan_state_(0),
         current_heap_(HPROF_HEAP_DEFAULT),
@@ -382,25 +512,18 @@ class Hprof {
         body_fp_(NULL),
         body_data_ptr_(NULL),
         body_data_size_(0),
-        next_string_id_(0x400000) {
+        streaming_(false),
+        stream_size_(0),
+        next_string_id_(0x400000),
+        next_class_serial_number_(1) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
-
-    header_fp_ = open_memstream(&header_data_ptr_, &header_data_size_);
-    if (header_fp_ == NULL) {
-      PLOG(FATAL) << "header open_memstream failed";
-    }
-
-    body_fp_ = open_memstream(&body_data_ptr_, &body_data_size_);
-    if (body_fp_ == NULL) {
-      PLOG(FATAL) << "body open_memstream failed";
-    }
   }
 
   ~Hprof() {
     if (header_fp_ != NULL) {
       fclose(header_fp_);
     }
-    if (body_fp_ != NULL) {
+    if (body_fp_ != NULL && body_fp_ != header_fp_) {
       fclose(body_fp_);
     }
     free(header_data_ptr_);
@@ -410,6 +533,34 @@ class Hprof {
   void Dump()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::heap_bitmap_lock_) {
+    if (direct_to_ddms_) {
+      // DDMS takes the dump as a single chunk, build it in memory. The body is written first as
+      // the string and class tables are only known once the heap has been walked.
+      header_fp_ = open_memstream(&header_data_ptr_, &header_data_size_);
+      if (header_fp_ == NULL) {
+        PLOG(FATAL) << "header open_memstream failed";
+      }
+      body_fp_ = open_memstream(&body_data_ptr_, &body_data_size_);
+      if (body_fp_ == NULL) {
+        PLOG(FATAL) << "body open_memstream failed";
+      }
+    } else {
+      // Stream the dump to the output through a fixed-size buffer. Strings and classes are written
+      // as they are discovered, ahead of the heap dump segment referring to them.
+      header_fp_ = OpenOutput();
+      if (header_fp_ == NULL) {
+        return;
+      }
+      body_fp_ = header_fp_;
+      streaming_ = true;
+      WriteFixedHeader();
+    }
+    CollectAllocSites();
+    if (streaming_) {
+      WriteStackTraces();
+      WriteAllocSites();
+    }
+
     // Walk the roots and the heap.
     current_record_.StartNewRecord(body_fp_, HPROF_TAG_HEAP_DUMP_SEGMENT, HPROF_TIME);
     Runtime::Current()->VisitRoots(RootVisitor, this, false, false);
@@ -424,20 +575,34 @@ class Hprof {
     }
     current_record_.StartNewRecord(body_fp_, HPROF_TAG_HEAP_DUMP_END, HPROF_TIME);
     current_record_.Flush();
-    fflush(body_fp_);
-
-    // Write the header.
-    WriteFixedHeader();
-    // Write the string and class tables, and any stack traces, to the header.
-    // (jhat requires that these appear before any of the data in the body that refers to them.)
-    WriteStringTable();
-    WriteClassTable();
-    WriteStackTraces();
-    current_record_.Flush();
-    fflush(header_fp_);
 
     bool okay = true;
-    if (direct_to_ddms_) {
+    size_t dump_size;
+    if (streaming_) {
+      okay = ferror(body_fp_) == 0;
+      okay = fclose(body_fp_) == 0 && okay;
+      header_fp_ = body_fp_ = NULL;
+      dump_size = stream_size_;
+      if (!okay) {
+        std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
+                                     filename_.c_str(), strerror(errno)));
+        ThrowRuntimeException("%s", msg.c_str());
+        LOG(ERROR) << msg;
+      }
+    } else {
+      fflush(body_fp_);
+
+      // Write the header.
+      WriteFixedHeader();
+      // Write the string and class tables, and any stack traces, to the header.
+      // (jhat requires that these appear before any of the data in the body that refers to them.)
+      WriteStringTable();
+      WriteClassTable();
+      WriteStackTraces();
+      WriteAllocSites();
+      current_record_.Flush();
+      fflush(header_fp_);
+
       // Send the data off to DDMS.
       iovec iov[2];
       iov[0].iov_base = header_data_ptr_;
@@ -445,40 +610,14 @@ class Hprof {
       iov[1].iov_base = body_data_ptr_;
       iov[1].iov_len = body_data_size_;
       Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
-    } else {
-      // Where exactly are we writing to?
-      int out_fd;
-      if (fd_ >= 0) {
-        out_fd = dup(fd_);
-        if (out_fd < 0) {
-          ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
-          return;
-        }
-      } else {
-        out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
-        if (out_fd < 0) {
-          ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
-                                strerror(errno));
-          return;
-        }
-      }
-
-      UniquePtr<File> file(new File(out_fd, filename_));
-      okay = file->WriteFully(header_data_ptr_, header_data_size_) &&
-          file->WriteFully(body_data_ptr_, body_data_size_);
-      if (!okay) {
-        std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
-                                     filename_.c_str(), strerror(errno)));
-        ThrowRuntimeException("%s", msg.c_str());
-        LOG(ERROR) << msg;
-      }
+      dump_size = header_data_size_ + body_data_size_;
     }
 
     // Throw out a log message for the benefit of "runhat".
     if (okay) {
       uint64_t duration = NanoTime() - start_ns_;
       LOG(INFO) << "hprof: heap dump completed ("
-          << PrettySize(header_data_size_ + body_data_size_ + 1023)
+          << PrettySize(dump_size + 1023)
           << ") in " << PrettyDuration(duration);
     }
   }
@@ -506,60 +645,89 @@ class Hprof {
   void Finish() {
   }
 
-  int WriteClassTable() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
-    HprofRecord* rec = &current_record_;
-    uint32_t nextSerialNumber = 1;
+  // Opens the output file, or a duplicate of fd_, as a stream compressed when the file name ends
+  // in ".gz". Throws and returns NULL on failure.
+  FILE* OpenOutput() {
+    int out_fd;
+    if (fd_ >= 0) {
+      out_fd = dup(fd_);
+      if (out_fd < 0) {
+        ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
+        return NULL;
+      }
+    } else {
+      out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+      if (out_fd < 0) {
+        ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
+                              strerror(errno));
+        return NULL;
+      }
+    }
+    FILE* fp = HprofOutputStream::Open(new File(out_fd, filename_), EndsWith(filename_, ".gz"),
+                                       &stream_size_);
+    if (fp == NULL) {
+      ThrowRuntimeException("Couldn't dump heap; opening a stream on \"%s\" failed",
+                            filename_.c_str());
+    }
+    return fp;
+  }
 
+  int WriteClassTable() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     for (ClassSetIterator it = classes_.begin(); it != classes_.end(); ++it) {
-      const mirror::Class* c = *it;
-      CHECK(c != NULL);
-
-      int err = current_record_.StartNewRecord(header_fp_, HPROF_TAG_LOAD_CLASS, HPROF_TIME);
+      int err = WriteLoadClassRecord(&current_record_, *it);
       if (err != 0) {
         return err;
       }
+    }
+    return 0;
+  }
+
+  int WriteLoadClassRecord(HprofRecord* rec, mirror::Class* c)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    CHECK(c != NULL);
 
-      // LOAD CLASS format:
-      // U4: class serial number (always > 0)
-      // ID: class object ID. We use the address of the class object structure as its ID.
-      // U4: stack trace serial number
-      // ID: class name string ID
-      rec->AddU4(nextSerialNumber++);
-      rec->AddId((HprofClassObjectId) c);
-      rec->AddU4(HPROF_NULL_STACK_TRACE);
-      rec->AddId(LookupClassNameId(c));
+    int err = rec->StartNewRecord(header_fp_, HPROF_TAG_LOAD_CLASS, HPROF_TIME);
+    if (err != 0) {
+      return err;
     }
 
+    // LOAD CLASS format:
+    // U4: class serial number (always > 0)
+    // ID: class object ID. We use the address of the class object structure as its ID.
+    // U4: stack trace serial number
+    // ID: class name string ID
+    rec->AddU4(class_serial_numbers_.Get(c));
+    rec->AddId((HprofClassObjectId) c);
+    rec->AddU4(HPROF_NULL_STACK_TRACE);
+    rec->AddId(LookupClassNameId(c));
     return 0;
   }
 
   int WriteStringTable() {
-    HprofRecord* rec = &current_record_;
-
     for (StringMapIterator it = strings_.begin(); it != strings_.end(); ++it) {
-      std::string string((*it).first);
-      size_t id = (*it).second;
-
-      int err = current_record_.StartNewRecord(header_fp_, HPROF_TAG_STRING, HPROF_TIME);
+      int err = WriteStringRecord(&current_record_, (*it).first, (*it).second);
       if (err != 0) {
         return err;
       }
+    }
+    return 0;
+  }
 
-      // STRING format:
-      // ID:  ID for this string
-      // U1*: UTF8 characters for string (NOT NULL terminated)
-      //      (the record format encodes the length)
-      err = rec->AddU4(id);
-      if (err != 0) {
-        return err;
-      }
-      err = rec->AddUtf8String(string.c_str());
-      if (err != 0) {
-        return err;
-      }
+  int WriteStringRecord(HprofRecord* rec, const std::string& string, HprofStringId id) {
+    int err = rec->StartNewRecord(header_fp_, HPROF_TAG_STRING, HPROF_TIME);
+    if (err != 0) {
+      return err;
     }
 
-    return 0;
+    // STRING format:
+    // ID:  ID for this string
+    // U1*: UTF8 characters for string (NOT NULL terminated)
+    //      (the record format encodes the length)
+    err = rec->AddU4(id);
+    if (err != 0) {
+      return err;
+    }
+    return rec->AddUtf8String(string.c_str());
   }
 
   void StartNewHeapDumpSegment() {
@@ -586,6 +754,16 @@ class Hprof {
     // Make sure that we've assigned a string ID for this class' name
     LookupClassNameId(c);
 
+    if (result.second) {
+      class_serial_numbers_.Put(c, next_class_serial_number_++);
+      if (streaming_) {
+        // The record under construction in current_record_ is written later, so this class is
+        // written out before the first record that refers to it.
+        WriteLoadClassRecord(&table_record_, c);
+        table_record_.Flush();
+      }
+    }
+
     CHECK_EQ(present, c);
     return (HprofStringId) present;
   }
@@ -605,6 +783,10 @@ class Hprof {
     }
     HprofStringId id = next_string_id_++;
     strings_.Put(string, id);
+    if (streaming_) {
+      WriteStringRecord(&table_record_, string, id);
+      table_record_.Flush();
+    }
     return id;
   }
 
@@ -643,13 +825,15 @@ class Hprof {
     fwrite(buf, 1, sizeof(uint32_t), header_fp_);  // xxx fix the time
   }
 
-  void WriteStackTraces() {
-    // Write a dummy stack trace record so the analysis tools don't freak out.
-    current_record_.StartNewRecord(header_fp_, HPROF_TAG_STACK_TRACE, HPROF_TIME);
-    current_record_.AddU4(HPROF_NULL_STACK_TRACE);
-    current_record_.AddU4(HPROF_NULL_THREAD);
-    current_record_.AddU4(0);    // no frames
-  }
+  // Fetches the sites sampled by the heap's allocation sampler and looks up the strings and
+  // classes their records refer to, so that they make it into the string and class tables.
+  void CollectAllocSites() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Writes a stack trace, and its frames, for every sampled allocation site.
+  int WriteStackTraces() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Writes the allocation sites histogram, referring to the stack traces of WriteStackTraces.
+  int WriteAllocSites() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   // If direct_to_ddms_ is set, "filename_" and "fd" will be ignored.
   // Otherwise, "filename_" must be valid, though if "fd" >= 0 it will
@@ -662,6 +846,9 @@ class Hprof {
 
   HprofRecord current_record_;
 
+  // Used to write strings and classes when streaming, while current_record_ is still being built.
+  HprofRecord table_record_;
+
   uint32_t gc_thread_serial_number_;
   uint8_t gc_scan_state_;
   HprofHeapId current_heap_;  // Which heap we're currently dumping.
@@ -675,10 +862,24 @@ class Hprof {
   char* body_data_ptr_;
   size_t body_data_size_;
 
+  // Whether the dump is written straight to the output file, in which case header_fp_ and body_fp_
+  // are the same stream.
+  bool streaming_;
+
+  // Number of bytes written to the output file when streaming.
+  size_t stream_size_;
+
   ClassSet classes_;
   size_t next_string_id_;
   StringMap strings_;
 
+  // Serial numbers given to the classes as they are looked up.
+  uint32_t next_class_serial_number_;
+  SafeMap<const mirror::Class*, uint32_t> class_serial_numbers_;
+
+  // Sampled allocation sites, the stack trace of the site at index i has serial number i + 1.
+  std::vector<std::pair<gc::AllocationSite, gc::AllocationSiteStats> > alloc_sites_;
+
   DISALLOW_COPY_AND_ASSIGN(Hprof);
 };
 
@@ -740,6 +941,152 @@ static HprofBasicType PrimitiveToBasicTypeAndSize(Primitive::Type prim, size_t*
   return ret;
 }
 
+static const char* GetSourceFileName(MethodHelper& mh) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  const char* source_file = mh.GetDeclaringClassSourceFile();
+  return source_file != NULL ? source_file : "";
+}
+
+void Hprof::CollectAllocSites() {
+  gc::AllocationSampler* sampler = Runtime::Current()->GetHeap()->GetAllocationSampler();
+  if (!sampler->IsEnabled()) {
+    return;
+  }
+  sampler->GetSites(&alloc_sites_);
+  for (const auto& entry : alloc_sites_) {
+    const gc::AllocationSite& site = entry.first;
+    LookupClassId(site.klass);
+    for (size_t i = 0; i < site.depth; ++i) {
+      mirror::ArtMethod* m = site.frames[i].method;
+      MethodHelper mh(m);
+      LookupClassId(m->GetDeclaringClass());
+      LookupStringId(mh.GetName());
+      LookupStringId(mh.GetSignature());
+      LookupStringId(GetSourceFileName(mh));
+    }
+  }
+}
+
+int Hprof::WriteStackTraces() {
+  HprofRecord* rec = &current_record_;
+
+  // Write a dummy stack trace record so the analysis tools don't freak out.
+  int err = rec->StartNewRecord(header_fp_, HPROF_TAG_STACK_TRACE, HPROF_TIME);
+  if (err != 0) {
+    return err;
+  }
+  rec->AddU4(HPROF_NULL_STACK_TRACE);
+  rec->AddU4(HPROF_NULL_THREAD);
+  rec->AddU4(0);    // no frames
+
+  HprofId next_frame_id = 1;
+  for (size_t i = 0; i < alloc_sites_.size(); ++i) {
+    const gc::AllocationSite& site = alloc_sites_[i].first;
+    const HprofId first_frame_id = next_frame_id;
+    for (size_t j = 0; j < site.depth; ++j) {
+      err = rec->StartNewRecord(header_fp_, HPROF_TAG_STACK_FRAME, HPROF_TIME);
+      if (err != 0) {
+        return err;
+      }
+      mirror::ArtMethod* m = site.frames[j].method;
+      MethodHelper mh(m);
+      int32_t line_number = m->IsNative() ? -3 : mh.GetLineNumFromDexPC(site.frames[j].dex_pc);
+
+      // STACK FRAME format:
+      // ID: stack frame ID
+      // ID: method name string ID
+      // ID: method signature string ID
+      // ID: source file name string ID
+      // U4: class serial number
+      // U4: line number, -1 if unknown and -3 for native methods
+      rec->AddId(next_frame_id++);
+      rec->AddId(LookupStringId(mh.GetName()));
+      rec->AddId(LookupStringId(mh.GetSignature()));
+      rec->AddId(LookupStringId(GetSourceFileName(mh)));
+      rec->AddU4(class_serial_numbers_.Get(m->GetDeclaringClass()));
+      rec->AddU4(static_cast<uint32_t>(line_number));
+    }
+
+    err = rec->StartNewRecord(header_fp_, HPROF_TAG_STACK_TRACE, HPROF_TIME);
+    if (err != 0) {
+      return err;
+    }
+    // STACK TRACE format:
+    // U4: stack trace serial number
+    // U4: thread serial number
+    // U4: number of frames
+    // ID*: stack frame IDs, innermost first
+    rec->AddU4(i + 1);
+    rec->AddU4(HPROF_NULL_THREAD);
+    rec->AddU4(site.depth);
+    for (HprofId id = first_frame_id; id != next_frame_id; ++id) {
+      rec->AddId(id);
+    }
+  }
+  return 0;
+}
+
+int Hprof::WriteAllocSites() {
+  if (alloc_sites_.empty()) {
+    return 0;
+  }
+  HprofRecord* rec = &current_record_;
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  const uint64_t sample_interval = heap->GetAllocationSampler()->GetSampleInterval();
+  const uint64_t max_u4 = std::numeric_limits<uint32_t>::max();
+  uint64_t total_samples = 0;
+  for (const auto& entry : alloc_sites_) {
+    total_samples += entry.second.samples;
+  }
+
+  int err = rec->StartNewRecord(header_fp_, HPROF_TAG_ALLOC_SITES, HPROF_TIME);
+  if (err != 0) {
+    return err;
+  }
+  // ALLOC SITES format, allocated bytes are estimated from the number of samples and allocated
+  // instances are the number of samples:
+  // U2: flags, 0x2 as the sites are sorted by allocation rather than by live bytes
+  // U4: cutoff ratio, a float
+  // U4: total live bytes
+  // U4: total live instances
+  // U8: total bytes allocated
+  // U8: total instances allocated
+  // U4: number of sites
+  rec->AddU2(0x2);
+  rec->AddU4(0);
+  rec->AddU4(heap->GetBytesAllocated());
+  rec->AddU4(heap->GetObjectsAllocated());
+  rec->AddU8(total_samples * sample_interval);
+  rec->AddU8(total_samples);
+  rec->AddU4(alloc_sites_.size());
+  for (size_t i = 0; i < alloc_sites_.size(); ++i) {
+    mirror::Class* c = alloc_sites_[i].first.klass;
+    const uint64_t samples = alloc_sites_[i].second.samples;
+    uint8_t array_type = 0;
+    if (c->IsArrayClass()) {
+      mirror::Class* component_type = c->GetComponentType();
+      array_type = component_type->IsPrimitive()
+          ? PrimitiveToBasicTypeAndSize(component_type->GetPrimitiveType(), NULL)
+          : hprof_basic_object;
+    }
+    // Per site:
+    // U1: 0 for instances, 2 for object arrays or the basic type of primitive arrays
+    // U4: class serial number
+    // U4: stack trace serial number
+    // U4: live bytes, unknown as objects aren't tracked after being sampled
+    // U4: live instances, unknown
+    // U4: bytes allocated
+    // U4: instances allocated
+    rec->AddU1(array_type);
+    rec->AddU4(class_serial_numbers_.Get(c));
+    rec->AddU4(i + 1);
+    rec->AddU4(0);
+    rec->AddU4(0);
+    rec->AddU4(std::min(samples * sample_interval, max_u4));
+    rec->AddU4(std::min(samples, max_u4));
+  }
+  return 0;
+}
+
 // Always called when marking objects, but only does
 // something when ctx->gc_scan_state_ is non-zero, which is usually
 // only true when marking the root set or unreachable
@@ -1075,6 +1422,7 @@ void Hprof::VisitRoot(const mirror::Object* obj) {
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
+// Output to a file is streamed, and gzip compressed if "filename" ends in ".gz".
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
   CHECK(filename != NULL);
 
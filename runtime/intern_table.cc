@@ -24,68 +24,95 @@
 #include "thread.h"
 #include "UniquePtr.h"
 #include "utf.h"
+#include "utils.h"
 
 namespace art {
 
+// Matches strings equal to a given string.
+class StringEquals {
+ public:
+  explicit StringEquals(const mirror::String* s) : s_(s) {}
+
+  bool operator()(const mirror::String* string) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return string->Equals(s_);
+  }
+
+ private:
+  const mirror::String* const s_;
+};
+
+// Matches strings equal to a given modified UTF-8 string.
+class StringEqualsModifiedUtf8 {
+ public:
+  explicit StringEqualsModifiedUtf8(const char* utf8) : utf8_(utf8) {}
+
+  bool operator()(const mirror::String* string) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return string->Equals(utf8_);
+  }
+
+ private:
+  const char* const utf8_;
+};
+
+InternTable::Stripe::Stripe()
+    : lock("InternTable stripe lock"), is_dirty(false), strong_interns(true),
+      weak_interns(true) {
+}
+
 InternTable::InternTable()
-    : intern_table_lock_("InternTable lock"), is_dirty_(false), allow_new_interns_(true),
+    : intern_table_lock_("InternTable lock"), allow_new_interns_(true),
       new_intern_condition_("New intern condition", intern_table_lock_) {
 }
 
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), intern_table_lock_);
-  return strong_interns_.size() + weak_interns_.size();
+  Thread* self = Thread::Current();
+  size_t size = 0;
+  for (const Stripe& stripe : stripes_) {
+    MutexLock mu(self, stripe.lock);
+    size += stripe.strong_interns.Size() + stripe.weak_interns.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
-  MutexLock mu(Thread::Current(), intern_table_lock_);
-  os << "Intern table: " << strong_interns_.size() << " strong; "
-     << weak_interns_.size() << " weak\n";
+  Thread* self = Thread::Current();
+  size_t num_strong = 0;
+  size_t num_weak = 0;
+  for (const Stripe& stripe : stripes_) {
+    MutexLock mu(self, stripe.lock);
+    num_strong += stripe.strong_interns.Size();
+    num_weak += stripe.weak_interns.Size();
+  }
+  os << "Intern table: " << num_strong << " strong; " << num_weak << " weak\n";
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, void* arg,
                              bool only_dirty, bool clean_dirty) {
-  MutexLock mu(Thread::Current(), intern_table_lock_);
-  if (!only_dirty || is_dirty_) {
-    for (const auto& strong_intern : strong_interns_) {
-      visitor(strong_intern.second, arg);
-    }
-    if (clean_dirty) {
-      is_dirty_ = false;
+  Thread* self = Thread::Current();
+  auto root_visitor = [visitor, arg](mirror::String* string) {
+    visitor(string, arg);
+    return true;
+  };
+  for (Stripe& stripe : stripes_) {
+    MutexLock mu(self, stripe.lock);
+    if (!only_dirty || stripe.is_dirty) {
+      stripe.strong_interns.Visit(root_visitor);
+      if (clean_dirty) {
+        stripe.is_dirty = false;
+      }
     }
   }
-  // Note: we deliberately don't visit the weak_interns_ table and the immutable
+  // Note: we deliberately don't visit the weak_interns tables and the immutable
   // image roots.
 }
 
-mirror::String* InternTable::Lookup(Table& table, mirror::String* s,
-                                    uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  for (auto it = table.find(hash_code), end = table.end(); it != end; ++it) {
-    mirror::String* existing_string = it->second;
-    if (existing_string->Equals(s)) {
-      return existing_string;
-    }
-  }
-  return NULL;
-}
-
-mirror::String* InternTable::Insert(Table& table, mirror::String* s,
-                                    uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  table.insert(std::make_pair(hash_code, s));
-  return s;
-}
-
-void InternTable::Remove(Table& table, const mirror::String* s,
-                         uint32_t hash_code) {
-  intern_table_lock_.AssertHeld(Thread::Current());
-  for (auto it = table.find(hash_code), end = table.end(); it != end; ++it) {
-    if (it->second == s) {
-      table.erase(it);
-      return;
-    }
-  }
+mirror::String* InternTable::Lookup(Stripe& stripe, Table& table, mirror::String* s,
+                                    int32_t hash_code) {
+  stripe.lock.AssertHeld(Thread::Current());
+  StringEquals matcher(s);
+  return table.Find(hash_code, matcher);
 }
 
 static mirror::String* LookupStringFromImage(mirror::String* s)
@@ -127,73 +154,105 @@ void InternTable::DisallowNewInterns() {
 }
 
 mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
-  Thread* self = Thread::Current();
-  MutexLock mu(self, intern_table_lock_);
-
   DCHECK(s != NULL);
-  uint32_t hash_code = s->GetHashCode();
+  int32_t hash_code = s->GetHashCode();
+  Stripe& stripe = GetStripe(hash_code);
+
+  // Both kinds of intern return a match from the strong table, which can be found without the
+  // lock. Only a miss needs to take it.
+  StringEquals matcher(s);
+  mirror::String* lock_free_strong = stripe.strong_interns.Find(hash_code, matcher);
+  if (lock_free_strong != NULL) {
+    return lock_free_strong;
+  }
+
+  Thread* self = Thread::Current();
+  if (UNLIKELY(!allow_new_interns_)) {
+    MutexLock mu(self, intern_table_lock_);
+    while (!allow_new_interns_) {
+      new_intern_condition_.WaitHoldingLocks(self);
+    }
+  }
 
-  while (UNLIKELY(!allow_new_interns_)) {
-    new_intern_condition_.WaitHoldingLocks(self);
+  if (!is_strong) {
+    // Weak interns aren't swept while interns are allowed, see Stripe.
+    mirror::String* lock_free_weak = stripe.weak_interns.Find(hash_code, matcher);
+    if (lock_free_weak != NULL) {
+      return lock_free_weak;
+    }
   }
 
+  MutexLock mu(self, stripe.lock);
+
   if (is_strong) {
     // Check the strong table for a match.
-    mirror::String* strong = Lookup(strong_interns_, s, hash_code);
+    mirror::String* strong = Lookup(stripe, stripe.strong_interns, s, hash_code);
     if (strong != NULL) {
       return strong;
     }
 
     // Mark as dirty so that we rescan the roots.
-    is_dirty_ = true;
+    stripe.is_dirty = true;
 
     // Check the image for a match.
     mirror::String* image = LookupStringFromImage(s);
     if (image != NULL) {
-      return Insert(strong_interns_, image, hash_code);
+      stripe.strong_interns.Insert(hash_code, image);
+      return image;
     }
 
     // There is no match in the strong table, check the weak table.
-    mirror::String* weak = Lookup(weak_interns_, s, hash_code);
+    mirror::String* weak = Lookup(stripe, stripe.weak_interns, s, hash_code);
     if (weak != NULL) {
       // A match was found in the weak table. Promote to the strong table.
-      Remove(weak_interns_, weak, hash_code);
-      return Insert(strong_interns_, weak, hash_code);
+      stripe.weak_interns.Remove(hash_code, weak);
+      stripe.strong_interns.Insert(hash_code, weak);
+      return weak;
     }
 
     // No match in the strong table or the weak table. Insert into the strong
     // table.
-    return Insert(strong_interns_, s, hash_code);
+    stripe.strong_interns.Insert(hash_code, s);
+    return s;
   }
 
   // Check the strong table for a match.
-  mirror::String* strong = Lookup(strong_interns_, s, hash_code);
+  mirror::String* strong = Lookup(stripe, stripe.strong_interns, s, hash_code);
   if (strong != NULL) {
     return strong;
   }
   // Check the image for a match.
   mirror::String* image = LookupStringFromImage(s);
   if (image != NULL) {
-    return Insert(weak_interns_, image, hash_code);
+    stripe.weak_interns.Insert(hash_code, image);
+    return image;
   }
   // Check the weak table for a match.
-  mirror::String* weak = Lookup(weak_interns_, s, hash_code);
+  mirror::String* weak = Lookup(stripe, stripe.weak_interns, s, hash_code);
   if (weak != NULL) {
     return weak;
   }
   // Insert into the weak table.
-  return Insert(weak_interns_, s, hash_code);
+  stripe.weak_interns.Insert(hash_code, s);
+  return s;
 }
 
 mirror::String* InternTable::InternStrong(int32_t utf16_length,
                                           const char* utf8_data) {
+  // Resolving a const string usually finds it interned already, so look for it before
+  // allocating a string to intern.
+  StringEqualsModifiedUtf8 matcher(utf8_data);
+  int32_t hash_code = ComputeUtf16HashFromModifiedUtf8(utf8_data);
+  mirror::String* strong = GetStripe(hash_code).strong_interns.Find(hash_code, matcher);
+  if (strong != NULL) {
+    return strong;
+  }
   return InternStrong(mirror::String::AllocFromModifiedUtf8(
       Thread::Current(), utf16_length, utf8_data));
 }
 
 mirror::String* InternTable::InternStrong(const char* utf8_data) {
-  return InternStrong(
-      mirror::String::AllocFromModifiedUtf8(Thread::Current(), utf8_data));
+  return InternStrong(CountModifiedUtf8Chars(utf8_data), utf8_data);
 }
 
 mirror::String* InternTable::InternStrong(mirror::String* s) {
@@ -211,21 +270,21 @@ mirror::String* InternTable::InternWeak(mirror::String* s) {
 }
 
 bool InternTable::ContainsWeak(mirror::String* s) {
-  MutexLock mu(Thread::Current(), intern_table_lock_);
-  const mirror::String* found = Lookup(weak_interns_, s, s->GetHashCode());
+  int32_t hash_code = s->GetHashCode();
+  Stripe& stripe = GetStripe(hash_code);
+  MutexLock mu(Thread::Current(), stripe.lock);
+  const mirror::String* found = Lookup(stripe, stripe.weak_interns, s, hash_code);
   return found == s;
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedTester is_marked, void* arg) {
-  MutexLock mu(Thread::Current(), intern_table_lock_);
-  // TODO: std::remove_if + lambda.
-  for (auto it = weak_interns_.begin(), end = weak_interns_.end(); it != end;) {
-    mirror::Object* object = it->second;
-    if (!is_marked(object, arg)) {
-      weak_interns_.erase(it++);
-    } else {
-      ++it;
-    }
+  Thread* self = Thread::Current();
+  auto is_unmarked = [is_marked, arg](mirror::String* string) {
+    return !is_marked(string, arg);
+  };
+  for (Stripe& stripe : stripes_) {
+    MutexLock mu(self, stripe.lock);
+    stripe.weak_interns.RemoveIf(is_unmarked);
   }
 }
 
@@ -17,11 +17,11 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include "base/macros.h"
 #include "base/mutex.h"
+#include "open_addressing_table.h"
 #include "root_visitor.h"
 
-#include <map>
-
 namespace art {
 namespace mirror {
 class String;
@@ -70,22 +70,53 @@ class InternTable {
   void AllowNewInterns() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
  private:
-  typedef std::multimap<int32_t, mirror::String*> Table;
+  // Strings keyed by String::GetHashCode.
+  typedef OpenAddressingTable<mirror::String> Table;
+
+  // Interns are spread over stripes by hash code, each with its own lock, so that threads
+  // interning different strings rarely contend. The tables of a stripe are only modified with
+  // its lock held, but are also searched without it, see OpenAddressingTable for what such a
+  // search may see. A lock-free hit is a valid result as long as the string can't concurrently
+  // stop being interned:
+  //  - Strong interns are never removed.
+  //  - Weak interns are removed when promoted to strong ones, which keeps them interned, and by
+  //    sweeping, which runs with mutators suspended or while new interns are disallowed. Lock-free
+  //    weak lookups happen only once interns are allowed, with the mutator lock held so that they
+  //    can't be disallowed until the lookup is done.
+  // A lock-free miss is retried with the stripe's lock held.
+  struct Stripe {
+    Stripe();
+
+    mutable Mutex lock;
+    bool is_dirty GUARDED_BY(lock);
+    Table strong_interns;
+    Table weak_interns;
+  };
+
+  static const size_t kStripeBits = 4;
+  static const size_t kNumStripes = 1 << kStripeBits;
+
+  // Picks the stripe from the top bits of a multiplicative hash, as the tables probe from the
+  // hash code's low bits.
+  Stripe& GetStripe(int32_t hash_code) {
+    return stripes_[(static_cast<uint32_t>(hash_code) * 0x9e3779b9U) >> (32 - kStripeBits)];
+  }
 
   mirror::String* Insert(mirror::String* s, bool is_strong)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  mirror::String* Lookup(Table& table, mirror::String* s, uint32_t hash_code)
+  mirror::String* Lookup(Stripe& stripe, Table& table, mirror::String* s, int32_t hash_code)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  mirror::String* Insert(Table& table, mirror::String* s, uint32_t hash_code);
-  void Remove(Table& table, const mirror::String* s, uint32_t hash_code);
 
+  Stripe stripes_[kNumStripes];
+
+  // Only guards allow_new_interns_ changes and waits for new_intern_condition_.
   mutable Mutex intern_table_lock_;
-  bool is_dirty_ GUARDED_BY(intern_table_lock_);
-  bool allow_new_interns_ GUARDED_BY(intern_table_lock_);
+  // Written with intern_table_lock_ held. Read without it by interning threads, which hold the
+  // mutator lock that DisallowNewInterns needs exclusively, so a read can't go stale while they
+  // intern.
+  volatile bool allow_new_interns_;
   ConditionVariable new_intern_condition_ GUARDED_BY(intern_table_lock_);
-  Table strong_interns_ GUARDED_BY(intern_table_lock_);
-  Table weak_interns_ GUARDED_BY(intern_table_lock_);
 };
 
 }  // namespace art
@@ -19,6 +19,7 @@
 #include "common_test.h"
 #include "mirror/object.h"
 #include "sirt_ref.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -54,6 +55,83 @@ TEST_F(InternTableTest, Size) {
   EXPECT_EQ(2U, t.Size());
 }
 
+TEST_F(InternTableTest, ManyStrings) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  const size_t kNumStrings = 1000;
+  std::vector<mirror::String*> strong;
+  for (size_t i = 0; i < kNumStrings; ++i) {
+    strong.push_back(t.InternStrong(StringPrintf("strong%zd", i).c_str()));
+  }
+  EXPECT_EQ(kNumStrings, t.Size());
+  for (size_t i = 0; i < kNumStrings; ++i) {
+    std::string utf8(StringPrintf("strong%zd", i));
+    EXPECT_EQ(strong[i], t.InternStrong(utf8.c_str()));
+    SirtRef<mirror::String> s(soa.Self(),
+                              mirror::String::AllocFromModifiedUtf8(soa.Self(), utf8.c_str()));
+    EXPECT_EQ(strong[i], t.InternWeak(s.get()));
+  }
+  EXPECT_EQ(kNumStrings, t.Size());
+}
+
+// Interns the same strong and weak strings as every other task, recording the results.
+class InternTask : public Task {
+ public:
+  InternTask(InternTable* intern_table, std::vector<mirror::String*>* strong,
+             std::vector<mirror::String*>* weak)
+      : intern_table_(intern_table), strong_(strong), weak_(weak) {}
+
+  void Run(Thread* self) {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i < strong_->size(); ++i) {
+      (*strong_)[i] = intern_table_->InternStrong(StringPrintf("strong%zd", i).c_str());
+      SirtRef<mirror::String> s(self, mirror::String::AllocFromModifiedUtf8(
+          self, StringPrintf("weak%zd", i).c_str()));
+      (*weak_)[i] = intern_table_->InternWeak(s.get());
+    }
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  InternTable* const intern_table_;
+  std::vector<mirror::String*>* const strong_;
+  std::vector<mirror::String*>* const weak_;
+};
+
+TEST_F(InternTableTest, ConcurrentInterns) {
+  Thread* self = Thread::Current();
+  InternTable t;
+  const size_t kNumThreads = 4;
+  const size_t kNumStrings = 500;
+  std::vector<std::vector<mirror::String*> > strong(kNumThreads,
+                                                    std::vector<mirror::String*>(kNumStrings));
+  std::vector<std::vector<mirror::String*> > weak(kNumThreads,
+                                                  std::vector<mirror::String*>(kNumStrings));
+  ThreadPool thread_pool(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    thread_pool.AddTask(self, new InternTask(&t, &strong[i], &weak[i]));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+
+  // Every thread got the same string for the same contents, and each was interned once.
+  ScopedObjectAccess soa(self);
+  EXPECT_EQ(2 * kNumStrings, t.Size());
+  for (size_t i = 0; i < kNumStrings; ++i) {
+    EXPECT_TRUE(strong[0][i]->Equals(StringPrintf("strong%zd", i).c_str()));
+    EXPECT_TRUE(weak[0][i]->Equals(StringPrintf("weak%zd", i).c_str()));
+    EXPECT_FALSE(t.ContainsWeak(strong[0][i]));
+    EXPECT_TRUE(t.ContainsWeak(weak[0][i]));
+    for (size_t j = 1; j < kNumThreads; ++j) {
+      EXPECT_EQ(strong[0][i], strong[j][i]);
+      EXPECT_EQ(weak[0][i], weak[j][i]);
+    }
+  }
+}
+
 class TestPredicate {
  public:
   bool IsMarked(const mirror::Object* s) const {
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "inline_cache.h"
+
+#include "thread.h"
+
+namespace art {
+namespace interpreter {
+
+InlineCacheTable::Stripe::Stripe() : lock("interpreter inline cache lock") {
+}
+
+InlineCacheTable::InlineCacheTable() {
+}
+
+void InlineCacheTable::AddReceiverType(const mirror::ArtMethod* caller, uint32_t dex_pc,
+                                       mirror::Class* receiver_class) {
+  Stripe& stripe = stripes_[StripeIndex(caller, dex_pc)];
+  MutexLock mu(Thread::Current(), stripe.lock);
+  CallSiteKey key(caller, dex_pc);
+  auto it = stripe.call_sites.find(key);
+  if (it == stripe.call_sites.end()) {
+    if (stripe.call_sites.size() == kMaxCallSitesPerStripe) {
+      return;
+    }
+    CallSite call_site;
+    call_site.receiver_types[0] = receiver_class;
+    call_site.num_receiver_types = 1;
+    call_site.megamorphic = false;
+    stripe.call_sites.Put(key, call_site);
+    return;
+  }
+  CallSite& call_site = it->second;
+  if (call_site.megamorphic) {
+    return;
+  }
+  for (size_t i = 0; i < call_site.num_receiver_types; ++i) {
+    if (call_site.receiver_types[i] == receiver_class) {
+      return;
+    }
+  }
+  if (call_site.num_receiver_types == kMaxReceiverTypes) {
+    call_site.megamorphic = true;
+  } else {
+    call_site.receiver_types[call_site.num_receiver_types++] = receiver_class;
+  }
+}
+
+bool InlineCacheTable::GetReceiverTypes(const mirror::ArtMethod* caller, uint32_t dex_pc,
+                                        std::vector<mirror::Class*>* receiver_types) const {
+  const Stripe& stripe = stripes_[StripeIndex(caller, dex_pc)];
+  MutexLock mu(Thread::Current(), stripe.lock);
+  auto it = stripe.call_sites.find(CallSiteKey(caller, dex_pc));
+  if (it == stripe.call_sites.end() || it->second.megamorphic) {
+    return false;
+  }
+  const CallSite& call_site = it->second;
+  receiver_types->assign(call_site.receiver_types,
+                         call_site.receiver_types + call_site.num_receiver_types);
+  return true;
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "safe_map.h"
+
+namespace art {
+namespace mirror {
+class ArtMethod;
+class Class;
+}  // namespace mirror
+
+class Instruction;
+
+namespace interpreter {
+
+// A direct-mapped cache of the methods that interpreted invoke-virtual and invoke-interface
+// instructions dispatched to, keyed by instruction, calling method and receiver class. Each thread
+// owns one, so neither lookups nor updates need synchronization. This is a POD embedded in the
+// packed Thread, which must Clear() it before use, so its members are all public.
+struct ThreadInlineCache {
+  // Returns the cached target or NULL on a miss.
+  mirror::ArtMethod* Lookup(const Instruction* inst, const mirror::ArtMethod* caller,
+                            const mirror::Class* receiver_class) const {
+    const Entry& entry = entries_[Index(inst, receiver_class)];
+    if (entry.inst == inst && entry.receiver_class == receiver_class && entry.caller == caller) {
+      return entry.target;
+    }
+    return NULL;
+  }
+
+  void Update(const Instruction* inst, const mirror::ArtMethod* caller,
+              const mirror::Class* receiver_class, mirror::ArtMethod* target) {
+    Entry& entry = entries_[Index(inst, receiver_class)];
+    entry.inst = inst;
+    entry.caller = caller;
+    entry.receiver_class = receiver_class;
+    entry.target = target;
+  }
+
+  void Clear() {
+    memset(entries_, 0, sizeof(entries_));
+  }
+
+  static constexpr size_t kNumEntries = 64;
+
+  static size_t Index(const Instruction* inst, const mirror::Class* receiver_class) {
+    // Instructions are 2 byte and objects 8 byte aligned.
+    return ((reinterpret_cast<uintptr_t>(inst) >> 1) ^
+            (reinterpret_cast<uintptr_t>(receiver_class) >> 3)) & (kNumEntries - 1);
+  }
+
+  struct Entry {
+    const Instruction* inst;
+    const mirror::ArtMethod* caller;
+    const mirror::Class* receiver_class;
+    mirror::ArtMethod* target;
+  };
+
+  Entry entries_[kNumEntries];
+};
+
+// The receiver classes seen by interpreted invoke-virtual and invoke-interface instructions,
+// keyed by calling method and dex pc. Sites that see more than kMaxReceiverTypes classes are
+// megamorphic. Exported so that compilers can devirtualize monomorphic and polymorphic sites, see
+// CompilerDriver::GetReceiverTypes. Only misses in a thread's inline cache record a receiver
+// class, and sites are spread over stripes with their own locks so that threads recording at
+// different sites rarely contend. Each stripe records a bounded number of sites, later ones are
+// ignored.
+class InlineCacheTable {
+ public:
+  static constexpr size_t kMaxReceiverTypes = 4;
+  static constexpr size_t kMaxCallSitesPerStripe = 1024;
+
+  InlineCacheTable();
+
+  void AddReceiverType(const mirror::ArtMethod* caller, uint32_t dex_pc,
+                       mirror::Class* receiver_class);
+
+  // Copies the receiver classes seen at a call site into receiver_types. Returns false if the site
+  // is megamorphic or hasn't been recorded.
+  bool GetReceiverTypes(const mirror::ArtMethod* caller, uint32_t dex_pc,
+                        std::vector<mirror::Class*>* receiver_types) const;
+
+ private:
+  struct CallSite {
+    mirror::Class* receiver_types[kMaxReceiverTypes];
+    size_t num_receiver_types;
+    bool megamorphic;
+  };
+
+  typedef std::pair<const mirror::ArtMethod*, uint32_t> CallSiteKey;
+
+  struct Stripe {
+    Stripe();
+
+    mutable Mutex lock;
+    SafeMap<CallSiteKey, CallSite> call_sites GUARDED_BY(lock);
+  };
+
+  static constexpr size_t kNumStripes = 16;
+
+  static size_t StripeIndex(const mirror::ArtMethod* caller, uint32_t dex_pc) {
+    // Methods are 8 byte aligned.
+    return ((reinterpret_cast<uintptr_t>(caller) >> 3) * 31 + dex_pc) & (kNumStripes - 1);
+  }
+
+  Stripe stripes_[kNumStripes];
+
+  DISALLOW_COPY_AND_ASSIGN(InlineCacheTable);
+};
+
+}  // namespace interpreter
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INLINE_CACHE_H_
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "inline_cache.h"
+
+#include "common_test.h"
+#include "dex_instruction.h"
+#include "mirror/art_method.h"
+#include "mirror/class-inl.h"
+
+namespace art {
+namespace interpreter {
+
+class InlineCacheTest : public CommonTest {};
+
+TEST_F(InlineCacheTest, ThreadInlineCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object_class = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  mirror::Class* string_class = class_linker_->FindSystemClass("Ljava/lang/String;");
+  mirror::ArtMethod* caller = object_class->FindVirtualMethod("toString", "()Ljava/lang/String;");
+  mirror::ArtMethod* target = string_class->FindVirtualMethod("hashCode", "()I");
+  ASSERT_TRUE(caller != NULL);
+  ASSERT_TRUE(target != NULL);
+  const uint16_t code[] = { Instruction::NOP, Instruction::NOP };
+  const Instruction* inst = Instruction::At(&code[0]);
+
+  ThreadInlineCache inline_cache;
+  inline_cache.Clear();
+  EXPECT_TRUE(inline_cache.Lookup(inst, caller, string_class) == NULL);
+  inline_cache.Update(inst, caller, string_class, target);
+  EXPECT_EQ(target, inline_cache.Lookup(inst, caller, string_class));
+  // Entries only match the exact instruction, caller and receiver class.
+  EXPECT_TRUE(inline_cache.Lookup(inst, caller, object_class) == NULL);
+  EXPECT_TRUE(inline_cache.Lookup(inst, target, string_class) == NULL);
+  EXPECT_TRUE(inline_cache.Lookup(Instruction::At(&code[1]), caller, string_class) == NULL);
+  inline_cache.Clear();
+  EXPECT_TRUE(inline_cache.Lookup(inst, caller, string_class) == NULL);
+}
+
+TEST_F(InlineCacheTest, ReceiverTypes) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object_class = class_linker_->FindSystemClass("Ljava/lang/Object;");
+  mirror::ArtMethod* caller = object_class->FindVirtualMethod("toString", "()Ljava/lang/String;");
+  ASSERT_TRUE(caller != NULL);
+  const char* descriptors[] = {
+    "Ljava/lang/Object;", "Ljava/lang/String;", "Ljava/lang/Integer;", "Ljava/lang/Long;",
+    "Ljava/lang/Short;",
+  };
+  mirror::Class* classes[arraysize(descriptors)];
+  for (size_t i = 0; i < arraysize(descriptors); ++i) {
+    classes[i] = class_linker_->FindSystemClass(descriptors[i]);
+    ASSERT_TRUE(classes[i] != NULL) << descriptors[i];
+  }
+
+  InlineCacheTable table;
+  std::vector<mirror::Class*> receiver_types;
+  EXPECT_FALSE(table.GetReceiverTypes(caller, 0, &receiver_types));
+
+  // Monomorphic, repeated receiver types are recorded once.
+  table.AddReceiverType(caller, 0, classes[0]);
+  table.AddReceiverType(caller, 0, classes[0]);
+  ASSERT_TRUE(table.GetReceiverTypes(caller, 0, &receiver_types));
+  ASSERT_EQ(1U, receiver_types.size());
+  EXPECT_EQ(classes[0], receiver_types[0]);
+
+  // Call sites are distinguished by dex pc.
+  EXPECT_FALSE(table.GetReceiverTypes(caller, 3, &receiver_types));
+
+  // Polymorphic up to kMaxReceiverTypes, megamorphic beyond.
+  const size_t max_receiver_types = InlineCacheTable::kMaxReceiverTypes;
+  ASSERT_LT(max_receiver_types, arraysize(classes));
+  for (size_t i = 1; i < max_receiver_types; ++i) {
+    table.AddReceiverType(caller, 0, classes[i]);
+  }
+  ASSERT_TRUE(table.GetReceiverTypes(caller, 0, &receiver_types));
+  EXPECT_EQ(max_receiver_types, receiver_types.size());
+  table.AddReceiverType(caller, 0, classes[max_receiver_types]);
+  EXPECT_FALSE(table.GetReceiverTypes(caller, 0, &receiver_types));
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -26,6 +26,7 @@
 #include "dex_instruction.h"
 #include "entrypoints/entrypoint_utils.h"
 #include "gc/accounting/card_table-inl.h"
+#include "interpreter/inline_cache.h"
 #include "invoke_arg_array_builder.h"
 #include "nth_caller_visitor.h"
 #include "mirror/art_field-inl.h"
@@ -414,6 +415,34 @@ static void DoMonitorExit(Thread* self, Object* ref) NO_THREAD_SAFETY_ANALYSIS {
   ref->MonitorExit(self);
 }
 
+// Resolves the target of an invoke. Virtual and interface targets are looked up in the thread's
+// inline cache first, and the receiver classes seen by each call site are recorded in the
+// runtime's inline cache table. Resolution of a call site for a given receiver class always yields
+// the same method, so hits can skip resolution and access checks.
+template<InvokeType type, bool do_access_check>
+static inline ArtMethod* FindMethodFromInlineCache(Thread* self, ShadowFrame& shadow_frame,
+                                                   const Instruction* inst, uint32_t method_idx,
+                                                   Object* receiver)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  ArtMethod* caller = shadow_frame.GetMethod();
+  if ((type != kVirtual && type != kInterface) || UNLIKELY(receiver == NULL)) {
+    return FindMethodFromCode(method_idx, receiver, caller, self, do_access_check, type);
+  }
+  Class* receiver_class = receiver->GetClass();
+  interpreter::ThreadInlineCache* inline_cache = self->GetInterpreterInlineCache();
+  ArtMethod* method = inline_cache->Lookup(inst, caller, receiver_class);
+  if (LIKELY(method != NULL)) {
+    return method;
+  }
+  method = FindMethodFromCode(method_idx, receiver, caller, self, do_access_check, type);
+  if (LIKELY(method != NULL)) {
+    inline_cache->Update(inst, caller, receiver_class, method);
+    Runtime::Current()->GetInlineCacheTable()->AddReceiverType(caller, shadow_frame.GetDexPC(),
+                                                               receiver_class);
+  }
+  return method;
+}
+
 // TODO: should be SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) which is failing due to template
 // specialization.
 template<InvokeType type, bool is_range, bool do_access_check>
@@ -427,8 +456,8 @@ static bool DoInvoke(Thread* self, ShadowFrame& shadow_frame,
   uint32_t method_idx = (is_range) ? inst->VRegB_3rc() : inst->VRegB_35c();
   uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
   Object* receiver = (type == kStatic) ? NULL : shadow_frame.GetVRegReference(vregC);
-  ArtMethod* method = FindMethodFromCode(method_idx, receiver, shadow_frame.GetMethod(), self,
-                                         do_access_check, type);
+  ArtMethod* method = FindMethodFromInlineCache<type, do_access_check>(self, shadow_frame, inst,
+                                                                       method_idx, receiver);
   if (UNLIKELY(method == NULL)) {
     CHECK(self->IsExceptionPending());
     result->SetJ(0);
@@ -1067,6 +1096,63 @@ static void UnexpectedOpcode(const Instruction* inst, MethodHelper& mh)
 // Code to run before each dex instruction.
 #define PREAMBLE()
 
+static constexpr bool kTraceExecution = false;
+
+static void TraceExecution(const ShadowFrame& shadow_frame, const Instruction* inst,
+                           uint32_t dex_pc, MethodHelper& mh)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+#define TRACE_LOG std::cerr
+  TRACE_LOG << PrettyMethod(shadow_frame.GetMethod())
+            << StringPrintf("\n0x%x: ", dex_pc)
+            << inst->DumpString(&mh.GetDexFile()) << "\n";
+  for (size_t i = 0; i < shadow_frame.NumberOfVRegs(); ++i) {
+    uint32_t raw_value = shadow_frame.GetVReg(i);
+    Object* ref_value = shadow_frame.GetVRegReference(i);
+    TRACE_LOG << StringPrintf(" vreg%d=0x%08X", i, raw_value);
+    if (ref_value != NULL) {
+      if (ref_value->GetClass()->IsStringClass() &&
+          ref_value->AsString()->GetCharArray() != NULL) {
+        TRACE_LOG << "/java.lang.String \"" << ref_value->AsString()->ToModifiedUtf8() << "\"";
+      } else {
+        TRACE_LOG << "/" << PrettyTypeOf(ref_value);
+      }
+    }
+  }
+  TRACE_LOG << "\n";
+#undef TRACE_LOG
+}
+
+// Bookkeeping done before executing each dex instruction.
+#define BEGIN_INSTRUCTION() \
+  dex_pc = inst->GetDexPc(insns); \
+  shadow_frame.SetDexPC(dex_pc); \
+  if (UNLIKELY(self->TestAllFlags())) { \
+    CheckSuspend(self); \
+  } \
+  if (UNLIKELY(instrumentation->HasDexPcListeners())) { \
+    instrumentation->DexPcMovedEvent(self, this_object_ref.get(), \
+                                     shadow_frame.GetMethod(), dex_pc); \
+  } \
+  if (kTraceExecution) { \
+    TraceExecution(shadow_frame, inst, dex_pc, mh); \
+  }
+
+// The instruction handlers below are shared by two dispatch modes. By default they are the cases
+// of a switch in a loop, the reference implementation. With ART_USE_COMPUTED_GOTO_INTERPRETER they
+// are labels in a table indexed by opcode and each handler jumps directly to the next one, which
+// gives every handler its own indirect branch to predict and avoids the switch's bounds check.
+#if ART_USE_COMPUTED_GOTO_INTERPRETER
+#define HANDLE_INSTRUCTION(opcode) op_##opcode
+#define NEXT_INSTRUCTION() \
+  do { \
+    BEGIN_INSTRUCTION(); \
+    goto *handler_table[inst->Opcode()]; \
+  } while (false)
+#else
+#define HANDLE_INSTRUCTION(opcode) case Instruction::opcode
+#define NEXT_INSTRUCTION() break
+#endif
+
 // TODO: should be SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) which is failing due to template
 // specialization.
 template<bool do_access_check>
@@ -1099,121 +1185,105 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
   }
   const uint16_t* const insns = code_item->insns_;
   const Instruction* inst = Instruction::At(insns + dex_pc);
+#if ART_USE_COMPUTED_GOTO_INTERPRETER
+  static const void* const handler_table[kNumPackedOpcodes] = {
+#define INSTRUCTION_HANDLER(o, code, p, f, r, i, a, v) &&op_##code,
+#include "dex_instruction_list.h"
+    DEX_INSTRUCTION_LIST(INSTRUCTION_HANDLER)
+#undef DEX_INSTRUCTION_LIST
+#undef INSTRUCTION_HANDLER
+  };
+  // Dispatch the first instruction, handlers dispatch their successors.
+  NEXT_INSTRUCTION();
   while (true) {
-    dex_pc = inst->GetDexPc(insns);
-    shadow_frame.SetDexPC(dex_pc);
-    if (UNLIKELY(self->TestAllFlags())) {
-      CheckSuspend(self);
-    }
-    if (UNLIKELY(instrumentation->HasDexPcListeners())) {
-      instrumentation->DexPcMovedEvent(self, this_object_ref.get(),
-                                       shadow_frame.GetMethod(), dex_pc);
-    }
-    const bool kTracing = false;
-    if (kTracing) {
-#define TRACE_LOG std::cerr
-      TRACE_LOG << PrettyMethod(shadow_frame.GetMethod())
-                << StringPrintf("\n0x%x: ", dex_pc)
-                << inst->DumpString(&mh.GetDexFile()) << "\n";
-      for (size_t i = 0; i < shadow_frame.NumberOfVRegs(); ++i) {
-        uint32_t raw_value = shadow_frame.GetVReg(i);
-        Object* ref_value = shadow_frame.GetVRegReference(i);
-        TRACE_LOG << StringPrintf(" vreg%d=0x%08X", i, raw_value);
-        if (ref_value != NULL) {
-          if (ref_value->GetClass()->IsStringClass() &&
-              ref_value->AsString()->GetCharArray() != NULL) {
-            TRACE_LOG << "/java.lang.String \"" << ref_value->AsString()->ToModifiedUtf8() << "\"";
-          } else {
-            TRACE_LOG << "/" << PrettyTypeOf(ref_value);
-          }
-        }
-      }
-      TRACE_LOG << "\n";
-#undef TRACE_LOG
-    }
+    {
+#else
+  while (true) {
+    BEGIN_INSTRUCTION();
     switch (inst->Opcode()) {
-      case Instruction::NOP:
+#endif
+      HANDLE_INSTRUCTION(NOP):
         PREAMBLE();
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(),
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_FROM16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_FROM16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22x(),
                              shadow_frame.GetVReg(inst->VRegB_22x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MOVE_16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_32x(),
                              shadow_frame.GetVReg(inst->VRegB_32x()));
         inst = inst->Next_3xx();
-        break;
-      case Instruction::MOVE_WIDE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_WIDE):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_12x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_WIDE_FROM16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_WIDE_FROM16):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_22x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_22x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MOVE_WIDE_16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_WIDE_16):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_32x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_32x()));
         inst = inst->Next_3xx();
-        break;
-      case Instruction::MOVE_OBJECT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_OBJECT):
         PREAMBLE();
         shadow_frame.SetVRegReference(inst->VRegA_12x(),
                                       shadow_frame.GetVRegReference(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_OBJECT_FROM16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_OBJECT_FROM16):
         PREAMBLE();
         shadow_frame.SetVRegReference(inst->VRegA_22x(),
                                       shadow_frame.GetVRegReference(inst->VRegB_22x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MOVE_OBJECT_16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_OBJECT_16):
         PREAMBLE();
         shadow_frame.SetVRegReference(inst->VRegA_32x(),
                                       shadow_frame.GetVRegReference(inst->VRegB_32x()));
         inst = inst->Next_3xx();
-        break;
-      case Instruction::MOVE_RESULT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_RESULT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_11x(), result_register.GetI());
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_RESULT_WIDE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_RESULT_WIDE):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_11x(), result_register.GetJ());
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_RESULT_OBJECT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_RESULT_OBJECT):
         PREAMBLE();
         shadow_frame.SetVRegReference(inst->VRegA_11x(), result_register.GetL());
         inst = inst->Next_1xx();
-        break;
-      case Instruction::MOVE_EXCEPTION: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MOVE_EXCEPTION): {
         PREAMBLE();
         Throwable* exception = self->GetException(NULL);
         self->ClearException();
         shadow_frame.SetVRegReference(inst->VRegA_11x(), exception);
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::RETURN_VOID: {
+      HANDLE_INSTRUCTION(RETURN_VOID): {
         PREAMBLE();
         JValue result;
         if (UNLIKELY(instrumentation->HasMethodExitListeners())) {
@@ -1223,7 +1293,7 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         return result;
       }
-      case Instruction::RETURN_VOID_BARRIER: {
+      HANDLE_INSTRUCTION(RETURN_VOID_BARRIER): {
         PREAMBLE();
         ANDROID_MEMBAR_STORE();
         JValue result;
@@ -1234,7 +1304,7 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         return result;
       }
-      case Instruction::RETURN: {
+      HANDLE_INSTRUCTION(RETURN): {
         PREAMBLE();
         JValue result;
         result.SetJ(0);
@@ -1246,7 +1316,7 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         return result;
       }
-      case Instruction::RETURN_WIDE: {
+      HANDLE_INSTRUCTION(RETURN_WIDE): {
         PREAMBLE();
         JValue result;
         result.SetJ(shadow_frame.GetVRegLong(inst->VRegA_11x()));
@@ -1257,7 +1327,7 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         return result;
       }
-      case Instruction::RETURN_OBJECT: {
+      HANDLE_INSTRUCTION(RETURN_OBJECT): {
         PREAMBLE();
         JValue result;
         Object* obj_result = shadow_frame.GetVRegReference(inst->VRegA_11x());
@@ -1286,7 +1356,7 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         return result;
       }
-      case Instruction::CONST_4: {
+      HANDLE_INSTRUCTION(CONST_4): {
         PREAMBLE();
         uint4_t dst = inst->VRegA_11n();
         int4_t val = inst->VRegB_11n();
@@ -1295,9 +1365,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(dst, NULL);
         }
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST_16: {
+      HANDLE_INSTRUCTION(CONST_16): {
         PREAMBLE();
         uint8_t dst = inst->VRegA_21s();
         int16_t val = inst->VRegB_21s();
@@ -1306,9 +1376,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(dst, NULL);
         }
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST: {
+      HANDLE_INSTRUCTION(CONST): {
         PREAMBLE();
         uint8_t dst = inst->VRegA_31i();
         int32_t val = inst->VRegB_31i();
@@ -1317,9 +1387,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(dst, NULL);
         }
         inst = inst->Next_3xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST_HIGH16: {
+      HANDLE_INSTRUCTION(CONST_HIGH16): {
         PREAMBLE();
         uint8_t dst = inst->VRegA_21h();
         int32_t val = static_cast<int32_t>(inst->VRegB_21h() << 16);
@@ -1328,29 +1398,29 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(dst, NULL);
         }
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST_WIDE_16:
+      HANDLE_INSTRUCTION(CONST_WIDE_16):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_21s(), inst->VRegB_21s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::CONST_WIDE_32:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(CONST_WIDE_32):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_31i(), inst->VRegB_31i());
         inst = inst->Next_3xx();
-        break;
-      case Instruction::CONST_WIDE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(CONST_WIDE):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_51l(), inst->VRegB_51l());
         inst = inst->Next_51l();
-        break;
-      case Instruction::CONST_WIDE_HIGH16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(CONST_WIDE_HIGH16):
         shadow_frame.SetVRegLong(inst->VRegA_21h(),
                                  static_cast<uint64_t>(inst->VRegB_21h()) << 48);
         inst = inst->Next_2xx();
-        break;
-      case Instruction::CONST_STRING: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(CONST_STRING): {
         PREAMBLE();
         String* s = ResolveString(self, mh,  inst->VRegB_21c());
         if (UNLIKELY(s == NULL)) {
@@ -1359,9 +1429,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(inst->VRegA_21c(), s);
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST_STRING_JUMBO: {
+      HANDLE_INSTRUCTION(CONST_STRING_JUMBO): {
         PREAMBLE();
         String* s = ResolveString(self, mh,  inst->VRegB_31c());
         if (UNLIKELY(s == NULL)) {
@@ -1370,9 +1440,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(inst->VRegA_31c(), s);
           inst = inst->Next_3xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CONST_CLASS: {
+      HANDLE_INSTRUCTION(CONST_CLASS): {
         PREAMBLE();
         Class* c = ResolveVerifyAndClinit(inst->VRegB_21c(), shadow_frame.GetMethod(),
                                           self, false, do_access_check);
@@ -1382,9 +1452,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(inst->VRegA_21c(), c);
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MONITOR_ENTER: {
+      HANDLE_INSTRUCTION(MONITOR_ENTER): {
         PREAMBLE();
         Object* obj = shadow_frame.GetVRegReference(inst->VRegA_11x());
         if (UNLIKELY(obj == NULL)) {
@@ -1394,9 +1464,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           DoMonitorEnter(self, obj);
           POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_1xx);
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MONITOR_EXIT: {
+      HANDLE_INSTRUCTION(MONITOR_EXIT): {
         PREAMBLE();
         Object* obj = shadow_frame.GetVRegReference(inst->VRegA_11x());
         if (UNLIKELY(obj == NULL)) {
@@ -1406,9 +1476,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           DoMonitorExit(self, obj);
           POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_1xx);
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CHECK_CAST: {
+      HANDLE_INSTRUCTION(CHECK_CAST): {
         PREAMBLE();
         Class* c = ResolveVerifyAndClinit(inst->VRegB_21c(), shadow_frame.GetMethod(),
                                           self, false, do_access_check);
@@ -1423,9 +1493,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
             inst = inst->Next_2xx();
           }
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INSTANCE_OF: {
+      HANDLE_INSTRUCTION(INSTANCE_OF): {
         PREAMBLE();
         Class* c = ResolveVerifyAndClinit(inst->VRegC_22c(), shadow_frame.GetMethod(),
                                           self, false, do_access_check);
@@ -1436,9 +1506,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVReg(inst->VRegA_22c(), (obj != NULL && obj->InstanceOf(c)) ? 1 : 0);
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::ARRAY_LENGTH:  {
+      HANDLE_INSTRUCTION(ARRAY_LENGTH): {
         PREAMBLE();
         Object* array = shadow_frame.GetVRegReference(inst->VRegB_12x());
         if (UNLIKELY(array == NULL)) {
@@ -1448,9 +1518,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVReg(inst->VRegA_12x(), array->AsArray()->GetLength());
           inst = inst->Next_1xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::NEW_INSTANCE: {
+      HANDLE_INSTRUCTION(NEW_INSTANCE): {
         PREAMBLE();
         Object* obj = AllocObjectFromCode(inst->VRegB_21c(), shadow_frame.GetMethod(),
                                           self, do_access_check);
@@ -1460,9 +1530,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(inst->VRegA_21c(), obj);
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::NEW_ARRAY: {
+      HANDLE_INSTRUCTION(NEW_ARRAY): {
         PREAMBLE();
         int32_t length = shadow_frame.GetVReg(inst->VRegB_22c());
         Object* obj = AllocArrayFromCode(inst->VRegC_22c(), shadow_frame.GetMethod(),
@@ -1473,29 +1543,29 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           shadow_frame.SetVRegReference(inst->VRegA_22c(), obj);
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::FILLED_NEW_ARRAY: {
+      HANDLE_INSTRUCTION(FILLED_NEW_ARRAY): {
         PREAMBLE();
         bool success = DoFilledNewArray<false, do_access_check>(inst, shadow_frame,
                                                                 self, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::FILLED_NEW_ARRAY_RANGE: {
+      HANDLE_INSTRUCTION(FILLED_NEW_ARRAY_RANGE): {
         PREAMBLE();
         bool success = DoFilledNewArray<true, do_access_check>(inst, shadow_frame,
                                                                self, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::FILL_ARRAY_DATA: {
+      HANDLE_INSTRUCTION(FILL_ARRAY_DATA): {
         PREAMBLE();
         Object* obj = shadow_frame.GetVRegReference(inst->VRegA_31t());
         if (UNLIKELY(obj == NULL)) {
           ThrowNullPointerException(NULL, "null array in FILL_ARRAY_DATA");
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         Array* array = obj->AsArray();
         DCHECK(array->IsArrayInstance() && !array->IsObjectArray());
@@ -1508,14 +1578,14 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
                                    "failed FILL_ARRAY_DATA; length=%d, index=%d",
                                    array->GetLength(), payload->element_count);
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         uint32_t size_in_bytes = payload->element_count * payload->element_width;
         memcpy(array->GetRawData(payload->element_width), payload->data, size_in_bytes);
         inst = inst->Next_3xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::THROW: {
+      HANDLE_INSTRUCTION(THROW): {
         PREAMBLE();
         Object* exception = shadow_frame.GetVRegReference(inst->VRegA_11x());
         if (UNLIKELY(exception == NULL)) {
@@ -1530,24 +1600,24 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
           self->SetException(shadow_frame.GetCurrentLocationForThrow(), exception->AsThrowable());
         }
         HANDLE_PENDING_EXCEPTION();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::GOTO: {
+      HANDLE_INSTRUCTION(GOTO): {
         PREAMBLE();
         inst = inst->RelativeAt(inst->VRegA_10t());
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::GOTO_16: {
+      HANDLE_INSTRUCTION(GOTO_16): {
         PREAMBLE();
         inst = inst->RelativeAt(inst->VRegA_20t());
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::GOTO_32: {
+      HANDLE_INSTRUCTION(GOTO_32): {
         PREAMBLE();
         inst = inst->RelativeAt(inst->VRegA_30t());
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::PACKED_SWITCH: {
+      HANDLE_INSTRUCTION(PACKED_SWITCH): {
         PREAMBLE();
         const uint16_t* switch_data = reinterpret_cast<const uint16_t*>(inst) + inst->VRegB_31t();
         int32_t test_val = shadow_frame.GetVReg(inst->VRegA_31t());
@@ -1565,14 +1635,14 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           inst = inst->Next_3xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPARSE_SWITCH: {
+      HANDLE_INSTRUCTION(SPARSE_SWITCH): {
         PREAMBLE();
         inst = DoSparseSwitch(inst, shadow_frame);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CMPL_FLOAT: {
+      HANDLE_INSTRUCTION(CMPL_FLOAT): {
         PREAMBLE();
         float val1 = shadow_frame.GetVRegFloat(inst->VRegB_23x());
         float val2 = shadow_frame.GetVRegFloat(inst->VRegC_23x());
@@ -1586,9 +1656,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_23x(), result);
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CMPG_FLOAT: {
+      HANDLE_INSTRUCTION(CMPG_FLOAT): {
         PREAMBLE();
         float val1 = shadow_frame.GetVRegFloat(inst->VRegB_23x());
         float val2 = shadow_frame.GetVRegFloat(inst->VRegC_23x());
@@ -1602,9 +1672,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_23x(), result);
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CMPL_DOUBLE: {
+      HANDLE_INSTRUCTION(CMPL_DOUBLE): {
         PREAMBLE();
         double val1 = shadow_frame.GetVRegDouble(inst->VRegB_23x());
         double val2 = shadow_frame.GetVRegDouble(inst->VRegC_23x());
@@ -1618,10 +1688,10 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_23x(), result);
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
 
-      case Instruction::CMPG_DOUBLE: {
+      HANDLE_INSTRUCTION(CMPG_DOUBLE): {
         PREAMBLE();
         double val1 = shadow_frame.GetVRegDouble(inst->VRegB_23x());
         double val2 = shadow_frame.GetVRegDouble(inst->VRegC_23x());
@@ -1635,9 +1705,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_23x(), result);
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::CMP_LONG: {
+      HANDLE_INSTRUCTION(CMP_LONG): {
         PREAMBLE();
         int64_t val1 = shadow_frame.GetVRegLong(inst->VRegB_23x());
         int64_t val2 = shadow_frame.GetVRegLong(inst->VRegC_23x());
@@ -1651,123 +1721,123 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_23x(), result);
         inst = inst->Next_2xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_EQ: {
+      HANDLE_INSTRUCTION(IF_EQ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) == shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_NE: {
+      HANDLE_INSTRUCTION(IF_NE): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) != shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_LT: {
+      HANDLE_INSTRUCTION(IF_LT): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) < shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_GE: {
+      HANDLE_INSTRUCTION(IF_GE): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) >= shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_GT: {
+      HANDLE_INSTRUCTION(IF_GT): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) > shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_LE: {
+      HANDLE_INSTRUCTION(IF_LE): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_22t()) <= shadow_frame.GetVReg(inst->VRegB_22t())) {
           inst = inst->RelativeAt(inst->VRegC_22t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_EQZ: {
+      HANDLE_INSTRUCTION(IF_EQZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) == 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_NEZ: {
+      HANDLE_INSTRUCTION(IF_NEZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) != 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_LTZ: {
+      HANDLE_INSTRUCTION(IF_LTZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) < 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_GEZ: {
+      HANDLE_INSTRUCTION(IF_GEZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) >= 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_GTZ: {
+      HANDLE_INSTRUCTION(IF_GTZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) > 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IF_LEZ:  {
+      HANDLE_INSTRUCTION(IF_LEZ): {
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t()) <= 0) {
           inst = inst->RelativeAt(inst->VRegB_21t());
         } else {
           inst = inst->Next_2xx();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_BOOLEAN: {
+      HANDLE_INSTRUCTION(AGET_BOOLEAN): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         BooleanArray* array = a->AsBooleanArray();
@@ -1777,15 +1847,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_BYTE: {
+      HANDLE_INSTRUCTION(AGET_BYTE): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         ByteArray* array = a->AsByteArray();
@@ -1795,15 +1865,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_CHAR: {
+      HANDLE_INSTRUCTION(AGET_CHAR): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         CharArray* array = a->AsCharArray();
@@ -1813,15 +1883,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_SHORT: {
+      HANDLE_INSTRUCTION(AGET_SHORT): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         ShortArray* array = a->AsShortArray();
@@ -1831,15 +1901,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET: {
+      HANDLE_INSTRUCTION(AGET): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         IntArray* array = a->AsIntArray();
@@ -1849,15 +1919,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_WIDE:  {
+      HANDLE_INSTRUCTION(AGET_WIDE): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         LongArray* array = a->AsLongArray();
@@ -1867,15 +1937,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AGET_OBJECT: {
+      HANDLE_INSTRUCTION(AGET_OBJECT): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         ObjectArray<Object>* array = a->AsObjectArray<Object>();
@@ -1885,15 +1955,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_BOOLEAN: {
+      HANDLE_INSTRUCTION(APUT_BOOLEAN): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         uint8_t val = shadow_frame.GetVReg(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1904,15 +1974,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_BYTE: {
+      HANDLE_INSTRUCTION(APUT_BYTE): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int8_t val = shadow_frame.GetVReg(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1923,15 +1993,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_CHAR: {
+      HANDLE_INSTRUCTION(APUT_CHAR): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         uint16_t val = shadow_frame.GetVReg(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1942,15 +2012,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_SHORT: {
+      HANDLE_INSTRUCTION(APUT_SHORT): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int16_t val = shadow_frame.GetVReg(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1961,15 +2031,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT: {
+      HANDLE_INSTRUCTION(APUT): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t val = shadow_frame.GetVReg(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1980,15 +2050,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_WIDE: {
+      HANDLE_INSTRUCTION(APUT_WIDE): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int64_t val = shadow_frame.GetVRegLong(inst->VRegA_23x());
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
@@ -1999,15 +2069,15 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::APUT_OBJECT: {
+      HANDLE_INSTRUCTION(APUT_OBJECT): {
         PREAMBLE();
         Object* a = shadow_frame.GetVRegReference(inst->VRegB_23x());
         if (UNLIKELY(a == NULL)) {
           ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
           HANDLE_PENDING_EXCEPTION();
-          break;
+          NEXT_INSTRUCTION();
         }
         int32_t index = shadow_frame.GetVReg(inst->VRegC_23x());
         Object* val = shadow_frame.GetVRegReference(inst->VRegA_23x());
@@ -2018,345 +2088,345 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         } else {
           HANDLE_PENDING_EXCEPTION();
         }
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_BOOLEAN: {
+      HANDLE_INSTRUCTION(IGET_BOOLEAN): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimBoolean, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_BYTE: {
+      HANDLE_INSTRUCTION(IGET_BYTE): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimByte, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_CHAR: {
+      HANDLE_INSTRUCTION(IGET_CHAR): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimChar, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_SHORT: {
+      HANDLE_INSTRUCTION(IGET_SHORT): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimShort, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET: {
+      HANDLE_INSTRUCTION(IGET): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimInt, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_WIDE: {
+      HANDLE_INSTRUCTION(IGET_WIDE): {
         PREAMBLE();
         bool success = DoFieldGet<InstancePrimitiveRead, Primitive::kPrimLong, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_OBJECT: {
+      HANDLE_INSTRUCTION(IGET_OBJECT): {
         PREAMBLE();
         bool success = DoFieldGet<InstanceObjectRead, Primitive::kPrimNot, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_QUICK: {
+      HANDLE_INSTRUCTION(IGET_QUICK): {
         PREAMBLE();
         bool success = DoIGetQuick<Primitive::kPrimInt>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_WIDE_QUICK: {
+      HANDLE_INSTRUCTION(IGET_WIDE_QUICK): {
         PREAMBLE();
         bool success = DoIGetQuick<Primitive::kPrimLong>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IGET_OBJECT_QUICK: {
+      HANDLE_INSTRUCTION(IGET_OBJECT_QUICK): {
         PREAMBLE();
         bool success = DoIGetQuick<Primitive::kPrimNot>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_BOOLEAN: {
+      HANDLE_INSTRUCTION(SGET_BOOLEAN): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimBoolean, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_BYTE: {
+      HANDLE_INSTRUCTION(SGET_BYTE): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimByte, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_CHAR: {
+      HANDLE_INSTRUCTION(SGET_CHAR): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimChar, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_SHORT: {
+      HANDLE_INSTRUCTION(SGET_SHORT): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimShort, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET: {
+      HANDLE_INSTRUCTION(SGET): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimInt, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_WIDE: {
+      HANDLE_INSTRUCTION(SGET_WIDE): {
         PREAMBLE();
         bool success = DoFieldGet<StaticPrimitiveRead, Primitive::kPrimLong, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SGET_OBJECT: {
+      HANDLE_INSTRUCTION(SGET_OBJECT): {
         PREAMBLE();
         bool success = DoFieldGet<StaticObjectRead, Primitive::kPrimNot, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_BOOLEAN: {
+      HANDLE_INSTRUCTION(IPUT_BOOLEAN): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimBoolean, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_BYTE: {
+      HANDLE_INSTRUCTION(IPUT_BYTE): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimByte, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_CHAR: {
+      HANDLE_INSTRUCTION(IPUT_CHAR): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimChar, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_SHORT: {
+      HANDLE_INSTRUCTION(IPUT_SHORT): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimShort, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT: {
+      HANDLE_INSTRUCTION(IPUT): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimInt, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_WIDE: {
+      HANDLE_INSTRUCTION(IPUT_WIDE): {
         PREAMBLE();
         bool success = DoFieldPut<InstancePrimitiveWrite, Primitive::kPrimLong, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_OBJECT: {
+      HANDLE_INSTRUCTION(IPUT_OBJECT): {
         PREAMBLE();
         bool success = DoFieldPut<InstanceObjectWrite, Primitive::kPrimNot, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_QUICK: {
+      HANDLE_INSTRUCTION(IPUT_QUICK): {
         PREAMBLE();
         bool success = DoIPutQuick<Primitive::kPrimInt>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_WIDE_QUICK: {
+      HANDLE_INSTRUCTION(IPUT_WIDE_QUICK): {
         PREAMBLE();
         bool success = DoIPutQuick<Primitive::kPrimLong>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::IPUT_OBJECT_QUICK: {
+      HANDLE_INSTRUCTION(IPUT_OBJECT_QUICK): {
         PREAMBLE();
         bool success = DoIPutQuick<Primitive::kPrimNot>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_BOOLEAN: {
+      HANDLE_INSTRUCTION(SPUT_BOOLEAN): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimBoolean, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_BYTE: {
+      HANDLE_INSTRUCTION(SPUT_BYTE): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimByte, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_CHAR: {
+      HANDLE_INSTRUCTION(SPUT_CHAR): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimChar, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_SHORT: {
+      HANDLE_INSTRUCTION(SPUT_SHORT): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimShort, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT: {
+      HANDLE_INSTRUCTION(SPUT): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimInt, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_WIDE: {
+      HANDLE_INSTRUCTION(SPUT_WIDE): {
         PREAMBLE();
         bool success = DoFieldPut<StaticPrimitiveWrite, Primitive::kPrimLong, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SPUT_OBJECT: {
+      HANDLE_INSTRUCTION(SPUT_OBJECT): {
         PREAMBLE();
         bool success = DoFieldPut<StaticObjectWrite, Primitive::kPrimNot, do_access_check>(self, shadow_frame, inst);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_VIRTUAL: {
+      HANDLE_INSTRUCTION(INVOKE_VIRTUAL): {
         PREAMBLE();
         bool success = DoInvoke<kVirtual, false, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_VIRTUAL_RANGE: {
+      HANDLE_INSTRUCTION(INVOKE_VIRTUAL_RANGE): {
         PREAMBLE();
         bool success = DoInvoke<kVirtual, true, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_SUPER: {
+      HANDLE_INSTRUCTION(INVOKE_SUPER): {
         PREAMBLE();
         bool success = DoInvoke<kSuper, false, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_SUPER_RANGE: {
+      HANDLE_INSTRUCTION(INVOKE_SUPER_RANGE): {
         PREAMBLE();
         bool success = DoInvoke<kSuper, true, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_DIRECT: {
+      HANDLE_INSTRUCTION(INVOKE_DIRECT): {
         PREAMBLE();
         bool success = DoInvoke<kDirect, false, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_DIRECT_RANGE: {
+      HANDLE_INSTRUCTION(INVOKE_DIRECT_RANGE): {
         PREAMBLE();
         bool success = DoInvoke<kDirect, true, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_INTERFACE: {
+      HANDLE_INSTRUCTION(INVOKE_INTERFACE): {
         PREAMBLE();
         bool success = DoInvoke<kInterface, false, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_INTERFACE_RANGE: {
+      HANDLE_INSTRUCTION(INVOKE_INTERFACE_RANGE): {
         PREAMBLE();
         bool success = DoInvoke<kInterface, true, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_STATIC: {
+      HANDLE_INSTRUCTION(INVOKE_STATIC): {
         PREAMBLE();
         bool success = DoInvoke<kStatic, false, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_STATIC_RANGE: {
+      HANDLE_INSTRUCTION(INVOKE_STATIC_RANGE): {
         PREAMBLE();
         bool success = DoInvoke<kStatic, true, do_access_check>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_VIRTUAL_QUICK: {
+      HANDLE_INSTRUCTION(INVOKE_VIRTUAL_QUICK): {
         PREAMBLE();
         bool success = DoInvokeVirtualQuick<false>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::INVOKE_VIRTUAL_RANGE_QUICK: {
+      HANDLE_INSTRUCTION(INVOKE_VIRTUAL_RANGE_QUICK): {
         PREAMBLE();
         bool success = DoInvokeVirtualQuick<true>(self, shadow_frame, inst, &result_register);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_3xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::NEG_INT:
+      HANDLE_INSTRUCTION(NEG_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(), -shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::NOT_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(NOT_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(), ~shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::NEG_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(NEG_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_12x(), -shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::NOT_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(NOT_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_12x(), ~shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::NEG_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(NEG_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_12x(), -shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::NEG_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(NEG_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_12x(), -shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_12x(), shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_12x(), shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_12x(), shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::LONG_TO_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(LONG_TO_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(), shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::LONG_TO_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(LONG_TO_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_12x(), shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::LONG_TO_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(LONG_TO_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_12x(), shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::FLOAT_TO_INT: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(FLOAT_TO_INT): {
         PREAMBLE();
         float val = shadow_frame.GetVRegFloat(inst->VRegB_12x());
         int32_t result;
@@ -2371,9 +2441,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_12x(), result);
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::FLOAT_TO_LONG: {
+      HANDLE_INSTRUCTION(FLOAT_TO_LONG): {
         PREAMBLE();
         float val = shadow_frame.GetVRegFloat(inst->VRegB_12x());
         int64_t result;
@@ -2388,14 +2458,14 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVRegLong(inst->VRegA_12x(), result);
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::FLOAT_TO_DOUBLE:
+      HANDLE_INSTRUCTION(FLOAT_TO_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_12x(), shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::DOUBLE_TO_INT: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DOUBLE_TO_INT): {
         PREAMBLE();
         double val = shadow_frame.GetVRegDouble(inst->VRegB_12x());
         int32_t result;
@@ -2410,9 +2480,9 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVReg(inst->VRegA_12x(), result);
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DOUBLE_TO_LONG: {
+      HANDLE_INSTRUCTION(DOUBLE_TO_LONG): {
         PREAMBLE();
         double val = shadow_frame.GetVRegDouble(inst->VRegB_12x());
         int64_t result;
@@ -2427,678 +2497,703 @@ static JValue ExecuteImpl(Thread* self, MethodHelper& mh, const DexFile::CodeIte
         }
         shadow_frame.SetVRegLong(inst->VRegA_12x(), result);
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DOUBLE_TO_FLOAT:
+      HANDLE_INSTRUCTION(DOUBLE_TO_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_12x(), shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_BYTE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_BYTE):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(),
                              static_cast<int8_t>(shadow_frame.GetVReg(inst->VRegB_12x())));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_CHAR:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_CHAR):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(),
                              static_cast<uint16_t>(shadow_frame.GetVReg(inst->VRegB_12x())));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::INT_TO_SHORT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(INT_TO_SHORT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_12x(),
                              static_cast<int16_t>(shadow_frame.GetVReg(inst->VRegB_12x())));
         inst = inst->Next_1xx();
-        break;
-      case Instruction::ADD_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) +
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SUB_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SUB_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) -
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) *
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_INT: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_INT): {
         PREAMBLE();
         bool success = DoIntDivide(shadow_frame, inst->VRegA_23x(),
                                    shadow_frame.GetVReg(inst->VRegB_23x()),
                                    shadow_frame.GetVReg(inst->VRegC_23x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_INT: {
+      HANDLE_INSTRUCTION(REM_INT): {
         PREAMBLE();
         bool success = DoIntRemainder(shadow_frame, inst->VRegA_23x(),
                                       shadow_frame.GetVReg(inst->VRegB_23x()),
                                       shadow_frame.GetVReg(inst->VRegC_23x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SHL_INT:
+      HANDLE_INSTRUCTION(SHL_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) <<
                              (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SHR_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SHR_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) >>
                              (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::USHR_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(USHR_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              static_cast<uint32_t>(shadow_frame.GetVReg(inst->VRegB_23x())) >>
                              (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::AND_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(AND_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) &
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::OR_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(OR_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) |
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::XOR_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(XOR_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_23x(),
                              shadow_frame.GetVReg(inst->VRegB_23x()) ^
                              shadow_frame.GetVReg(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::ADD_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) +
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SUB_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SUB_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) -
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) *
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_LONG):
         PREAMBLE();
         DoLongDivide(shadow_frame, inst->VRegA_23x(),
                      shadow_frame.GetVRegLong(inst->VRegB_23x()),
                     shadow_frame.GetVRegLong(inst->VRegC_23x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_2xx);
-        break;
-      case Instruction::REM_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(REM_LONG):
         PREAMBLE();
         DoLongRemainder(shadow_frame, inst->VRegA_23x(),
                         shadow_frame.GetVRegLong(inst->VRegB_23x()),
                         shadow_frame.GetVRegLong(inst->VRegC_23x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_2xx);
-        break;
-      case Instruction::AND_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(AND_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) &
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::OR_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(OR_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) |
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::XOR_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(XOR_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) ^
                                  shadow_frame.GetVRegLong(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SHL_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SHL_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) <<
                                  (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x3f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SHR_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SHR_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  shadow_frame.GetVRegLong(inst->VRegB_23x()) >>
                                  (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x3f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::USHR_LONG:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(USHR_LONG):
         PREAMBLE();
         shadow_frame.SetVRegLong(inst->VRegA_23x(),
                                  static_cast<uint64_t>(shadow_frame.GetVRegLong(inst->VRegB_23x())) >>
                                  (shadow_frame.GetVReg(inst->VRegC_23x()) & 0x3f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::ADD_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_23x(),
                                   shadow_frame.GetVRegFloat(inst->VRegB_23x()) +
                                   shadow_frame.GetVRegFloat(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SUB_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SUB_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_23x(),
                                   shadow_frame.GetVRegFloat(inst->VRegB_23x()) -
                                   shadow_frame.GetVRegFloat(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_23x(),
                                   shadow_frame.GetVRegFloat(inst->VRegB_23x()) *
                                   shadow_frame.GetVRegFloat(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_23x(),
                                   shadow_frame.GetVRegFloat(inst->VRegB_23x()) /
                                   shadow_frame.GetVRegFloat(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::REM_FLOAT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(REM_FLOAT):
         PREAMBLE();
         shadow_frame.SetVRegFloat(inst->VRegA_23x(),
                                   fmodf(shadow_frame.GetVRegFloat(inst->VRegB_23x()),
                                         shadow_frame.GetVRegFloat(inst->VRegC_23x())));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::ADD_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_23x(),
                                    shadow_frame.GetVRegDouble(inst->VRegB_23x()) +
                                    shadow_frame.GetVRegDouble(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SUB_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SUB_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_23x(),
                                    shadow_frame.GetVRegDouble(inst->VRegB_23x()) -
                                    shadow_frame.GetVRegDouble(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_23x(),
                                    shadow_frame.GetVRegDouble(inst->VRegB_23x()) *
                                    shadow_frame.GetVRegDouble(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_23x(),
                                    shadow_frame.GetVRegDouble(inst->VRegB_23x()) /
                                    shadow_frame.GetVRegDouble(inst->VRegC_23x()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::REM_DOUBLE:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(REM_DOUBLE):
         PREAMBLE();
         shadow_frame.SetVRegDouble(inst->VRegA_23x(),
                                    fmod(shadow_frame.GetVRegDouble(inst->VRegB_23x()),
                                         shadow_frame.GetVRegDouble(inst->VRegC_23x())));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::ADD_INT_2ADDR: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) +
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SUB_INT_2ADDR: {
+      HANDLE_INSTRUCTION(SUB_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) -
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MUL_INT_2ADDR: {
+      HANDLE_INSTRUCTION(MUL_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) *
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DIV_INT_2ADDR: {
+      HANDLE_INSTRUCTION(DIV_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         bool success = DoIntDivide(shadow_frame, vregA, shadow_frame.GetVReg(vregA),
                                    shadow_frame.GetVReg(inst->VRegB_12x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_1xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_INT_2ADDR: {
+      HANDLE_INSTRUCTION(REM_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         bool success = DoIntRemainder(shadow_frame, vregA, shadow_frame.GetVReg(vregA),
                                       shadow_frame.GetVReg(inst->VRegB_12x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_1xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SHL_INT_2ADDR: {
+      HANDLE_INSTRUCTION(SHL_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) <<
                              (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x1f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SHR_INT_2ADDR: {
+      HANDLE_INSTRUCTION(SHR_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) >>
                              (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x1f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::USHR_INT_2ADDR: {
+      HANDLE_INSTRUCTION(USHR_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              static_cast<uint32_t>(shadow_frame.GetVReg(vregA)) >>
                              (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x1f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AND_INT_2ADDR: {
+      HANDLE_INSTRUCTION(AND_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) &
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::OR_INT_2ADDR: {
+      HANDLE_INSTRUCTION(OR_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) |
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::XOR_INT_2ADDR: {
+      HANDLE_INSTRUCTION(XOR_INT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVReg(vregA,
                              shadow_frame.GetVReg(vregA) ^
                              shadow_frame.GetVReg(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::ADD_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(ADD_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) +
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SUB_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(SUB_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) -
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MUL_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(MUL_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) *
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DIV_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(DIV_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         DoLongDivide(shadow_frame, vregA, shadow_frame.GetVRegLong(vregA),
                     shadow_frame.GetVRegLong(inst->VRegB_12x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_1xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(REM_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         DoLongRemainder(shadow_frame, vregA, shadow_frame.GetVRegLong(vregA),
                         shadow_frame.GetVRegLong(inst->VRegB_12x()));
         POSSIBLY_HANDLE_PENDING_EXCEPTION(self->IsExceptionPending(), Next_1xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AND_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(AND_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) &
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::OR_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(OR_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) |
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::XOR_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(XOR_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) ^
                                  shadow_frame.GetVRegLong(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SHL_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(SHL_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) <<
                                  (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x3f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SHR_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(SHR_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  shadow_frame.GetVRegLong(vregA) >>
                                  (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x3f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::USHR_LONG_2ADDR: {
+      HANDLE_INSTRUCTION(USHR_LONG_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegLong(vregA,
                                  static_cast<uint64_t>(shadow_frame.GetVRegLong(vregA)) >>
                                  (shadow_frame.GetVReg(inst->VRegB_12x()) & 0x3f));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::ADD_FLOAT_2ADDR: {
+      HANDLE_INSTRUCTION(ADD_FLOAT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegFloat(vregA,
                                   shadow_frame.GetVRegFloat(vregA) +
                                   shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SUB_FLOAT_2ADDR: {
+      HANDLE_INSTRUCTION(SUB_FLOAT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegFloat(vregA,
                                   shadow_frame.GetVRegFloat(vregA) -
                                   shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MUL_FLOAT_2ADDR: {
+      HANDLE_INSTRUCTION(MUL_FLOAT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegFloat(vregA,
                                   shadow_frame.GetVRegFloat(vregA) *
                                   shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DIV_FLOAT_2ADDR: {
+      HANDLE_INSTRUCTION(DIV_FLOAT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegFloat(vregA,
                                   shadow_frame.GetVRegFloat(vregA) /
                                   shadow_frame.GetVRegFloat(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_FLOAT_2ADDR: {
+      HANDLE_INSTRUCTION(REM_FLOAT_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegFloat(vregA,
                                   fmodf(shadow_frame.GetVRegFloat(vregA),
                                         shadow_frame.GetVRegFloat(inst->VRegB_12x())));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::ADD_DOUBLE_2ADDR: {
+      HANDLE_INSTRUCTION(ADD_DOUBLE_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegDouble(vregA,
                                    shadow_frame.GetVRegDouble(vregA) +
                                    shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::SUB_DOUBLE_2ADDR: {
+      HANDLE_INSTRUCTION(SUB_DOUBLE_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegDouble(vregA,
                                    shadow_frame.GetVRegDouble(vregA) -
                                    shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::MUL_DOUBLE_2ADDR: {
+      HANDLE_INSTRUCTION(MUL_DOUBLE_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegDouble(vregA,
                                    shadow_frame.GetVRegDouble(vregA) *
                                    shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::DIV_DOUBLE_2ADDR: {
+      HANDLE_INSTRUCTION(DIV_DOUBLE_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegDouble(vregA,
                                    shadow_frame.GetVRegDouble(vregA) /
                                    shadow_frame.GetVRegDouble(inst->VRegB_12x()));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_DOUBLE_2ADDR: {
+      HANDLE_INSTRUCTION(REM_DOUBLE_2ADDR): {
         PREAMBLE();
         uint4_t vregA = inst->VRegA_12x();
         shadow_frame.SetVRegDouble(vregA,
                                    fmod(shadow_frame.GetVRegDouble(vregA),
                                         shadow_frame.GetVRegDouble(inst->VRegB_12x())));
         inst = inst->Next_1xx();
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::ADD_INT_LIT16:
+      HANDLE_INSTRUCTION(ADD_INT_LIT16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              shadow_frame.GetVReg(inst->VRegB_22s()) +
                              inst->VRegC_22s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::RSUB_INT:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(RSUB_INT):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              inst->VRegC_22s() -
                              shadow_frame.GetVReg(inst->VRegB_22s()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_INT_LIT16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_INT_LIT16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              shadow_frame.GetVReg(inst->VRegB_22s()) *
                              inst->VRegC_22s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_INT_LIT16: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_INT_LIT16): {
         PREAMBLE();
         bool success = DoIntDivide(shadow_frame, inst->VRegA_22s(),
                                    shadow_frame.GetVReg(inst->VRegB_22s()), inst->VRegC_22s());
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_INT_LIT16: {
+      HANDLE_INSTRUCTION(REM_INT_LIT16): {
         PREAMBLE();
         bool success = DoIntRemainder(shadow_frame, inst->VRegA_22s(),
                                       shadow_frame.GetVReg(inst->VRegB_22s()), inst->VRegC_22s());
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AND_INT_LIT16:
+      HANDLE_INSTRUCTION(AND_INT_LIT16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              shadow_frame.GetVReg(inst->VRegB_22s()) &
                              inst->VRegC_22s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::OR_INT_LIT16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(OR_INT_LIT16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              shadow_frame.GetVReg(inst->VRegB_22s()) |
                              inst->VRegC_22s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::XOR_INT_LIT16:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(XOR_INT_LIT16):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22s(),
                              shadow_frame.GetVReg(inst->VRegB_22s()) ^
                              inst->VRegC_22s());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::ADD_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(ADD_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) +
                              inst->VRegC_22b());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::RSUB_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(RSUB_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              inst->VRegC_22b() -
                              shadow_frame.GetVReg(inst->VRegB_22b()));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::MUL_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(MUL_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) *
                              inst->VRegC_22b());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::DIV_INT_LIT8: {
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(DIV_INT_LIT8): {
         PREAMBLE();
         bool success = DoIntDivide(shadow_frame, inst->VRegA_22b(),
                                    shadow_frame.GetVReg(inst->VRegB_22b()), inst->VRegC_22b());
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::REM_INT_LIT8: {
+      HANDLE_INSTRUCTION(REM_INT_LIT8): {
         PREAMBLE();
         bool success = DoIntRemainder(shadow_frame, inst->VRegA_22b(),
                                       shadow_frame.GetVReg(inst->VRegB_22b()), inst->VRegC_22b());
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
-        break;
+        NEXT_INSTRUCTION();
       }
-      case Instruction::AND_INT_LIT8:
+      HANDLE_INSTRUCTION(AND_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) &
                              inst->VRegC_22b());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::OR_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(OR_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) |
                              inst->VRegC_22b());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::XOR_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(XOR_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) ^
                              inst->VRegC_22b());
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SHL_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SHL_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) <<
                              (inst->VRegC_22b() & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::SHR_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(SHR_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              shadow_frame.GetVReg(inst->VRegB_22b()) >>
                              (inst->VRegC_22b() & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::USHR_INT_LIT8:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(USHR_INT_LIT8):
         PREAMBLE();
         shadow_frame.SetVReg(inst->VRegA_22b(),
                              static_cast<uint32_t>(shadow_frame.GetVReg(inst->VRegB_22b())) >>
                              (inst->VRegC_22b() & 0x1f));
         inst = inst->Next_2xx();
-        break;
-      case Instruction::UNUSED_3E ... Instruction::UNUSED_43:
-      case Instruction::UNUSED_EB ... Instruction::UNUSED_FF:
-      case Instruction::UNUSED_79:
-      case Instruction::UNUSED_7A:
+        NEXT_INSTRUCTION();
+      HANDLE_INSTRUCTION(UNUSED_3E):
+      HANDLE_INSTRUCTION(UNUSED_3F):
+      HANDLE_INSTRUCTION(UNUSED_40):
+      HANDLE_INSTRUCTION(UNUSED_41):
+      HANDLE_INSTRUCTION(UNUSED_42):
+      HANDLE_INSTRUCTION(UNUSED_43):
+      HANDLE_INSTRUCTION(UNUSED_79):
+      HANDLE_INSTRUCTION(UNUSED_7A):
+      HANDLE_INSTRUCTION(UNUSED_EB):
+      HANDLE_INSTRUCTION(UNUSED_EC):
+      HANDLE_INSTRUCTION(UNUSED_ED):
+      HANDLE_INSTRUCTION(UNUSED_EE):
+      HANDLE_INSTRUCTION(UNUSED_EF):
+      HANDLE_INSTRUCTION(UNUSED_F0):
+      HANDLE_INSTRUCTION(UNUSED_F1):
+      HANDLE_INSTRUCTION(UNUSED_F2):
+      HANDLE_INSTRUCTION(UNUSED_F3):
+      HANDLE_INSTRUCTION(UNUSED_F4):
+      HANDLE_INSTRUCTION(UNUSED_F5):
+      HANDLE_INSTRUCTION(UNUSED_F6):
+      HANDLE_INSTRUCTION(UNUSED_F7):
+      HANDLE_INSTRUCTION(UNUSED_F8):
+      HANDLE_INSTRUCTION(UNUSED_F9):
+      HANDLE_INSTRUCTION(UNUSED_FA):
+      HANDLE_INSTRUCTION(UNUSED_FB):
+      HANDLE_INSTRUCTION(UNUSED_FC):
+      HANDLE_INSTRUCTION(UNUSED_FD):
+      HANDLE_INSTRUCTION(UNUSED_FE):
+      HANDLE_INSTRUCTION(UNUSED_FF):
         UnexpectedOpcode(inst, mh);
     }
   }
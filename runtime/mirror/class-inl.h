@@ -212,9 +212,19 @@ inline ArtMethod* Class::FindVirtualMethodForInterface(ArtMethod* method) const
   Class* declaring_class = method->GetDeclaringClass();
   DCHECK(declaring_class != NULL) << PrettyClass(this);
   DCHECK(declaring_class->IsInterface()) << PrettyMethod(method);
-  // TODO cache to improve lookup speed
-  int32_t iftable_count = GetIfTableCount();
   IfTable* iftable = GetIfTable();
+  if (UNLIKELY(iftable == NULL)) {
+    return NULL;
+  }
+  ObjectArray<ArtMethod>* imt = iftable->GetImTable();
+  if (LIKELY(imt != NULL)) {
+    size_t index = IfTable::GetImTableIndex(method->GetDexMethodIndex(), imt->GetLength());
+    if (imt->Get(index + IfTable::kImTableInterfaceMethod) == method) {
+      return imt->Get(index + IfTable::kImTableImplementation);
+    }
+  }
+  // Not in the IMT, either because of a collision or because we don't implement the interface.
+  int32_t iftable_count = iftable->Count();
   for (int32_t i = 0; i < iftable_count; i++) {
     if (iftable->GetInterface(i) == declaring_class) {
       return iftable->GetMethodArray(i)->Get(method->GetMethodIndex());
@@ -60,6 +60,31 @@ class MANAGED IfTable : public ObjectArray<Object> {
     return GetLength() / kMax;
   }
 
+  // The interface method table (IMT) of a non-interface class lives in a trailing slot after the
+  // interface entries. It is a small hash table of (interface method, implementation) pairs keyed
+  // by the interface method's dex method index. Colliding interface methods after the first are
+  // left out and resolved by searching the interface entries.
+  ObjectArray<ArtMethod>* GetImTable() const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (GetLength() % kMax == 0) {
+      return NULL;
+    }
+    return down_cast<ObjectArray<ArtMethod>*>(Get(GetLength() - 1));
+  }
+
+  void SetImTable(ObjectArray<ArtMethod>* imt) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    DCHECK(imt != NULL);
+    DCHECK_NE(GetLength() % kMax, 0);
+    DCHECK(Get(GetLength() - 1) == NULL);
+    Set(GetLength() - 1, imt);
+  }
+
+  // Returns the index within an IMT of length imt_length of the pair for an interface method.
+  static size_t GetImTableIndex(uint32_t dex_method_idx, size_t imt_length) {
+    size_t num_entries = imt_length / kImTableMax;
+    DCHECK_EQ(num_entries & (num_entries - 1), 0U);
+    return (dex_method_idx & (num_entries - 1)) * kImTableMax;
+  }
+
   enum {
     // Points to the interface class.
     kInterface   = 0,
@@ -69,6 +94,17 @@ class MANAGED IfTable : public ObjectArray<Object> {
     kMax         = 2,
   };
 
+  enum {
+    // The interface method an IMT entry is for.
+    kImTableInterfaceMethod = 0,
+    // The method implementing it in the class owning the IMT.
+    kImTableImplementation  = 1,
+    kImTableMax             = 2,
+  };
+
+  // Upper bound on the number of entries in an IMT, must be a power of 2.
+  static constexpr size_t kMaxImTableEntries = 64;
+
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(IfTable);
 };
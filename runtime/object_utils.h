@@ -138,7 +138,7 @@ class ClassHelper {
     } else if (klass_->IsArrayClass()) {
       return 2;
     } else if (klass_->IsProxyClass()) {
-      return klass_->GetIfTable()->GetLength();
+      return klass_->GetIfTable()->Count();
     } else {
       const DexFile::TypeList* interfaces = GetInterfaceTypeList();
       if (interfaces == NULL) {
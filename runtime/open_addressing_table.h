@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_OPEN_ADDRESSING_TABLE_H_
+#define ART_RUNTIME_OPEN_ADDRESSING_TABLE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/stl_util.h"
+#include "cutils/atomic-inline.h"
+#include "utils.h"
+
+namespace art {
+
+// An open addressing hash table, with linear probing, of pointers keyed by a hash the caller
+// computes. Slots hold the hash inline next to the pointer so that a probe only dereferences
+// values whose hash matches, and no node is allocated per value. Several values may share a hash
+// or compare equal, it is up to the caller to look before inserting.
+//
+// The table does no locking of its own, mutators must be serialized by the caller. A table
+// created with concurrent_readers may also be searched and visited without that lock, in which
+// case Find may miss a value that is concurrently being inserted: a lock-free miss must be
+// retried under the lock before treating the value as absent. Each slot is published with a
+// store barrier after its hash, and as a lock-free reader may still be probing a slot array that
+// growth replaced, replaced arrays are kept until the table is destroyed. Growth then at least
+// doubles the capacity, so they never take more space than the live array.
+//
+// Lock-free readers take no load barrier. Their loads through the published array and value
+// pointers are ordered by address dependency, so they see the values' contents. They may read a
+// slot's hash older than its value, which only makes them skip the slot, the predicate still
+// decides whether a value matches. Removal only marks slots, so a reader may return a value that
+// is concurrently removed: callers must not remove values that such readers may still return
+// while the readers run.
+template <typename T>
+class OpenAddressingTable {
+ public:
+  explicit OpenAddressingTable(bool concurrent_readers)
+      : concurrent_readers_(concurrent_readers), slots_(new SlotArray(kMinCapacity)),
+        num_values_(0), num_removed_(0) {
+  }
+
+  ~OpenAddressingTable() {
+    delete slots_;
+    STLDeleteElements(&retired_slots_);
+  }
+
+  // Returns the first value with the given hash for which predicate(value) is true, or NULL.
+  template <typename Predicate>
+  T* Find(size_t hash, Predicate& predicate) const {
+    const SlotArray* slots = slots_;
+    const size_t mask = slots->mask;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+      const volatile Slot& slot = slots->slots[i];
+      T* value = slot.value;
+      if (value == NULL) {
+        return NULL;
+      }
+      if (value != Removed() && slot.hash == hash && predicate(value)) {
+        return value;
+      }
+    }
+  }
+
+  // Calls visitor(value) for every value in the table until it returns false.
+  template <typename Visitor>
+  void Visit(Visitor& visitor) const {
+    const SlotArray* slots = slots_;
+    for (size_t i = 0; i <= slots->mask; ++i) {
+      T* value = slots->slots[i].value;
+      if (value != NULL && value != Removed() && !visitor(value)) {
+        return;
+      }
+    }
+  }
+
+  // Adds value, which mustn't be NULL.
+  void Insert(size_t hash, T* value) {
+    DCHECK(value != NULL);
+    if ((num_values_ + num_removed_ + 1) * 2 > slots_->mask + 1) {
+      Resize(1);
+    }
+    SlotArray* slots = const_cast<SlotArray*>(slots_);
+    volatile Slot& slot = slots->slots[FindFreeSlot(slots, hash)];
+    slot.hash = hash;
+    // Lock-free readers treat the slot as used once they see the value, make the hash and the
+    // value's contents visible first.
+    ANDROID_MEMBAR_STORE();
+    slot.value = value;
+    ++num_values_;
+  }
+
+  // Removes value, returning false if it wasn't in the table.
+  bool Remove(size_t hash, const T* value) {
+    SlotArray* slots = const_cast<SlotArray*>(slots_);
+    for (size_t i = hash & slots->mask; slots->slots[i].value != NULL;
+         i = (i + 1) & slots->mask) {
+      if (slots->slots[i].value == value) {
+        // The slot can't become free again as that would cut probe sequences passing through it.
+        slots->slots[i].value = Removed();
+        --num_values_;
+        ++num_removed_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Removes the values for which predicate(value) is true. Rebuilds the table if that leaves
+  // more removed slots than values, as for weak tables a sweep typically removes most of them.
+  template <typename Predicate>
+  void RemoveIf(Predicate& predicate) {
+    SlotArray* slots = const_cast<SlotArray*>(slots_);
+    for (Slot& slot : slots->slots) {
+      if (slot.value != NULL && slot.value != Removed() && predicate(slot.value)) {
+        slot.value = Removed();
+        --num_values_;
+        ++num_removed_;
+      }
+    }
+    if (num_removed_ > num_values_) {
+      Resize(0);
+    }
+  }
+
+  // Grows the table so that num_values more values can be inserted without further growth.
+  void Reserve(size_t num_values) {
+    if ((num_values_ + num_removed_ + num_values) * 2 > slots_->mask + 1) {
+      Resize(num_values);
+    }
+  }
+
+  size_t Size() const {
+    return num_values_;
+  }
+
+ private:
+  struct Slot {
+    size_t hash;
+    // NULL for a never used slot, Removed() for the slot of a removed value.
+    T* value;
+  };
+
+  // The slots together with their mask so that readers see a consistent pair.
+  struct SlotArray {
+    explicit SlotArray(size_t capacity) : mask(capacity - 1) {
+      DCHECK(IsPowerOfTwo(capacity));
+      Slot empty = { 0, NULL };
+      slots.resize(capacity, empty);
+    }
+
+    const size_t mask;
+    std::vector<Slot> slots;
+  };
+
+  static const size_t kMinCapacity = 16;
+
+  // Marks slots whose value was removed, so probes continue past them.
+  static T* Removed() {
+    return reinterpret_cast<T*>(1);
+  }
+
+  // Returns the index of the first never used slot on the probe sequence of hash.
+  static size_t FindFreeSlot(const SlotArray* slots, size_t hash) {
+    size_t i = hash & slots->mask;
+    while (slots->slots[i].value != NULL) {
+      i = (i + 1) & slots->mask;
+    }
+    return i;
+  }
+
+  // Moves the values into a new slot array with a load factor of at most 1/2 after
+  // num_new_values more insertions.
+  void Resize(size_t num_new_values) {
+    size_t min_capacity = kMinCapacity;
+    size_t capacity = RoundUpToPowerOfTwo(std::max((num_values_ + num_new_values) * 2,
+                                                   min_capacity));
+    if (concurrent_readers_) {
+      capacity = std::max(capacity, (slots_->mask + 1) * 2);
+    }
+    SlotArray* new_slots = new SlotArray(capacity);
+    const SlotArray* old_slots = slots_;
+    for (const Slot& slot : old_slots->slots) {
+      if (slot.value != NULL && slot.value != Removed()) {
+        Slot& new_slot = new_slots->slots[FindFreeSlot(new_slots, slot.hash)];
+        new_slot.hash = slot.hash;
+        new_slot.value = slot.value;
+      }
+    }
+    // Make the new slots visible before the array itself.
+    ANDROID_MEMBAR_STORE();
+    slots_ = new_slots;
+    if (concurrent_readers_) {
+      retired_slots_.push_back(old_slots);
+    } else {
+      delete old_slots;
+    }
+    num_removed_ = 0;
+  }
+
+  const bool concurrent_readers_;
+  const SlotArray* volatile slots_;
+
+  // Slot arrays replaced by Resize, see class comment.
+  std::vector<const SlotArray*> retired_slots_;
+
+  // Number of values in the table.
+  size_t num_values_;
+
+  // Number of slots marked as Removed().
+  size_t num_removed_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenAddressingTable);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_OPEN_ADDRESSING_TABLE_H_
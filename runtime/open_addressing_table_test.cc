@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "open_addressing_table.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+// Matches one value by identity, the table itself never looks inside values.
+class IdentityMatcher {
+ public:
+  explicit IdentityMatcher(const int* value) : value_(value) {}
+
+  bool operator()(const int* value) const {
+    return value == value_;
+  }
+
+ private:
+  const int* const value_;
+};
+
+static void TestInsertFindRemove(bool concurrent_readers) {
+  OpenAddressingTable<const int> table(concurrent_readers);
+  const size_t kNumValues = 1000;
+  std::vector<int> values(kNumValues + 1);
+  // Use few distinct hashes so that probe sequences collide and cross growth.
+  for (size_t i = 0; i < kNumValues; ++i) {
+    table.Insert(i % 7, &values[i]);
+  }
+  EXPECT_EQ(kNumValues, table.Size());
+  for (size_t i = 0; i < kNumValues; ++i) {
+    IdentityMatcher matcher(&values[i]);
+    EXPECT_EQ(&values[i], table.Find(i % 7, matcher));
+  }
+  IdentityMatcher missing(&values[kNumValues]);
+  EXPECT_TRUE(table.Find(kNumValues % 7, missing) == NULL);
+
+  // Remove every other value, the rest must stay reachable past the removed slots.
+  for (size_t i = 0; i < kNumValues; i += 2) {
+    EXPECT_TRUE(table.Remove(i % 7, &values[i]));
+  }
+  EXPECT_FALSE(table.Remove(0, &values[0]));
+  EXPECT_EQ(kNumValues / 2, table.Size());
+  for (size_t i = 0; i < kNumValues; ++i) {
+    IdentityMatcher matcher(&values[i]);
+    EXPECT_EQ(i % 2 == 0 ? NULL : &values[i], table.Find(i % 7, matcher));
+  }
+
+  size_t visited = 0;
+  auto visitor = [&visited](const int*) {
+    ++visited;
+    return true;
+  };
+  table.Visit(visitor);
+  EXPECT_EQ(kNumValues / 2, visited);
+}
+
+TEST(OpenAddressingTableTest, InsertFindRemove) {
+  TestInsertFindRemove(false);
+}
+
+TEST(OpenAddressingTableTest, InsertFindRemoveConcurrentReaders) {
+  TestInsertFindRemove(true);
+}
+
+TEST(OpenAddressingTableTest, RemoveIf) {
+  OpenAddressingTable<const int> table(false);
+  const size_t kNumValues = 100;
+  std::vector<int> values(kNumValues);
+  for (size_t i = 0; i < kNumValues; ++i) {
+    values[i] = i;
+    table.Insert(i % 3, &values[i]);
+  }
+  // Removing most values rebuilds the table, the survivors must still be found.
+  auto not_tenth = [](const int* value) {
+    return *value % 10 != 0;
+  };
+  table.RemoveIf(not_tenth);
+  EXPECT_EQ(kNumValues / 10, table.Size());
+  for (size_t i = 0; i < kNumValues; ++i) {
+    IdentityMatcher matcher(&values[i]);
+    EXPECT_EQ(i % 10 == 0 ? &values[i] : NULL, table.Find(i % 3, matcher));
+  }
+}
+
+}  // namespace art
@@ -40,6 +40,7 @@
 #include "image.h"
 #include "instrumentation.h"
 #include "intern_table.h"
+#include "interpreter/inline_cache.h"
 #include "invoke_arg_array_builder.h"
 #include "jni_internal.h"
 #include "mirror/art_field-inl.h"
@@ -78,6 +79,7 @@ Runtime::Runtime()
       monitor_list_(NULL),
       thread_list_(NULL),
       intern_table_(NULL),
+      inline_cache_table_(NULL),
       class_linker_(NULL),
       signal_catcher_(NULL),
       java_vm_(NULL),
@@ -131,6 +133,7 @@ Runtime::~Runtime() {
   delete class_linker_;
   delete heap_;
   delete intern_table_;
+  delete inline_cache_table_;
   delete java_vm_;
   Thread::Shutdown();
   QuasiAtomic::Shutdown();
@@ -354,6 +357,7 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
   parsed->long_pause_log_threshold_ = gc::Heap::kDefaultLongPauseLogThreshold;
   parsed->long_gc_log_threshold_ = gc::Heap::kDefaultLongGCLogThreshold;
   parsed->ignore_max_footprint_ = false;
+  parsed->alloc_sample_interval_ = gc::AllocationSampler::kDefaultSampleInterval;
 
   parsed->lock_profiling_threshold_ = 0;
   parsed->hook_is_sensitive_thread_ = NULL;
@@ -513,6 +517,19 @@ Runtime::ParsedOptions* Runtime::ParsedOptions::Create(const Options& options, b
       parsed->ignore_max_footprint_ = true;
     } else if (option == "-XX:LowMemoryMode") {
       parsed->low_memory_mode_ = true;
+    } else if (StartsWith(option, "-XX:AllocSampleInterval=")) {
+      // 0 disables allocation sampling.
+      std::string value(option.substr(strlen("-XX:AllocSampleInterval=")));
+      size_t interval = (value == "0") ? 0 : ParseMemoryOption(value.c_str(), 1);
+      if (interval == 0 && value != "0") {
+        if (ignore_unrecognized) {
+          continue;
+        }
+        // TODO: usage
+        LOG(FATAL) << "Failed to parse " << option;
+        return NULL;
+      }
+      parsed->alloc_sample_interval_ = interval;
     } else if (StartsWith(option, "-D")) {
       parsed->properties_.push_back(option.substr(strlen("-D")));
     } else if (StartsWith(option, "-Xjnitrace:")) {
@@ -868,6 +885,7 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
   monitor_list_ = new MonitorList;
   thread_list_ = new ThreadList;
   intern_table_ = new InternTable;
+  inline_cache_table_ = new interpreter::InlineCacheTable;
 
 
   if (options->interpreter_only_) {
@@ -887,7 +905,8 @@ bool Runtime::Init(const Options& raw_options, bool ignore_unrecognized) {
                        options->low_memory_mode_,
                        options->long_pause_log_threshold_,
                        options->long_gc_log_threshold_,
-                       options->ignore_max_footprint_);
+                       options->ignore_max_footprint_,
+                       options->alloc_sample_interval_);
 
   BlockSignals();
   InitPlatformSignalHandlers();
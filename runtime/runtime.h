@@ -42,6 +42,9 @@ namespace art {
 namespace gc {
   class Heap;
 }
+namespace interpreter {
+  class InlineCacheTable;
+}
 namespace mirror {
   class ArtMethod;
   class ClassLoader;
@@ -103,6 +106,7 @@ class Runtime {
     size_t long_pause_log_threshold_;
     size_t long_gc_log_threshold_;
     bool ignore_max_footprint_;
+    size_t alloc_sample_interval_;
     size_t heap_initial_size_;
     size_t heap_maximum_size_;
     size_t heap_growth_limit_;
@@ -282,6 +286,10 @@ class Runtime {
     return intern_table_;
   }
 
+  interpreter::InlineCacheTable* GetInlineCacheTable() const {
+    return inline_cache_table_;
+  }
+
   JavaVMExt* GetJavaVM() const {
     return java_vm_;
   }
@@ -457,6 +465,8 @@ class Runtime {
 
   InternTable* intern_table_;
 
+  interpreter::InlineCacheTable* inline_cache_table_;
+
   ClassLinker* class_linker_;
 
   SignalCatcher* signal_catcher_;
@@ -987,11 +987,17 @@ Thread::Thread(bool daemon)
       no_thread_suspension_(0),
       last_no_thread_suspension_cause_(NULL),
       checkpoint_function_(0),
-      thread_exit_check_count_(0) {
+      thread_exit_check_count_(0),
+      thread_local_alloc_stack_top_(NULL),
+      thread_local_alloc_stack_end_(NULL),
+      alloc_sample_bytes_left_(0),
+      alloc_sample_buffer_(NULL) {
   CHECK_EQ((sizeof(Thread) % 4), 0U) << sizeof(Thread);
   state_and_flags_.as_struct.flags = 0;
   state_and_flags_.as_struct.state = kNative;
   memset(&held_mutexes_[0], 0, sizeof(held_mutexes_));
+  memset(&thread_local_alloc_brackets_[0], 0, sizeof(thread_local_alloc_brackets_));
+  interpreter_inline_cache_.Clear();
 }
 
 bool Thread::IsStillStarting() const {
@@ -1049,6 +1055,14 @@ void Thread::Destroy() {
     }
   }
 
+  // Hand back any chunks in our allocation cache. This is done runnable so that we can't race with
+  // a GC revoking the cache while we are suspended.
+  {
+    ScopedObjectAccess soa(self);
+    Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+  }
+  Runtime::Current()->GetHeap()->GetAllocationSampler()->ThreadDetached(self);
+
   // On thread detach, all monitors entered with JNI MonitorEnter are automatically exited.
   if (jni_env_ != NULL) {
     jni_env_->monitors.VisitRoots(MonitorExitVisitor, self);
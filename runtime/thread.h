@@ -31,6 +31,7 @@
 #include "entrypoints/portable/portable_entrypoints.h"
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "globals.h"
+#include "interpreter/inline_cache.h"
 #include "jvalue.h"
 #include "locks.h"
 #include "offsets.h"
@@ -57,6 +58,9 @@ namespace mirror {
   class StaticStorageBase;
   class Throwable;
 }  // namespace mirror
+namespace gc {
+  class AllocationSampleBuffer;
+}  // namespace gc
 class BaseMutex;
 class ClassLinker;
 class Closure;
@@ -590,6 +594,62 @@ class PACKED(4) Thread {
 
   void AtomicClearFlag(ThreadFlag flag);
 
+  // Number of size brackets in the thread-local allocation cache, see
+  // DlMallocSpace::AllocThreadLocal.
+  static constexpr size_t kNumThreadLocalAllocBrackets = 16;
+
+  // Returns the head of the free list of pre-allocated chunks for the given size bracket.
+  mirror::Object* GetThreadLocalAllocBracket(size_t bracket) const {
+    DCHECK_LT(bracket, kNumThreadLocalAllocBrackets);
+    return thread_local_alloc_brackets_[bracket];
+  }
+
+  void SetThreadLocalAllocBracket(size_t bracket, mirror::Object* head) {
+    DCHECK_LT(bracket, kNumThreadLocalAllocBrackets);
+    thread_local_alloc_brackets_[bracket] = head;
+  }
+
+  interpreter::ThreadInlineCache* GetInterpreterInlineCache() {
+    return &interpreter_inline_cache_;
+  }
+
+  // Counts bytes allocated towards the next allocation sample, returns true when it is due. See
+  // gc::AllocationSampler.
+  bool CountAllocSampleBytes(size_t bytes) {
+    if (LIKELY(bytes < alloc_sample_bytes_left_)) {
+      alloc_sample_bytes_left_ -= bytes;
+      return false;
+    }
+    return true;
+  }
+
+  void SetAllocSampleBytesLeft(size_t bytes) {
+    alloc_sample_bytes_left_ = bytes;
+  }
+
+  // Pushes obj on this thread's segment of the heap's allocation stack, returns false if the
+  // segment is full.
+  bool PushOnThreadLocalAllocationStack(mirror::Object* obj) {
+    if (thread_local_alloc_stack_top_ < thread_local_alloc_stack_end_) {
+      *thread_local_alloc_stack_top_++ = obj;
+      return true;
+    }
+    return false;
+  }
+
+  void SetThreadLocalAllocationStack(mirror::Object** start, mirror::Object** end) {
+    thread_local_alloc_stack_top_ = start;
+    thread_local_alloc_stack_end_ = end;
+  }
+
+  gc::AllocationSampleBuffer* GetAllocationSampleBuffer() const {
+    return alloc_sample_buffer_;
+  }
+
+  void SetAllocationSampleBuffer(gc::AllocationSampleBuffer* buffer) {
+    alloc_sample_buffer_ = buffer;
+  }
+
  private:
   // We have no control over the size of 'bool', but want our boolean fields
   // to be 4-byte quantities.
@@ -812,6 +872,25 @@ class PACKED(4) Thread {
   // How many times has our pthread key's destructor been called?
   uint32_t thread_exit_check_count_;
 
+  // Free lists of alloc space chunks handed to this thread so that small allocations don't need
+  // to take the alloc space lock. Only accessed by this thread while runnable, or by others while
+  // this thread is suspended.
+  mirror::Object* thread_local_alloc_brackets_[kNumThreadLocalAllocBrackets];
+
+  // Targets of the virtual and interface calls recently made by the interpreter on this thread.
+  interpreter::ThreadInlineCache interpreter_inline_cache_;
+
+  // The unused part of the segment of the heap's allocation stack reserved by this thread. Only
+  // accessed by this thread while runnable, or by others while this thread is suspended.
+  mirror::Object** thread_local_alloc_stack_top_;
+  mirror::Object** thread_local_alloc_stack_end_;
+
+  // Bytes this thread may still allocate before its next allocation sample is taken.
+  size_t alloc_sample_bytes_left_;
+
+  // Allocation samples not yet added to the heap's histogram, created on the first allocation.
+  gc::AllocationSampleBuffer* alloc_sample_buffer_;
+
   friend class ScopedThreadStateChange;
 
   DISALLOW_COPY_AND_ASSIGN(Thread);
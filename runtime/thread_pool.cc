@@ -18,6 +18,7 @@
 
 #include "base/casts.h"
 #include "base/stl_util.h"
+#include "cutils/atomic-inline.h"
 #include "runtime.h"
 #include "thread.h"
 
@@ -25,11 +26,91 @@ namespace art {
 
 static constexpr bool kMeasureWaitTime = false;
 
+TaskDeque::TaskDeque() : top_(0), bottom_(0), array_(new TaskArray(kInitialCapacity)) {
+}
+
+TaskDeque::~TaskDeque() {
+  delete array_;
+  STLDeleteElements(&retired_arrays_);
+}
+
+void TaskDeque::Push(Task* task) {
+  int32_t bottom = bottom_;
+  int32_t top = top_;
+  TaskArray* array = array_;
+  if (static_cast<size_t>(bottom - top) > array->mask) {
+    // Full, move the tasks to an array twice the size. Thieves may still read the old array.
+    TaskArray* new_array = new TaskArray((array->mask + 1) * 2);
+    for (int32_t i = top; i != bottom; ++i) {
+      new_array->tasks[i & new_array->mask] = array->tasks[i & array->mask];
+    }
+    retired_arrays_.push_back(array);
+    array = new_array;
+    // Make the copied tasks visible before the array.
+    ANDROID_MEMBAR_STORE();
+    array_ = array;
+  }
+  array->tasks[bottom & array->mask] = task;
+  // Make the task visible to thieves before the bottom index that covers it.
+  ANDROID_MEMBAR_STORE();
+  bottom_ = bottom + 1;
+}
+
+Task* TaskDeque::Pop() {
+  int32_t bottom = bottom_ - 1;
+  TaskArray* array = array_;
+  bottom_ = bottom;
+  // Thieves must see the reservation of the bottom task before we read top.
+  ANDROID_MEMBAR_FULL();
+  int32_t top = top_;
+  if (bottom < top) {
+    // Empty.
+    bottom_ = top;
+    return NULL;
+  }
+  Task* task = array->tasks[bottom & array->mask];
+  if (bottom == top) {
+    // Last task, race thieves for it by advancing top.
+    if (android_atomic_cas(top, top + 1, &top_) != 0) {
+      task = NULL;
+    }
+    bottom_ = top + 1;
+  }
+  return task;
+}
+
+Task* TaskDeque::Steal() {
+  int32_t top = top_;
+  // Read top before bottom, pairing with the barrier in Pop.
+  ANDROID_MEMBAR_FULL();
+  int32_t bottom = bottom_;
+  if (top >= bottom) {
+    return NULL;
+  }
+  // Read the array and task after bottom, pairing with the barriers in Push.
+  ANDROID_MEMBAR_FULL();
+  TaskArray* array = array_;
+  Task* task = array->tasks[top & array->mask];
+  if (android_atomic_cas(top, top + 1, &top_) != 0) {
+    // Lost the race to the owner or another thief.
+    return NULL;
+  }
+  return task;
+}
+
 ThreadPoolWorker::ThreadPoolWorker(ThreadPool* thread_pool, const std::string& name,
                                    size_t stack_size)
     : thread_pool_(thread_pool),
       name_(name),
-      stack_size_(stack_size) {
+      stack_size_(stack_size),
+      // Workers are appended to the thread pool as soon as they're constructed.
+      index_(thread_pool->GetThreadCount()),
+      self_(NULL),
+      steal_seed_(index_ + 1),
+      tasks_run_(0),
+      tasks_stolen_(0),
+      busy_time_(0),
+      idle_time_(0) {
   const char* reason = "new thread pool worker thread";
   pthread_attr_t attr;
   CHECK_PTHREAD_CALL(pthread_attr_init, (&attr), reason);
@@ -44,14 +125,23 @@ ThreadPoolWorker::~ThreadPoolWorker() {
 
 void ThreadPoolWorker::Run() {
   Thread* self = Thread::Current();
+  self_ = self;
   Task* task = NULL;
   thread_pool_->creation_barier_.Wait(self);
-  while ((task = thread_pool_->GetTask(self)) != NULL) {
-    task->Run(self);
-    task->Finalize();
+  while ((task = thread_pool_->GetTask(self, this)) != NULL) {
+    RunTask(self, task);
   }
 }
 
+void ThreadPoolWorker::RunTask(Thread* self, Task* task) {
+  const uint64_t start_time = NanoTime();
+  task->Run(self);
+  task->Finalize();
+  busy_time_ += NanoTime() - start_time;
+  ++tasks_run_;
+  thread_pool_->FinishTask(self);
+}
+
 void* ThreadPoolWorker::Callback(void* arg) {
   ThreadPoolWorker* worker = reinterpret_cast<ThreadPoolWorker*>(arg);
   Runtime* runtime = Runtime::Current();
@@ -63,8 +153,24 @@ void* ThreadPoolWorker::Callback(void* arg) {
 }
 
 void ThreadPool::AddTask(Thread* self, Task* task) {
+  // Count the task before any thread can run it.
+  ++num_pending_tasks_;
+  ThreadPoolWorker* worker = FindWorker(self);
+  if (worker != NULL) {
+    // Tasks adding tasks keep them local, idle workers steal them.
+    worker->tasks_.Push(task);
+    // Waiting workers recheck for tasks after incrementing waiting_count_, so either they see
+    // this task or we see them waiting.
+    ANDROID_MEMBAR_FULL();
+    if (waiting_count_ != 0) {
+      MutexLock mu(self, task_queue_lock_);
+      task_queue_condition_.Signal(self);
+    }
+    return;
+  }
   MutexLock mu(self, task_queue_lock_);
   tasks_.push_back(task);
+  num_queued_tasks_ = tasks_.size();
   // If we have any waiters, signal one.
   if (started_ && waiting_count_ != 0) {
     task_queue_condition_.Signal(self);
@@ -78,6 +184,8 @@ ThreadPool::ThreadPool(size_t num_threads)
     started_(false),
     shutting_down_(false),
     waiting_count_(0),
+    num_queued_tasks_(0),
+    num_pending_tasks_(0),
     start_time_(0),
     total_wait_time_(0),
     // Add one since the caller of constructor waits on the barrier too.
@@ -125,63 +233,124 @@ void ThreadPool::StopWorkers(Thread* self) {
   started_ = false;
 }
 
-Task* ThreadPool::GetTask(Thread* self) {
-  MutexLock mu(self, task_queue_lock_);
-  while (!IsShuttingDown()) {
-    const size_t thread_count = GetThreadCount();
-    // Ensure that we don't use more threads than the maximum active workers.
-    const size_t active_threads = thread_count - waiting_count_;
-    // <= since self is considered an active worker.
-    if (active_threads <= max_active_workers_) {
-      Task* task = TryGetTaskLocked(self);
-      if (task != NULL) {
-        return task;
-      }
+Task* ThreadPool::GetTask(Thread* self, ThreadPoolWorker* worker) {
+  while (true) {
+    Task* task = TryGetTask(self, worker);
+    if (task != NULL) {
+      return task;
     }
-
-    ++waiting_count_;
-    if (waiting_count_ == GetThreadCount() && tasks_.empty()) {
-      // We may be done, lets broadcast to the completion condition.
-      completion_condition_.Broadcast(self);
+    MutexLock mu(self, task_queue_lock_);
+    if (IsShuttingDown()) {
+      // We are shutting down, return NULL to tell the worker thread to stop looping.
+      return NULL;
     }
-    const uint64_t wait_start = kMeasureWaitTime ? NanoTime() : 0;
-    task_queue_condition_.Wait(self);
-    if (kMeasureWaitTime) {
+    ++waiting_count_;
+    // Recheck after announcing that we wait, pairing with the barrier in AddTask.
+    ANDROID_MEMBAR_FULL();
+    if (!HasAvailableTask(worker)) {
+      const uint64_t wait_start = NanoTime();
+      task_queue_condition_.Wait(self);
       const uint64_t wait_end = NanoTime();
-      total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+      worker->idle_time_ += wait_end - wait_start;
+      if (kMeasureWaitTime) {
+        total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+      }
     }
     --waiting_count_;
   }
+}
 
-  // We are shutting down, return NULL to tell the worker thread to stop looping.
+Task* ThreadPool::TryGetTask(Thread* self, ThreadPoolWorker* worker) {
+  if (!started_ || (worker != NULL && worker->index_ >= max_active_workers_)) {
+    return NULL;
+  }
+  if (worker != NULL) {
+    Task* task = worker->tasks_.Pop();
+    if (task != NULL) {
+      return task;
+    }
+  }
+  if (num_queued_tasks_ != 0) {
+    MutexLock mu(self, task_queue_lock_);
+    if (started_ && !tasks_.empty()) {
+      Task* task = tasks_.front();
+      tasks_.pop_front();
+      num_queued_tasks_ = tasks_.size();
+      return task;
+    }
+  }
+  return StealTask(worker);
+}
+
+Task* ThreadPool::StealTask(ThreadPoolWorker* worker) {
+  const size_t thread_count = GetThreadCount();
+  if (thread_count == 0) {
+    return NULL;
+  }
+  // Start at a random victim so that thieves spread out.
+  size_t start = 0;
+  if (worker != NULL) {
+    worker->steal_seed_ = worker->steal_seed_ * 1103515245 + 12345;
+    start = (worker->steal_seed_ >> 16) % thread_count;
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    ThreadPoolWorker* victim = threads_[(start + i) % thread_count];
+    if (victim != worker) {
+      Task* task = victim->tasks_.Steal();
+      if (task != NULL) {
+        if (worker != NULL) {
+          ++worker->tasks_stolen_;
+        }
+        return task;
+      }
+    }
+  }
   return NULL;
 }
 
-Task* ThreadPool::TryGetTask(Thread* self) {
-  MutexLock mu(self, task_queue_lock_);
-  return TryGetTaskLocked(self);
+bool ThreadPool::HasAvailableTask(ThreadPoolWorker* worker) const {
+  if (!started_ || (worker != NULL && worker->index_ >= max_active_workers_)) {
+    return false;
+  }
+  if (num_queued_tasks_ != 0) {
+    return true;
+  }
+  for (ThreadPoolWorker* other : threads_) {
+    if (other->tasks_.Size() != 0) {
+      return true;
+    }
+  }
+  return false;
 }
 
-Task* ThreadPool::TryGetTaskLocked(Thread* self) {
-  if (started_ && !tasks_.empty()) {
-    Task* task = tasks_.front();
-    tasks_.pop_front();
-    return task;
+ThreadPoolWorker* ThreadPool::FindWorker(Thread* self) const {
+  for (ThreadPoolWorker* worker : threads_) {
+    if (worker->self_ == self) {
+      return worker;
+    }
   }
   return NULL;
 }
 
+void ThreadPool::FinishTask(Thread* self) {
+  if (--num_pending_tasks_ == 0) {
+    MutexLock mu(self, task_queue_lock_);
+    completion_condition_.Broadcast(self);
+  }
+}
+
 void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
   if (do_work) {
     Task* task = NULL;
-    while ((task = TryGetTask(self)) != NULL) {
+    while ((task = TryGetTask(self, NULL)) != NULL) {
       task->Run(self);
       task->Finalize();
+      FinishTask(self);
     }
   }
-  // Wait until each thread is waiting and the task list is empty.
+  // Wait until every task has finished.
   MutexLock mu(self, task_queue_lock_);
-  while (!shutting_down_ && (waiting_count_ != GetThreadCount() || !tasks_.empty())) {
+  while (!shutting_down_ && num_pending_tasks_ != 0) {
     if (!may_hold_locks) {
       completion_condition_.Wait(self);
     } else {
@@ -192,7 +361,19 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
 
 size_t ThreadPool::GetTaskCount(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return tasks_.size();
+  size_t task_count = tasks_.size();
+  for (ThreadPoolWorker* worker : threads_) {
+    task_count += worker->tasks_.Size();
+  }
+  return task_count;
+}
+
+void ThreadPool::DumpStats(std::ostream& os) const {
+  for (ThreadPoolWorker* worker : threads_) {
+    os << worker->name_ << ": ran " << worker->tasks_run_ << " tasks, stole "
+       << worker->tasks_stolen_ << ", busy " << PrettyDuration(worker->busy_time_) << ", idle "
+       << PrettyDuration(worker->idle_time_) << "\n";
+  }
 }
 
 WorkStealingWorker::WorkStealingWorker(ThreadPool* thread_pool, const std::string& name,
@@ -203,7 +384,7 @@ void WorkStealingWorker::Run() {
   Thread* self = Thread::Current();
   Task* task = NULL;
   WorkStealingThreadPool* thread_pool = down_cast<WorkStealingThreadPool*>(thread_pool_);
-  while ((task = thread_pool_->GetTask(self)) != NULL) {
+  while ((task = thread_pool_->GetTask(self, this)) != NULL) {
     WorkStealingTask* stealing_task = down_cast<WorkStealingTask*>(task);
 
     {
@@ -265,6 +446,7 @@ void WorkStealingWorker::Run() {
     if (finalize) {
       stealing_task->Finalize();
     }
+    thread_pool_->FinishTask(self);
   }
 }
 
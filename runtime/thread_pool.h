@@ -18,8 +18,10 @@
 #define ART_RUNTIME_THREAD_POOL_H_
 
 #include <deque>
+#include <iosfwd>
 #include <vector>
 
+#include "atomic_integer.h"
 #include "barrier.h"
 #include "base/mutex.h"
 #include "closure.h"
@@ -35,6 +37,51 @@ class Task : public Closure {
   virtual void Finalize() { }
 };
 
+// A Chase-Lev work stealing deque of tasks. Only the owning worker may Push and Pop, which work
+// on the bottom end without atomic operations unless the deque is almost empty. Any thread may
+// Steal from the top end. Arrays replaced when the deque grows are kept until the deque is
+// destroyed, since a concurrent Steal may still be reading them.
+class TaskDeque {
+ public:
+  TaskDeque();
+  ~TaskDeque();
+
+  void Push(Task* task);
+
+  // Returns the most recently pushed task, or NULL if the deque is empty or a thief took the
+  // last task.
+  Task* Pop();
+
+  // Returns the least recently pushed task, or NULL if the deque is empty or another thread
+  // won the race for the task.
+  Task* Steal();
+
+  // Only a snapshot when other threads use the deque.
+  size_t Size() const {
+    int32_t size = bottom_ - top_;
+    return size > 0 ? size : 0;
+  }
+
+ private:
+  struct TaskArray {
+    explicit TaskArray(size_t capacity) : mask(capacity - 1), tasks(capacity) {}
+
+    const size_t mask;
+    std::vector<Task*> tasks;
+  };
+
+  static const size_t kInitialCapacity = 64;
+
+  // Index of the next task to steal, only ever incremented.
+  volatile int32_t top_;
+  // Index of the next task to push.
+  volatile int32_t bottom_;
+  TaskArray* volatile array_;
+  std::vector<TaskArray*> retired_arrays_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskDeque);
+};
+
 class ThreadPoolWorker {
  public:
   static const size_t kDefaultStackSize = 1 * MB;
@@ -50,10 +97,27 @@ class ThreadPoolWorker {
   static void* Callback(void* arg) LOCKS_EXCLUDED(Locks::mutator_lock_);
   virtual void Run();
 
+  // Runs a task the worker got from the thread pool and records it in the statistics.
+  void RunTask(Thread* self, Task* task);
+
   ThreadPool* const thread_pool_;
   const std::string name_;
   const size_t stack_size_;
   pthread_t pthread_;
+  // Position in the thread pool, workers beyond the maximum active workers don't take tasks.
+  const size_t index_;
+  // The worker's runtime thread, NULL until the worker has attached.
+  Thread* volatile self_;
+  // Tasks added by this worker's tasks, which other threads may steal.
+  TaskDeque tasks_;
+  // State of the random number generator choosing whom to steal from.
+  uint32_t steal_seed_;
+
+  // Statistics, only updated by the worker itself.
+  size_t tasks_run_;
+  size_t tasks_stolen_;
+  uint64_t busy_time_;
+  uint64_t idle_time_;
 
  private:
   friend class ThreadPool;
@@ -80,7 +144,8 @@ class ThreadPool {
   explicit ThreadPool(size_t num_threads);
   virtual ~ThreadPool();
 
-  // Wait for all tasks currently on queue to get completed.
+  // Wait for all tasks currently on queue to get completed. Only waits on a lock once no task is
+  // left for the caller to run, and workers only take the lock to signal the last completion.
   void Wait(Thread* self, bool do_work, bool may_hold_locks);
 
   size_t GetTaskCount(Thread* self);
@@ -94,13 +159,27 @@ class ThreadPool {
   // thread count of the thread pool.
   void SetMaxActiveWorkers(size_t threads);
 
+  // Dumps the number of tasks each worker ran and stole and how long it was busy and idle.
+  void DumpStats(std::ostream& os) const;
+
  protected:
-  // Get a task to run, blocks if there are no tasks left
-  virtual Task* GetTask(Thread* self);
+  // Get a task to run, blocks if there are no tasks left. Looks in the worker's own deque first,
+  // then in the queue of tasks added by other threads and finally steals from a random worker.
+  virtual Task* GetTask(Thread* self, ThreadPoolWorker* worker);
+
+  // Try to get a task, returning NULL if there is none available. worker is NULL for threads
+  // outside the pool.
+  Task* TryGetTask(Thread* self, ThreadPoolWorker* worker);
+  Task* StealTask(ThreadPoolWorker* worker);
+
+  // Whether worker, or a thread outside the pool if NULL, could find a task to run.
+  bool HasAvailableTask(ThreadPoolWorker* worker) const;
+
+  // Returns the worker running on self, or NULL.
+  ThreadPoolWorker* FindWorker(Thread* self) const;
 
-  // Try to get a task, returning NULL if there is none available.
-  Task* TryGetTask(Thread* self);
-  Task* TryGetTaskLocked(Thread* self) EXCLUSIVE_LOCKS_REQUIRED(task_queue_lock_);
+  // Called after a task obtained from the pool has run, wakes waiters once all tasks are done.
+  void FinishTask(Thread* self);
 
   // Are we shutting down?
   bool IsShuttingDown() const EXCLUSIVE_LOCKS_REQUIRED(task_queue_lock_) {
@@ -110,18 +189,25 @@ class ThreadPool {
   Mutex task_queue_lock_;
   ConditionVariable task_queue_condition_ GUARDED_BY(task_queue_lock_);
   ConditionVariable completion_condition_ GUARDED_BY(task_queue_lock_);
-  volatile bool started_ GUARDED_BY(task_queue_lock_);
+  // started_, waiting_count_ and max_active_workers_ are written with task_queue_lock_ held, but
+  // workers also read them without the lock when looking for tasks.
+  volatile bool started_;
   volatile bool shutting_down_ GUARDED_BY(task_queue_lock_);
   // How many worker threads are waiting on the condition.
-  volatile size_t waiting_count_ GUARDED_BY(task_queue_lock_);
+  volatile size_t waiting_count_;
+  // Tasks added by threads outside the pool.
   std::deque<Task*> tasks_ GUARDED_BY(task_queue_lock_);
+  // Size of tasks_, to check for tasks without the lock.
+  volatile size_t num_queued_tasks_;
+  // Tasks added and not yet finished, wherever they are queued.
+  AtomicInteger num_pending_tasks_;
   // TODO: make this immutable/const?
   std::vector<ThreadPoolWorker*> threads_;
   // Work balance detection.
   uint64_t start_time_ GUARDED_BY(task_queue_lock_);
   uint64_t total_wait_time_;
   Barrier creation_barier_;
-  size_t max_active_workers_ GUARDED_BY(task_queue_lock_);
+  volatile size_t max_active_workers_;
 
  private:
   friend class ThreadPoolWorker;
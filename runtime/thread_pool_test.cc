@@ -15,6 +15,7 @@
  */
 
 
+#include <sstream>
 #include <string>
 
 #include "atomic_integer.h"
@@ -138,4 +139,22 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count);
 }
 
+// Test that tasks added from within tasks get spread over the workers and all run once.
+TEST_F(ThreadPoolTest, WorkStealing) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool(num_threads);
+  AtomicInteger count(0);
+  static const int depth = 14;
+  // Deep enough for the worker deques to grow past their initial capacity.
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  thread_pool.StopWorkers(self);
+  EXPECT_EQ((1 << depth) - 1, count);
+  EXPECT_EQ(0U, thread_pool.GetTaskCount(self));
+  std::ostringstream stats;
+  thread_pool.DumpStats(stats);
+  EXPECT_NE(std::string::npos, stats.str().find("Thread pool worker 0"));
+}
+
 }  // namespace art
@@ -84,6 +84,22 @@ int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
   return hash;
 }
 
+int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8) {
+  int32_t hash = 0;
+  while (*utf8 != '\0') {
+    hash = hash * 31 + GetUtf16FromUtf8(&utf8);
+  }
+  return hash;
+}
+
+size_t ComputeModifiedUtf8Hash(const char* chars) {
+  size_t hash = 0;
+  while (*chars != '\0') {
+    hash = hash * 31 + static_cast<uint8_t>(*chars++);
+  }
+  return hash;
+}
+
 
 uint16_t GetUtf16FromUtf8(const char** utf8_data_in) {
   uint8_t one = *(*utf8_data_in)++;
@@ -76,6 +76,18 @@ int32_t ComputeUtf16Hash(const mirror::CharArray* chars, int32_t offset, size_t
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count);
 
+/*
+ * The java.lang.String hashCode() algorithm applied to the UTF-16 characters of a NUL-terminated
+ * modified UTF-8 string, without converting the string.
+ */
+int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8);
+
+/*
+ * The java.lang.String hashCode() algorithm applied to the bytes of a NUL-terminated modified
+ * UTF-8 string, such as a class descriptor. Only matches the String hash code for ASCII strings.
+ */
+size_t ComputeModifiedUtf8Hash(const char* chars);
+
 /*
  * Retrieve the next UTF-16 character from a UTF-8 string.
  *
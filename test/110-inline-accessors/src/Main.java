@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Test inlining of trivial accessors, see comment in info.txt
+ */
+final class Holder {
+    private int a = 1;
+    private int b = 2;
+    private long wide = 3L;
+    private Object ref = "ref";
+
+    public int getA() { return a; }
+    public int getB() { return b; }
+    public long getWide() { return wide; }
+    public Object getRef() { return ref; }
+    public void setA(int value) { a = value; }
+    public void setB(int value) { b = value; }
+    public void setWide(long value) { wide = value; }
+    public void setRef(Object value) { ref = value; }
+    public void nothing() { }
+}
+
+// Accessors of package-private fields of various sizes, also accessible from the caller.
+final class Packed {
+    int i = 7;
+    short s = -2;
+    char c = 'c';
+    byte b = -3;
+    boolean z = true;
+    double d = 0.5;
+    volatile int v = 9;
+
+    int getI() { return i; }
+    short getS() { return s; }
+    char getC() { return c; }
+    byte getB() { return b; }
+    boolean getZ() { return z; }
+    double getD() { return d; }
+    int getV() { return v; }
+    void setI(int value) { i = value; }
+    void setS(short value) { s = value; }
+    void setC(char value) { c = value; }
+    void setB(byte value) { b = value; }
+    void setZ(boolean value) { z = value; }
+    void setD(double value) { d = value; }
+    void setV(int value) { v = value; }
+}
+
+public class Main {
+    public static void main(String args[]) {
+        Holder holder = new Holder();
+        testGetters(holder);
+        testSetters(holder);
+        testGetters(holder);
+        testNull(null);
+        Packed packed = new Packed();
+        testPacked(packed);
+        testPackedSetters(packed);
+        testPacked(packed);
+        System.out.println("loop sum=" + sumInLoop(holder, packed, 100));
+        testPackedNull(null);
+        System.out.println("done");
+    }
+
+    static void testPacked(Packed p) {
+        System.out.println("i=" + p.getI() + " s=" + p.getS() + " c=" + p.getC() + " b=" +
+                           p.getB() + " z=" + p.getZ() + " d=" + p.getD() + " v=" + p.getV());
+    }
+
+    static void testPackedSetters(Packed p) {
+        p.setI(-70);
+        p.setS((short) 30000);
+        p.setC('Z');
+        p.setB((byte) 127);
+        p.setZ(false);
+        p.setD(-1.25);
+        p.setV(90);
+    }
+
+    static int sumInLoop(Holder h, Packed p, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += h.getA() + p.getI() + p.getB();
+            p.setS((short) i);
+        }
+        return sum + p.getS();
+    }
+
+    static void testPackedNull(Packed p) {
+        try {
+            p.getI();
+            System.out.println("package getter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("package getter: NullPointerException");
+        }
+        try {
+            p.getD();
+            System.out.println("package wide getter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("package wide getter: NullPointerException");
+        }
+        try {
+            p.setC('x');
+            System.out.println("package setter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("package setter: NullPointerException");
+        }
+        try {
+            p.setV(1);
+            System.out.println("volatile setter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("volatile setter: NullPointerException");
+        }
+    }
+
+    static void testGetters(Holder h) {
+        System.out.println("a=" + h.getA() + " b=" + h.getB() + " wide=" + h.getWide() +
+                           " ref=" + h.getRef());
+    }
+
+    static void testSetters(Holder h) {
+        h.setA(10);
+        h.setB(20);
+        h.setWide(0x100000000L);
+        h.setRef("changed");
+        h.nothing();
+    }
+
+    static void testNull(Holder h) {
+        try {
+            h.getB();
+            System.out.println("getter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("getter: NullPointerException");
+        }
+        try {
+            h.setB(5);
+            System.out.println("setter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("setter: NullPointerException");
+        }
+        try {
+            h.setWide(5L);
+            System.out.println("wide setter: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("wide setter: NullPointerException");
+        }
+        try {
+            h.nothing();
+            System.out.println("empty method: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("empty method: NullPointerException");
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Test suspend check elimination in counted loops, see comment in info.txt
+ */
+public class Main {
+    public static void main(String[] args) throws Exception {
+        System.out.println("nested 16x16: " + nested16());
+        System.out.println("nested 16x17: " + nested17());
+        System.out.println("siblings 2x(64+64): " + siblings(2));
+        System.out.println("siblings 3x(64+64): " + siblings(3));
+        System.out.println("increment test: " + incrementTest());
+        System.out.println("offset test: " + offsetTest());
+        System.out.println("down count: " + downCount());
+
+        Spinner spinner = new Spinner();
+        spinner.start();
+        while (!spinner.running) {
+            Thread.sleep(10);
+        }
+        // Each collection suspends all threads, which needs the spinner to reach a suspend check.
+        for (int i = 0; i < 5; i++) {
+            System.gc();
+        }
+        spinner.stopNow();
+        spinner.join();
+        System.out.println("spinner stopped");
+    }
+
+    // 256 iterations in total, both loops may go unchecked.
+    static int nested16() {
+        int sum = 0;
+        for (int i = 0; i < 16; i++) {
+            for (int j = 0; j < 16; j++) {
+                sum += i * j;
+            }
+        }
+        return sum;
+    }
+
+    // 272 iterations in total, the outer loop keeps its check.
+    static int nested17() {
+        int sum = 0;
+        for (int i = 0; i < 16; i++) {
+            for (int j = 0; j <= 16; j++) {
+                sum += i ^ j;
+            }
+        }
+        return sum;
+    }
+
+    // 2 * (64 + 64) = 256 iterations may go unchecked, 3 * (64 + 64) = 384 may not.
+    static int siblings(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < 64; j++) {
+                sum += j;
+            }
+            for (int k = 0; k < 64; k++) {
+                sum -= k >> 1;
+            }
+        }
+        return sum;
+    }
+
+    // Tests the increment of the induction variable rather than the variable itself.
+    static int incrementTest() {
+        int count = 0;
+        for (int i = 0; i + 1 < 200; i++) {
+            count++;
+        }
+        return count;
+    }
+
+    // Runs 30000 iterations although the test subtracts a constant from the variable.
+    static int offsetTest() {
+        int count = 0;
+        for (int i = 0; i - 30000 < 0; i++) {
+            count++;
+        }
+        return count;
+    }
+
+    static int downCount() {
+        int sum = 0;
+        for (int i = 255; i >= 0; i -= 3) {
+            sum += i;
+        }
+        return sum;
+    }
+}
+
+class Spinner extends Thread {
+    volatile boolean running = false;
+    volatile private boolean keepGoing = true;
+    int sum = 0;
+
+    public void run() {
+        running = true;
+        // The outer loop isn't counted, so it must keep its suspend check.
+        while (keepGoing) {
+            for (int i = 0; i < 100; i++) {
+                sum += i;
+            }
+            for (int j = 0; j + 1 < 100; j++) {
+                sum -= j;
+            }
+        }
+    }
+
+    public void stopNow() {
+        keepGoing = false;
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Test range check elimination in counted loops, see comment in info.txt
+ */
+public class Main {
+    public static void main(String[] args) {
+        int[] array = new int[10];
+        System.out.println("fill: " + fill(array));
+        System.out.println("sum: " + sum(array));
+        System.out.println("copy: " + copy(array, new int[10]));
+
+        try {
+            upToLength(array);
+            System.out.println("upToLength: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println("upToLength: ArrayIndexOutOfBoundsException");
+        }
+        try {
+            belowLengthPlusOne(array);
+            System.out.println("belowLengthPlusOne: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println("belowLengthPlusOne: ArrayIndexOutOfBoundsException");
+        }
+        try {
+            fromNegative(array);
+            System.out.println("fromNegative: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println("fromNegative: ArrayIndexOutOfBoundsException");
+        }
+        try {
+            reassigned(array, new int[5]);
+            System.out.println("reassigned: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println("reassigned: ArrayIndexOutOfBoundsException");
+        }
+        try {
+            otherArray(array, new int[5]);
+            System.out.println("otherArray: no exception");
+        } catch (ArrayIndexOutOfBoundsException expected) {
+            System.out.println("otherArray: ArrayIndexOutOfBoundsException");
+        }
+    }
+
+    static int fill(int[] a) {
+        for (int i = 0; i < a.length; i++) {
+            a[i] = i * 3;
+        }
+        return a[a.length - 1];
+    }
+
+    static int sum(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int copy(int[] a, int[] b) {
+        for (int i = 2; i < a.length; i++) {
+            b[i] = a[i] + 1;
+        }
+        return b[0] + b[2] + b[9];
+    }
+
+    static int upToLength(int[] a) {
+        int sum = 0;
+        for (int i = 0; i <= a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int belowLengthPlusOne(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length + 1; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    static int fromNegative(int[] a) {
+        int sum = 0;
+        for (int i = -1; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    // The array shrinks after the test, so the access must still be checked.
+    static int reassigned(int[] a, int[] smaller) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            if (i == 3) {
+                a = smaller;
+            }
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    // The index is tested against one array but used on another.
+    static int otherArray(int[] a, int[] smaller) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += smaller[i];
+        }
+        return sum;
+    }
+}
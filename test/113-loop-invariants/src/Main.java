@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Test loop invariant code motion and global value numbering, see comment in info.txt
+ */
+public class Main {
+    int scale = 3;
+    long wide = 1L << 40;
+    int counter;
+
+    public static void main(String[] args) {
+        Main m = new Main();
+        System.out.println("invariantLoad: " + m.invariantLoad(10));
+        System.out.println("invariantWide: " + m.invariantWide(4));
+        System.out.println("invariantArithmetic: " + invariantArithmetic(7, 10));
+        System.out.println("writtenInLoop: " + m.writtenInLoop(5));
+        System.out.println("writtenByCall: " + writtenByCall(m, 5));
+        System.out.println("nullNoTrip: " + loadFrom(null, 0));
+        try {
+            loadFrom(null, 1);
+            System.out.println("nullOneTrip: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("nullOneTrip: NullPointerException");
+        }
+        System.out.println("storeBetween: " + storeBetween(m, args.length == 0));
+        int[] array = new int[2];
+        System.out.println("aliasedArrays: " + aliasedArrays(array, array));
+        try {
+            nullAfterBranch(null, args.length == 0);
+            System.out.println("nullAfterBranch: no exception");
+        } catch (NullPointerException expected) {
+            System.out.println("nullAfterBranch: NullPointerException");
+        }
+    }
+
+    int invariantLoad(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += scale * i;
+        }
+        return sum;
+    }
+
+    long invariantWide(int n) {
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += wide + i;
+        }
+        return sum;
+    }
+
+    static int invariantArithmetic(int k, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            int t = k * 3 + 1;
+            sum += t ^ i;
+        }
+        return sum;
+    }
+
+    int writtenInLoop(int n) {
+        counter = 0;
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += counter;
+            counter++;
+        }
+        return sum;
+    }
+
+    static void bump(Main m) {
+        m.counter += 10;
+    }
+
+    static int writtenByCall(Main m, int n) {
+        m.counter = 0;
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += m.counter;
+            bump(m);
+        }
+        return sum;
+    }
+
+    static int loadFrom(Main m, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += m.scale;
+        }
+        return sum;
+    }
+
+    static int storeBetween(Main m, boolean flag) {
+        m.counter = 5;
+        int first = m.counter;
+        if (flag) {
+            m.counter = 7;
+        }
+        return first * 100 + m.counter;
+    }
+
+    static int aliasedArrays(int[] a, int[] b) {
+        a[0] = 1;
+        int first = a[0];
+        b[0] = 2;
+        return first * 10 + a[0];
+    }
+
+    static int nullAfterBranch(Main m, boolean flag) {
+        int x = 0;
+        if (flag) {
+            x = 1;
+        }
+        return x + m.scale;
+    }
+}
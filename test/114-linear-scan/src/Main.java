@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Test linear scan register promotion, see comment in info.txt
+ *
+ * Locals are declared up front so that dx, which keeps each local in scope in its own Dalvik
+ * register, can't merge the ones whose lifetimes are disjoint.
+ */
+public class Main {
+    static int calls;
+
+    public static void main(String[] args) {
+        System.out.println("disjoint: " + disjoint(10));
+        System.out.println("manyPhases: " + manyPhases(5));
+        System.out.println("wide: " + wide(4));
+        System.out.println("caught: " + caught(8));
+        System.out.println("calls: " + calls);
+    }
+
+    static int id(int x) {
+        calls++;
+        return x;
+    }
+
+    static void throwIfOdd(int x) {
+        if ((x & 1) != 0) {
+            throw new IllegalStateException();
+        }
+    }
+
+    // a is dead before b is written, so they may share a register.
+    static int disjoint(int n) {
+        int a;
+        int b;
+        int i;
+        int sum = 0;
+        a = id(3);
+        for (i = 0; i < n; i++) {
+            sum += id(a) + i;
+        }
+        b = id(7);
+        for (i = 0; i < n; i++) {
+            sum += id(b) * i;
+        }
+        return sum;
+    }
+
+    // Ten phases, each with its own register, outnumber the callee-save registers.
+    static int manyPhases(int n) {
+        int p0, p1, p2, p3, p4, p5, p6, p7, p8, p9;
+        int i;
+        int sum = 0;
+        p0 = id(1);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p0 ^ id(i));
+        }
+        p1 = id(2);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p1 ^ id(i));
+        }
+        p2 = id(3);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p2 ^ id(i));
+        }
+        p3 = id(4);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p3 ^ id(i));
+        }
+        p4 = id(5);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p4 ^ id(i));
+        }
+        p5 = id(6);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p5 ^ id(i));
+        }
+        p6 = id(7);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p6 ^ id(i));
+        }
+        p7 = id(8);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p7 ^ id(i));
+        }
+        p8 = id(9);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p8 ^ id(i));
+        }
+        p9 = id(10);
+        for (i = 0; i < n; i++) {
+            sum = sum * 3 + (p9 ^ id(i));
+        }
+        return sum;
+    }
+
+    static long wide(int n) {
+        long x;
+        long y;
+        int i;
+        long total = 0;
+        x = 1L << 33;
+        for (i = 0; i < n; i++) {
+            total += x + id(i);
+        }
+        y = 3L << 34;
+        for (i = 0; i < n; i++) {
+            total -= y - id(i);
+        }
+        return total;
+    }
+
+    // b, which may share a's register, is live into the handler.
+    static int caught(int n) {
+        int a;
+        int b;
+        int result = 0;
+        a = id(n);
+        result += a * 2;
+        b = id(n + 1);
+        try {
+            throwIfOdd(b);
+        } catch (IllegalStateException expected) {
+            result += b;
+        }
+        return result + b;
+    }
+}